@@ -0,0 +1,110 @@
+/**
+ * @file magic-scan-bench.cpp
+ * @brief Micro-benchmark for the v1 SQFH magic search in PipeReader
+ *
+ * Scans 64 KB buffers (the PipeReader buffer size) with the original
+ * byte-by-byte loop and with PipeReader::findMagic(), and reports
+ * throughput for each content type. Needs no Diretta SDK:
+ *
+ *   cmake --build build --target magic-scan-bench && ./build/magic-scan-bench
+ */
+
+#include "PipeReader.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+namespace {
+
+constexpr size_t BUF_SIZE = 65536;
+constexpr int ITERATIONS = 2000;
+
+// The scan loop PipeReader used before findMagic()
+size_t scalarFind(const uint8_t* p, size_t len) {
+    for (size_t i = 0; i + 4 <= len; i++) {
+        if (p[i] == 'S' && p[i + 1] == 'Q' && p[i + 2] == 'F' && p[i + 3] == 'H') {
+            return i;
+        }
+    }
+    return len;
+}
+
+size_t vectorFind(const uint8_t* p, size_t len) {
+    return PipeReader::findMagic(p, len, 0);
+}
+
+template <typename Fn>
+double measureMBps(Fn fn, const std::vector<uint8_t>& buf, size_t& result) {
+    volatile size_t sink = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < ITERATIONS; i++) {
+        sink = sink + fn(buf.data(), buf.size());
+    }
+    auto end = std::chrono::steady_clock::now();
+    result = fn(buf.data(), buf.size());
+
+    double secs = std::chrono::duration<double>(end - start).count();
+    return (static_cast<double>(buf.size()) * ITERATIONS) / secs / 1e6;
+}
+
+void run(const char* name, const std::vector<uint8_t>& buf) {
+    size_t r1 = 0, r2 = 0;
+    double scalar = measureMBps(scalarFind, buf, r1);
+    double vector = measureMBps(vectorFind, buf, r2);
+
+    if (r1 != r2) {
+        std::fprintf(stderr, "%s: result mismatch (scalar %zu, findMagic %zu)\n", name, r1, r2);
+        std::exit(1);
+    }
+    std::printf("%-24s %10.0f MB/s %10.0f MB/s %7.1fx\n", name, scalar, vector, vector / scalar);
+}
+
+// Clear any accidental magic so the whole buffer is scanned
+void stripMagic(std::vector<uint8_t>& buf) {
+    for (size_t i = 0; i + 4 <= buf.size(); i++) {
+        if (scalarFind(buf.data() + i, 4) == 0) buf[i] = 0;
+    }
+}
+
+} // namespace
+
+int main() {
+    std::mt19937 rng(12345);
+    std::vector<uint8_t> buf(BUF_SIZE);
+
+    std::printf("%-24s %15s %15s %8s\n", "Buffer (64 KB)", "byte loop", "findMagic", "speedup");
+
+    for (auto& b : buf) b = static_cast<uint8_t>(rng());
+    stripMagic(buf);
+    run("random", buf);
+
+    // DSD digital silence idles at 0x69
+    std::fill(buf.begin(), buf.end(), 0x69);
+    run("DSD silence (0x69)", buf);
+
+    // Near-silent DSD: mostly 0x69 with sparse modulation
+    for (auto& b : buf) b = (rng() % 64 == 0) ? static_cast<uint8_t>(rng()) : 0x69;
+    stripMagic(buf);
+    run("near-silent DSD", buf);
+
+    // PCM digital silence
+    std::fill(buf.begin(), buf.end(), 0x00);
+    run("PCM silence (0x00)", buf);
+
+    // Worst case for a first-byte filter: 'S' candidates everywhere
+    for (auto& b : buf) b = (rng() % 2) ? 'S' : static_cast<uint8_t>(rng());
+    stripMagic(buf);
+    run("dense 'S' candidates", buf);
+
+    // Magic at the very end: must still be found
+    buf[BUF_SIZE - 4] = 'S';
+    buf[BUF_SIZE - 3] = 'Q';
+    buf[BUF_SIZE - 2] = 'F';
+    buf[BUF_SIZE - 1] = 'H';
+    run("magic at end", buf);
+
+    return 0;
+}
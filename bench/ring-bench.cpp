@@ -0,0 +1,300 @@
+/**
+ * @file ring-bench.cpp
+ * @brief Throughput benchmark for the DirettaRingBuffer conversion kernels
+ *
+ * Builds without the Diretta SDK, with the same SIMD flags as the main
+ * binary for the selected ARCH_NAME / TARGET_MARCH:
+ *
+ *   cmake -S . -B build-bench -DSQUEEZE2DIRETTA_BENCH_ONLY=ON -DTARGET_MARCH=v4
+ *   cmake --build build-bench --target squeeze2diretta-bench
+ *   ./build-bench/squeeze2diretta-bench [seconds-per-kernel] [producer-cpu consumer-cpu]
+ *
+ * Each kernel is fed 16 KB chunks (the wrapper's read size) of realistic
+ * content until the 1 MB ring is full, then the ring is reset untimed.
+ * Throughput is quoted in input bytes.
+ *
+ * The last section runs producer and consumer on two threads, pinned to
+ * the given CPUs (e.g. the reader and worker cores the tuner isolates),
+ * so the cost of sharing the ring indices between cores shows up.
+ */
+
+#include "DirettaRingBuffer.h"
+
+#include <pthread.h>
+#include <sched.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr size_t RING_SIZE = 1024 * 1024;
+constexpr size_t CHUNK = 16384;          // Wrapper PIPE_BUF_SIZE
+constexpr size_t POP_CHUNK = 1472 * 2;   // ~one Diretta buffer at MTU 1500
+
+using Clock = std::chrono::steady_clock;
+using Mode = DirettaRingBuffer::DSDConversionMode;
+using Layout = DirettaRingBuffer::DSDSourceLayout;
+
+const char* buildFlavor() {
+#if DIRETTA_HAS_AVX512_VBMI && DIRETTA_HAS_GFNI
+    return "AVX-512 + VBMI + GFNI";
+#elif DIRETTA_HAS_AVX512_VBMI
+    return "AVX-512 + VBMI";
+#elif DIRETTA_HAS_GFNI
+    return "AVX-512 + GFNI";
+#elif DIRETTA_HAS_AVX512
+    return "AVX-512";
+#elif DIRETTA_HAS_AVX2
+    return "AVX2";
+#elif DIRETTA_HAS_NEON
+    return "NEON";
+#else
+    return "scalar";
+#endif
+}
+
+void resetRing(DirettaRingBuffer& ring) {
+    ring.clear();
+    ring.setS24PackModeHint(DirettaRingBuffer::S24PackMode::MsbAligned);
+}
+
+/**
+ * Time push(chunk) calls until the ring has no room for another chunk's
+ * output, reset, and repeat for `seconds`. Only the push calls are timed.
+ */
+void benchPush(const char* name, DirettaRingBuffer& ring, double seconds,
+               const std::function<size_t()>& push) {
+    double pushedNs = 0;
+    uint64_t calls = 0;
+    uint64_t bytes = 0;
+    auto deadline = Clock::now() + std::chrono::duration<double>(seconds);
+
+    while (Clock::now() < deadline) {
+        resetRing(ring);
+        auto start = Clock::now();
+        uint64_t batchCalls = 0;
+        // Output can be up to 2x input (16->32): stop while a chunk still fits
+        while (ring.getFreeSpace() >= 2 * CHUNK) {
+            if (push() == 0) break;
+            batchCalls++;
+        }
+        pushedNs += std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+        calls += batchCalls;
+        bytes += batchCalls * CHUNK;
+    }
+
+    double gbps = pushedNs > 0 ? bytes / pushedNs : 0.0;
+    std::printf("  %-34s %8.2f GB/s %10.0f ns/call\n", name, gbps, calls ? pushedNs / calls : 0.0);
+}
+
+/**
+ * Time consumer-side reads: pop() copies out, zeroCopy uses
+ * acquireReadRegion() as getNewStream() does on a mirrored ring.
+ */
+void benchPop(DirettaRingBuffer& ring, double seconds, const std::vector<uint8_t>& src, bool zeroCopy) {
+    std::vector<uint8_t> dest(POP_CHUNK);
+    double poppedNs = 0;
+    uint64_t calls = 0;
+    auto deadline = Clock::now() + std::chrono::duration<double>(seconds);
+
+    while (Clock::now() < deadline) {
+        resetRing(ring);
+        while (ring.getFreeSpace() >= CHUNK) ring.push(src.data(), CHUNK);
+
+        auto start = Clock::now();
+        uint64_t batchCalls = 0;
+        if (zeroCopy) {
+            while (ring.acquireReadRegion(POP_CHUNK) != nullptr) batchCalls++;
+        } else {
+            while (ring.getAvailable() >= POP_CHUNK) {
+                ring.pop(dest.data(), POP_CHUNK);
+                batchCalls++;
+            }
+        }
+        poppedNs += std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+        calls += batchCalls;
+    }
+
+    double gbps = poppedNs > 0 ? (calls * POP_CHUNK) / poppedNs : 0.0;
+    std::printf("  %-34s %8.2f GB/s %10.0f ns/call\n",
+                zeroCopy ? "acquireReadRegion (2944 B)" : "pop (2944 B)",
+                gbps, calls ? poppedNs / calls : 0.0);
+}
+
+void pinTo(int cpu) {
+    if (cpu < 0) return;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0) {
+        std::fprintf(stderr, "Could not pin to CPU %d\n", cpu);
+    }
+}
+
+/**
+ * Wrapper reader and SDK worker in miniature: one thread pushes 16 KB
+ * chunks whenever there is room, the other pops one Diretta buffer at a
+ * time. Reports throughput and the per-pop latency the worker's cycle
+ * budget sees (including two clock reads). Either side yields when it
+ * cannot proceed, so this also runs on a single core.
+ */
+void benchCrossCore(double seconds, const std::vector<uint8_t>& src, int producerCpu, int consumerCpu) {
+    DirettaRingBuffer ring;
+    ring.resize(RING_SIZE, 0x00);
+    std::atomic<bool> stop{false};
+
+    std::thread producer([&] {
+        pinTo(producerCpu);
+        while (!stop.load(std::memory_order_relaxed)) {
+            if (ring.push(src.data(), CHUNK) == 0) std::this_thread::yield();
+        }
+    });
+
+    std::vector<uint64_t> latencyNs;
+    latencyNs.reserve(1 << 22);
+    uint64_t bytes = 0;
+    double elapsedNs = 0;
+    std::thread consumer([&] {
+        pinTo(consumerCpu);
+        std::vector<uint8_t> dest(POP_CHUNK);
+        auto begin = Clock::now();
+        auto deadline = begin + std::chrono::duration<double>(seconds);
+        while (Clock::now() < deadline) {
+            auto start = Clock::now();
+            size_t n = ring.pop(dest.data(), POP_CHUNK);
+            auto end = Clock::now();
+            if (n == 0) {
+                std::this_thread::yield();
+                continue;
+            }
+            bytes += n;
+            if (latencyNs.size() < latencyNs.capacity()) {
+                latencyNs.push_back(static_cast<uint64_t>(
+                    std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()));
+            }
+        }
+        elapsedNs = std::chrono::duration<double, std::nano>(Clock::now() - begin).count();
+    });
+
+    consumer.join();
+    stop.store(true, std::memory_order_relaxed);
+    producer.join();
+
+    auto percentile = [&](double q) -> uint64_t {
+        if (latencyNs.empty()) return 0;
+        size_t k = static_cast<size_t>(q * (latencyNs.size() - 1));
+        std::nth_element(latencyNs.begin(), latencyNs.begin() + k, latencyNs.end());
+        return latencyNs[k];
+    };
+    uint64_t p50 = percentile(0.50);
+    uint64_t p99 = percentile(0.99);
+    uint64_t p999 = percentile(0.999);
+    std::printf("  %-34s %8.2f GB/s   pop p50 %llu ns, p99 %llu ns, p99.9 %llu ns\n",
+                "push 16 KB / pop 2944 B", elapsedNs > 0 ? bytes / elapsedNs : 0.0,
+                static_cast<unsigned long long>(p50), static_cast<unsigned long long>(p99),
+                static_cast<unsigned long long>(p999));
+}
+
+const char* modeName(Mode m) {
+    switch (m) {
+        case Mode::Passthrough:       return "Passthrough";
+        case Mode::BitReverseOnly:    return "BitReverseOnly";
+        case Mode::ByteSwapOnly:      return "ByteSwapOnly";
+        case Mode::BitReverseAndSwap: return "BitReverseAndSwap";
+    }
+    return "?";
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    double seconds = argc > 1 ? std::atof(argv[1]) : 0.5;
+    if (seconds <= 0) seconds = 0.5;
+    int producerCpu = argc > 3 ? std::atoi(argv[2]) : -1;
+    int consumerCpu = argc > 3 ? std::atoi(argv[3]) : -1;
+
+    std::printf("DirettaRingBuffer benchmark - %s build, %zu KB ring, %zu B chunks\n\n",
+                buildFlavor(), RING_SIZE / 1024, CHUNK);
+
+    DirettaRingBuffer ring;
+    ring.resize(RING_SIZE, 0x00);
+
+    std::mt19937 rng(42);
+
+    // PCM: squeezelite S32_LE, 24-bit content in the top 3 bytes (MSB-aligned)
+    std::vector<uint8_t> pcm32(CHUNK);
+    for (size_t i = 0; i < CHUNK; i += 4) {
+        uint32_t s = (rng() & 0xFFFFFF00u);
+        std::memcpy(&pcm32[i], &s, 4);
+    }
+    std::vector<uint8_t> pcm16(CHUNK);
+    for (auto& b : pcm16) b = static_cast<uint8_t>(rng());
+
+    // DSD: near-silence (0x69 idle pattern) with modulation
+    std::vector<uint8_t> dsd(CHUNK);
+    for (auto& b : dsd) b = (rng() % 4 == 0) ? static_cast<uint8_t>(rng()) : 0x69;
+
+    // DoP: S32_LE frames, DSD bytes in the middle/low bytes, marker on top
+    std::vector<uint8_t> dop(CHUNK);
+    for (size_t i = 0; i < CHUNK; i += 4) {
+        dop[i] = 0;
+        dop[i + 1] = static_cast<uint8_t>(rng());
+        dop[i + 2] = static_cast<uint8_t>(rng());
+        dop[i + 3] = ((i / 8) % 2) ? 0xFA : 0x05;
+    }
+
+    std::printf("PCM\n");
+    benchPush("push (memcpy)", ring, seconds,
+              [&] { return ring.push(pcm32.data(), CHUNK); });
+    benchPush("push24BitPacked (S32 -> 24)", ring, seconds,
+              [&] { return ring.push24BitPacked(pcm32.data(), CHUNK); });
+    benchPush("push16To32", ring, seconds,
+              [&] { return ring.push16To32(pcm16.data(), CHUNK); });
+    benchPush("push16To24", ring, seconds,
+              [&] { return ring.push16To24(pcm16.data(), CHUNK); });
+    benchPush("push24To32 (S24_3LE -> 32)", ring, seconds,
+              [&] { return ring.push24To32(pcm16.data(), CHUNK - CHUNK % 3); });
+    benchPop(ring, seconds, pcm32, false);
+    if (ring.isMirrored()) {
+        benchPop(ring, seconds, pcm32, true);
+    }
+
+    const Mode modes[] = { Mode::Passthrough, Mode::BitReverseOnly,
+                           Mode::ByteSwapOnly, Mode::BitReverseAndSwap };
+
+    std::printf("\nDSD planar (pushDSDPlanarOptimized, stereo)\n");
+    for (Mode m : modes) {
+        benchPush(modeName(m), ring, seconds,
+                  [&] { return ring.pushDSDPlanarOptimized(dsd.data(), CHUNK, 2, m); });
+    }
+
+    std::printf("\nDSD interleaved U32 (pushDSDInterleaved, stereo)\n");
+    for (Mode m : modes) {
+        benchPush(modeName(m), ring, seconds,
+                  [&] { return ring.pushDSDInterleaved(dsd.data(), CHUNK, 2, Layout::InterleavedU32, m); });
+    }
+
+    std::printf("\nDoP (pushDSDInterleaved, stereo)\n");
+    for (Mode m : modes) {
+        benchPush(modeName(m), ring, seconds,
+                  [&] { return ring.pushDSDInterleaved(dop.data(), CHUNK, 2, Layout::DoP, m); });
+    }
+
+    if (producerCpu >= 0) {
+        std::printf("\nCross-core SPSC (producer CPU %d, consumer CPU %d)\n", producerCpu, consumerCpu);
+    } else {
+        std::printf("\nCross-core SPSC (unpinned; pass two CPUs to pin)\n");
+    }
+    benchCrossCore(seconds, pcm32, producerCpu, consumerCpu);
+
+    return 0;
+}
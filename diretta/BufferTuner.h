@@ -0,0 +1,148 @@
+/**
+ * @file BufferTuner.h
+ * @brief Per-session ring size / prefill scaling from observed producer jitter
+ *
+ * The defaults in DirettaBuffer (ring seconds, prefill ms) are sized for
+ * slow, bursty sources. BufferTuner watches how the producer actually
+ * delivers during a session and picks a scale factor for the next
+ * configureRingPCM()/configureRingDSD() of the same family:
+ *
+ * - Late delivery (ring nearly empty when data arrived): grow x1.5
+ * - Fill dropped more than half way below the flow-control low mark: grow x1.25
+ * - A long session that never dipped below 80% of the low mark: shrink x0.8
+ *
+ * Fill is sampled by the producer at each delivery, after prefill and once
+ * the ring has first reached the low mark, so the start-up ramp and the
+ * drain at end of stream are not mistaken for jitter.
+ *
+ * onDelivery()/beginSession()/endSession() run on the producer thread
+ * (sendAudio*() and open() share the caller's thread); scale() may be read
+ * from anywhere.
+ */
+
+#ifndef SQUEEZE2DIRETTA_BUFFER_TUNER_H
+#define SQUEEZE2DIRETTA_BUFFER_TUNER_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+class BufferTuner {
+public:
+    static constexpr float GROW_LATE = 1.5f;
+    static constexpr float GROW_DIP = 1.25f;
+    static constexpr float SHRINK = 0.8f;
+    static constexpr double MIN_SESSION_SECONDS = 10.0;  // Before shrinking
+
+    struct Verdict {
+        bool changed = false;
+        bool dsd = false;
+        float oldScale = 1.0f;
+        float newScale = 1.0f;
+        uint64_t lateDeliveries = 0;
+        double dipMs = 0.0;         // Deepest fill below the low mark
+        double lowWaterMs = 0.0;
+        double seconds = 0.0;       // Audio delivered in the session
+    };
+
+    void configure(bool enabled, float minScale, float maxScale) {
+        m_enabled = enabled;
+        m_minScale = std::min(minScale, maxScale);
+        m_maxScale = std::max(minScale, maxScale);
+        float start = std::max(m_minScale, std::min(1.0f, m_maxScale));
+        m_scale[0].store(start, std::memory_order_relaxed);
+        m_scale[1].store(start, std::memory_order_relaxed);
+    }
+
+    bool enabled() const { return m_enabled; }
+
+    // Scale for ring seconds and prefill ms of the given family
+    float scale(bool dsd) const {
+        return m_enabled ? m_scale[dsd ? 1 : 0].load(std::memory_order_relaxed) : 1.0f;
+    }
+
+    void beginSession(bool dsd, size_t ringBytes, size_t bytesPerSecond,
+                      size_t bytesPerBuffer, float lowWater) {
+        m_active = bytesPerSecond > 0;
+        m_dsd = dsd;
+        m_bytesPerSecond = bytesPerSecond;
+        m_bytesPerBuffer = bytesPerBuffer;
+        m_lowWaterBytes = static_cast<size_t>(ringBytes * lowWater);
+        m_lateDeliveries = 0;
+        m_deliveredBytes = 0;
+        m_minFill = SIZE_MAX;
+        m_reachedLowWater = false;
+    }
+
+    // Ring refilled from empty (open, resume): wait for the low mark again
+    void onPrefillComplete() { m_reachedLowWater = false; }
+
+    /**
+     * @param fillBefore Ring fill just before this delivery was pushed
+     */
+    void onDelivery(size_t fillBefore, size_t bytes) {
+        if (!m_active) return;
+        m_deliveredBytes += bytes;
+        if (!m_reachedLowWater) {
+            m_reachedLowWater = fillBefore >= m_lowWaterBytes;
+            return;
+        }
+        if (fillBefore < 2 * m_bytesPerBuffer) m_lateDeliveries++;
+        m_minFill = std::min(m_minFill, fillBefore);
+    }
+
+    /**
+     * Close the current session and rescale its family for the next one.
+     */
+    Verdict endSession() {
+        Verdict v;
+        if (!m_active) return v;
+        m_active = false;
+
+        int idx = m_dsd ? 1 : 0;
+        v.dsd = m_dsd;
+        v.oldScale = v.newScale = m_scale[idx].load(std::memory_order_relaxed);
+        v.lateDeliveries = m_lateDeliveries;
+        v.seconds = static_cast<double>(m_deliveredBytes) / m_bytesPerSecond;
+        v.lowWaterMs = 1000.0 * m_lowWaterBytes / m_bytesPerSecond;
+        if (m_minFill != SIZE_MAX && m_minFill < m_lowWaterBytes) {
+            v.dipMs = 1000.0 * (m_lowWaterBytes - m_minFill) / m_bytesPerSecond;
+        }
+        if (!m_enabled) return v;
+
+        float factor = 1.0f;
+        if (v.lateDeliveries > 0) {
+            factor = GROW_LATE;
+        } else if (v.dipMs > 0.5 * v.lowWaterMs) {
+            factor = GROW_DIP;
+        } else if (m_minFill != SIZE_MAX && v.seconds >= MIN_SESSION_SECONDS &&
+                   v.dipMs < 0.2 * v.lowWaterMs) {
+            factor = SHRINK;
+        }
+
+        v.newScale = std::max(m_minScale, std::min(v.oldScale * factor, m_maxScale));
+        v.changed = v.newScale != v.oldScale;
+        m_scale[idx].store(v.newScale, std::memory_order_relaxed);
+        return v;
+    }
+
+private:
+    bool m_enabled = false;
+    float m_minScale = 1.0f;
+    float m_maxScale = 1.0f;
+    std::atomic<float> m_scale[2] = {{1.0f}, {1.0f}};  // PCM, DSD
+
+    // Current session (producer thread only)
+    bool m_active = false;
+    bool m_dsd = false;
+    size_t m_bytesPerSecond = 0;
+    size_t m_bytesPerBuffer = 0;
+    size_t m_lowWaterBytes = 0;
+    uint64_t m_lateDeliveries = 0;
+    uint64_t m_deliveredBytes = 0;
+    size_t m_minFill = SIZE_MAX;
+    bool m_reachedLowWater = false;
+};
+
+#endif // SQUEEZE2DIRETTA_BUFFER_TUNER_H
@@ -15,9 +15,12 @@
 #include <cstdint>
 #include <cstring>
 #include <algorithm>
+#include <initializer_list>
 #include <cstdlib>
 #include <new>
 #include <type_traits>
+#include <sys/mman.h>
+#include <unistd.h>
 
 // Architecture detection for SIMD support
 // Require both x86 platform AND AVX2 compiler flag (-mavx2 or -march=x86-64-v3+)
@@ -35,6 +38,28 @@
     #define DIRETTA_HAS_NEON 0
 #endif
 
+// AVX-512 byte shuffles (x86-64-v4 / zen4 builds): F for 512-bit permutes, BW for vpshufb
+#if DIRETTA_HAS_AVX2 && defined(__AVX512F__) && defined(__AVX512BW__)
+    #define DIRETTA_HAS_AVX512 1
+#else
+    #define DIRETTA_HAS_AVX512 0
+#endif
+
+// Zen 4 / Ice Lake extras (-march=znver4 or native): VBMI full-width byte
+// permutes for 24-bit packing, GFNI affine transform for DSD bit reversal.
+// x86-64-v4 builds don't assume them and use the AVX512BW equivalents.
+#if DIRETTA_HAS_AVX512 && defined(__AVX512VBMI__)
+    #define DIRETTA_HAS_AVX512_VBMI 1
+#else
+    #define DIRETTA_HAS_AVX512_VBMI 0
+#endif
+
+#if DIRETTA_HAS_AVX512 && defined(__GFNI__)
+    #define DIRETTA_HAS_GFNI 1
+#else
+    #define DIRETTA_HAS_GFNI 0
+#endif
+
 #include "memcpyfast_audio.h"
 
 template <typename T, size_t Alignment>
@@ -105,6 +130,9 @@ bool operator!=(const AlignedAllocator<T, Alignment>&, const AlignedAllocator<T,
  * - 24-bit packing (4 bytes in -> 3 bytes out)
  * - 16-bit to 32-bit upsampling
  * - DSD planar-to-interleaved conversion with optional bit reversal
+ * - DSD interleaved (U32 / DoP) to target layout in a single pass
+ * - Zero-copy reads: storage is mapped twice back to back when the ring is
+ *   page-sized, so any read of up to size() bytes is contiguous
  */
 class DirettaRingBuffer {
 public:
@@ -117,6 +145,12 @@ public:
         BitReverseAndSwap  // Both operations needed
     };
 
+    // Layout of interleaved DSD handed to pushDSDInterleaved()
+    enum class DSDSourceLayout {
+        InterleavedU32,    // 32-bit LE words per channel, DSD bytes MSB-first in the word (squeezelite u32)
+        DoP                // S32_LE DoP: [pad][DSD LSB][DSD MSB][marker] per channel
+    };
+
     // Single bit-reversal LUT for all DSD conversion functions (cache-friendly)
     static constexpr uint8_t kBitReverseLUT[256] = {
         0x00,0x80,0x40,0xC0,0x20,0xA0,0x60,0xE0,0x10,0x90,0x50,0xD0,0x30,0xB0,0x70,0xF0,
@@ -138,20 +172,66 @@ public:
     };
 
     DirettaRingBuffer() = default;
+    ~DirettaRingBuffer() {
+        unmapMirror(mirror_, mirrorSize_);
+        unmapMirror(retiredMirror_, retiredMirrorSize_);
+    }
+
+    DirettaRingBuffer(const DirettaRingBuffer&) = delete;
+    DirettaRingBuffer& operator=(const DirettaRingBuffer&) = delete;
 
     /**
      * @brief Resize buffer and set silence byte
+     *
+     * Storage replaced here stays mapped until the following resize, so a
+     * region handed out by acquireReadRegion() outlives one reconfigure.
      */
     void resize(size_t newSize, uint8_t silenceByte) {
-        size_ = roundUpPow2(newSize);
-        mask_ = size_ - 1;
-        buffer_.resize(size_);
+        size_t newRingSize = roundUpPow2(newSize);
+        if (newRingSize != size_ || base_ == nullptr) {
+            allocateStorage(newRingSize);
+        }
         silenceByte_.store(silenceByte, std::memory_order_release);
         clear();  // Resets all S24 state - hint will be set by caller via setS24PackModeHint()
         fillWithSilence();
+        if (populate_ && mirror_) {
+            // Shared mappings are populated read-only; write each page of
+            // the upper view once so neither view faults while streaming
+            long page = sysconf(_SC_PAGESIZE);
+            volatile uint8_t* upper = mirror_ + size_;
+            for (size_t i = 0; i < size_; i += static_cast<size_t>(page)) {
+                upper[i] = upper[i];
+            }
+        }
     }
 
     size_t size() const { return size_; }
+
+    /**
+     * @brief Realtime memory mode, for storage allocated from now on
+     * @param populate Fault both halves of the mirror in at resize(), so the
+     *                 consumer's first read past the end doesn't page fault
+     * @param hugePages Back rings that are a multiple of the huge page size
+     *                  with hugetlbfs pages (MFD_HUGETLB); needs reserved
+     *                  pages (vm.nr_hugepages), falls back to normal pages
+     */
+    void setMemoryMode(bool populate, bool hugePages) {
+        populate_ = populate;
+        hugePages_ = hugePages;
+    }
+
+    // True when the current storage is backed by huge pages
+    bool isHugePages() const { return mirrorHuge_; }
+
+    // Touch the conversion staging buffers so their first use doesn't fault
+    void prefaultStaging() {
+        std::memset(m_staging24BitPack, 0, STAGING_SIZE);
+        std::memset(m_staging16To32, 0, STAGING_SIZE);
+        std::memset(m_stagingDSD, 0, STAGING_SIZE);
+    }
+
+    // True when storage is double-mapped and acquireReadRegion() is usable
+    bool isMirrored() const { return mirror_ != nullptr; }
     uint8_t silenceByte() const { return silenceByte_.load(std::memory_order_acquire); }
 
     size_t getAvailable() const {
@@ -172,9 +252,32 @@ public:
         return (rp - wp - 1) & mask_;
     }
 
-    void clear() {
+    /**
+     * @brief Exact fill level, for the consumer thread only
+     *
+     * Like getAvailable(), but also refreshes the consumer's copy of the
+     * write position, so the pop() or acquireReadRegion() that follows
+     * does not load the producer's index again.
+     */
+    size_t refreshAvailable() {
+        if (size_ == 0) return 0;
+        size_t wp = writePos_.load(std::memory_order_acquire);
+        cachedWritePos_ = wp;
+        return (wp - readPos_.load(std::memory_order_relaxed)) & mask_;
+    }
+
+    // Drop buffered data but keep the format state (S24 detection).
+    // Neither side may be inside push/pop (ReconfigureGuard)
+    void discard() {
         writePos_.store(0, std::memory_order_release);
         readPos_.store(0, std::memory_order_release);
+        cachedReadPos_ = 0;
+        cachedWritePos_ = 0;
+        heldRead_.store(0, std::memory_order_relaxed);
+    }
+
+    void clear() {
+        discard();
         // Reset all S24 state to allow fresh detection for new tracks
         // New track will set hint via setS24PackModeHint() if available
         m_s24PackMode = S24PackMode::Unknown;
@@ -184,7 +287,8 @@ public:
     }
 
     void fillWithSilence() {
-        std::memset(buffer_.data(), silenceByte_.load(std::memory_order_relaxed), size_);
+        if (base_ == nullptr) return;
+        std::memset(base_, silenceByte_.load(std::memory_order_relaxed), size_);
     }
 
     const uint8_t* getStaging24BitPack() const { return m_staging24BitPack; }
@@ -224,17 +328,17 @@ public:
             return false;
         }
 
-        size_t wp = writePos_.load(std::memory_order_acquire);
-        size_t rp = readPos_.load(std::memory_order_acquire);
-
-        // Calculate free space
-        size_t free = (rp > wp) ? (rp - wp - 1) : (size_ - wp + rp - 1);
+        size_t free = writableSpace(needed);
         if (free < needed) {
             region = nullptr;
             available = 0;
             return false;
         }
 
+        // A stale copy of the read position only understates the space
+        size_t wp = writePos_.load(std::memory_order_relaxed);
+        size_t rp = cachedReadPos_;
+
         // Calculate contiguous space from write position to end of buffer
         size_t contiguous = size_ - wp;
 
@@ -248,8 +352,13 @@ public:
             contiguous = rp - wp - 1;
         }
 
+        // Mirrored storage: writes past the end land at the start
+        if (mirror_) {
+            contiguous = free;
+        }
+
         if (contiguous >= needed) {
-            region = buffer_.data() + wp;
+            region = base_ + wp;
             available = contiguous;
             return true;
         }
@@ -303,7 +412,7 @@ public:
      */
     size_t push(const uint8_t* data, size_t len) {
         if (size_ == 0) return 0;
-        size_t free = getFreeSpace();
+        size_t free = writableSpace(len);
         if (len > free) len = free;
         if (len == 0) return 0;
 
@@ -317,18 +426,37 @@ public:
         }
 
         // Slow path: handle wraparound
-        size_t wp = writePos_.load(std::memory_order_acquire);
+        size_t wp = writePos_.load(std::memory_order_relaxed);
         size_t firstChunk = std::min(len, size_ - wp);
 
-        memcpy_audio(buffer_.data() + wp, data, firstChunk);
+        memcpy_audio(base_ + wp, data, firstChunk);
         if (firstChunk < len) {
-            memcpy_audio(buffer_.data(), data + firstChunk, len - firstChunk);
+            memcpy_audio(base_, data + firstChunk, len - firstChunk);
         }
 
         writePos_.store((wp + len) & mask_, std::memory_order_release);
         return len;
     }
 
+    /**
+     * @brief Append src's bytes [pos, pos + len) (fan-out)
+     *
+     * Copies what another ring already converted, so a second target with
+     * the same conversion doesn't redo it. Caller is the producer of both.
+     * @return Bytes added
+     */
+    size_t pushFrom(const DirettaRingBuffer& src, size_t pos, size_t len) {
+        if (src.size_ == 0 || len == 0) return 0;
+        size_t first = src.isMirrored() ? len : std::min(len, src.size_ - pos);
+        size_t n = push(src.base_ + pos, first);
+        if (n == first && first < len) n += push(src.base_, len - first);
+        return n;
+    }
+
+    // Producer: write position, and bytes added since an earlier one
+    size_t writePosition() const { return writePos_.load(std::memory_order_relaxed); }
+    size_t bytesWrittenSince(size_t pos) const { return (writePosition() - pos) & mask_; }
+
     /**
      * @brief Push with 24-bit packing (4 bytes in -> 3 bytes out, S24_P32 format)
      * @return Input bytes consumed
@@ -344,7 +472,7 @@ public:
         if (numSamples == 0) return 0;
 
         size_t maxSamples = STAGING_SIZE / 3;
-        size_t free = getFreeSpace();
+        size_t free = writableSpace(std::min(numSamples, maxSamples) * 3);
         size_t maxSamplesByFree = free / 3;
 
         if (numSamples > maxSamples) numSamples = maxSamples;
@@ -380,10 +508,11 @@ public:
             effectiveMode = (m_s24Hint != S24PackMode::Unknown) ? m_s24Hint : S24PackMode::LsbAligned;
         }
 
+        uint8_t* dst = conversionTarget(numSamples * 3, m_staging24BitPack);
         size_t stagedBytes = (effectiveMode == S24PackMode::MsbAligned)
-            ? convert24BitPackedShifted_AVX2(m_staging24BitPack, data, numSamples)
-            : convert24BitPacked_AVX2(m_staging24BitPack, data, numSamples);
-        size_t written = writeToRing(m_staging24BitPack, stagedBytes);
+            ? convert24BitPackedShifted_AVX2(dst, data, numSamples)
+            : convert24BitPacked_AVX2(dst, data, numSamples);
+        size_t written = finishConversion(dst, m_staging24BitPack, stagedBytes);
         size_t samplesWritten = written / 3;
 
         return samplesWritten * 4;
@@ -399,7 +528,7 @@ public:
         if (numSamples == 0) return 0;
 
         size_t maxSamples = STAGING_SIZE / 4;
-        size_t free = getFreeSpace();
+        size_t free = writableSpace(std::min(numSamples, maxSamples) * 4);
         size_t maxSamplesByFree = free / 4;
 
         if (numSamples > maxSamples) numSamples = maxSamples;
@@ -408,8 +537,9 @@ public:
 
         prefetch_audio_buffer(data, numSamples * 2);
 
-        size_t stagedBytes = convert16To32_AVX2(m_staging16To32, data, numSamples);
-        size_t written = writeToRing(m_staging16To32, stagedBytes);
+        uint8_t* dst = conversionTarget(numSamples * 4, m_staging16To32);
+        size_t stagedBytes = convert16To32_AVX2(dst, data, numSamples);
+        size_t written = finishConversion(dst, m_staging16To32, stagedBytes);
         size_t samplesWritten = written / 4;
 
         return samplesWritten * 2;
@@ -428,7 +558,7 @@ public:
         if (numSamples == 0) return 0;
 
         size_t maxSamples = STAGING_SIZE / 3;
-        size_t free = getFreeSpace();
+        size_t free = writableSpace(std::min(numSamples, maxSamples) * 3);
         size_t maxSamplesByFree = free / 3;
 
         if (numSamples > maxSamples) numSamples = maxSamples;
@@ -437,18 +567,122 @@ public:
 
         prefetch_audio_buffer(data, numSamples * 2);
 
-        size_t stagedBytes = convert16To24(m_staging16To32, data, numSamples);
-        size_t written = writeToRing(m_staging16To32, stagedBytes);
+        uint8_t* dst = conversionTarget(numSamples * 3, m_staging16To32);
+        size_t stagedBytes = convert16To24(dst, data, numSamples);
+        size_t written = finishConversion(dst, m_staging16To32, stagedBytes);
         size_t samplesWritten = written / 3;
 
         return samplesWritten * 2;
     }
 
+    /**
+     * @brief Push packed 24-bit into a 32-bit ring
+     * @return Input bytes consumed
+     *
+     * Squeezelite sends S24_3LE when the sink's preferred width is 24 bit;
+     * this covers a rate where the sink only takes 32.
+     */
+    size_t push24To32(const uint8_t* data, size_t inputSize) {
+        if (size_ == 0) return 0;
+        size_t numSamples = inputSize / 3;
+        if (numSamples == 0) return 0;
+
+        size_t maxSamples = STAGING_SIZE / 4;
+        size_t free = writableSpace(std::min(numSamples, maxSamples) * 4);
+        size_t maxSamplesByFree = free / 4;
+
+        if (numSamples > maxSamples) numSamples = maxSamples;
+        if (numSamples > maxSamplesByFree) numSamples = maxSamplesByFree;
+        if (numSamples == 0) return 0;
+
+        prefetch_audio_buffer(data, numSamples * 3);
+
+        uint8_t* dst = conversionTarget(numSamples * 4, m_staging16To32);
+        size_t stagedBytes = convert24To32(dst, data, numSamples);
+        size_t written = finishConversion(dst, m_staging16To32, stagedBytes);
+        size_t samplesWritten = written / 4;
+
+        return samplesWritten * 3;
+    }
+
+    /**
+     * @brief Push packed 24-bit or S32 into a 16-bit ring
+     * @return Input bytes consumed
+     *
+     * Keeps the top 16 bits (no dither). Fan-out asks squeezelite for the
+     * widest PCM any target takes, so a 16-bit target beside a wider one
+     * gets the wider samples.
+     */
+    template<size_t InBps>
+    size_t pushNarrowTo16(const uint8_t* data, size_t inputSize) {
+        static_assert(InBps == 3 || InBps == 4, "narrows S24_3LE or S32_LE");
+        if (size_ == 0) return 0;
+        size_t numSamples = inputSize / InBps;
+        if (numSamples == 0) return 0;
+
+        size_t maxSamples = STAGING_SIZE / 2;
+        size_t free = writableSpace(std::min(numSamples, maxSamples) * 2);
+        size_t maxSamplesByFree = free / 2;
+
+        if (numSamples > maxSamples) numSamples = maxSamples;
+        if (numSamples > maxSamplesByFree) numSamples = maxSamplesByFree;
+        if (numSamples == 0) return 0;
+
+        prefetch_audio_buffer(data, numSamples * InBps);
+
+        uint8_t* dst = conversionTarget(numSamples * 2, m_staging16To32);
+        size_t stagedBytes = convertNarrowTo16<InBps>(dst, data, numSamples);
+        size_t written = finishConversion(dst, m_staging16To32, stagedBytes);
+        size_t samplesWritten = written / 2;
+
+        return samplesWritten * InBps;
+    }
+
+    //=========================================================================
+    // Resolved push paths
+    //=========================================================================
+    // DirettaSync picks one of these per format (configureRingPCM/DSD) and
+    // calls it through a member pointer, so the hot path has no branch on
+    // pack/upsample flags, DSD mode or channel count. Each DSD entry is an
+    // instantiation for one conversion mode and, where a kernel has a
+    // stereo SIMD path, for stereo (Channels = 2) or any count (0). The SIMD
+    // level is fixed by the build (-march), not chosen here.
+
+    enum class PCMConversion { Copy, Pack24, Upsample16To32, Upsample16To24, Widen24To32, Narrow24To16, Narrow32To16 };
+
+    using PushFn = size_t (DirettaRingBuffer::*)(const uint8_t* data, size_t inputBytes, int numChannels);
+
+    static PushFn selectPCMPush(PCMConversion conversion) {
+        switch (conversion) {
+            case PCMConversion::Pack24:         return &DirettaRingBuffer::pushPCMAs<PCMConversion::Pack24>;
+            case PCMConversion::Upsample16To32: return &DirettaRingBuffer::pushPCMAs<PCMConversion::Upsample16To32>;
+            case PCMConversion::Upsample16To24: return &DirettaRingBuffer::pushPCMAs<PCMConversion::Upsample16To24>;
+            case PCMConversion::Widen24To32:    return &DirettaRingBuffer::pushPCMAs<PCMConversion::Widen24To32>;
+            case PCMConversion::Narrow24To16:   return &DirettaRingBuffer::pushPCMAs<PCMConversion::Narrow24To16>;
+            case PCMConversion::Narrow32To16:   return &DirettaRingBuffer::pushPCMAs<PCMConversion::Narrow32To16>;
+            default:                            return &DirettaRingBuffer::pushPCMAs<PCMConversion::Copy>;
+        }
+    }
+
+    // Planar source, as handed to DirettaSync::sendAudio()
+    static PushFn selectDSDPlanarPush(DSDConversionMode mode, int numChannels) {
+        return numChannels == 2 ? planarPushFor<2>(mode) : planarPushFor<0>(mode);
+    }
+
+    // Interleaved source, as handed to DirettaSync::sendAudioDSD()
+    static PushFn selectDSDInterleavedPush(DSDSourceLayout layout, DSDConversionMode mode, int numChannels) {
+        if (layout == DSDSourceLayout::DoP) {
+            return numChannels == 2 ? interleavedPushFor<DSDSourceLayout::DoP, 2>(mode)
+                                    : interleavedPushFor<DSDSourceLayout::DoP, 0>(mode);
+        }
+        // Per-word transform: the same code for any channel count
+        return interleavedPushFor<DSDSourceLayout::InterleavedU32, 0>(mode);
+    }
+
     /**
      * @brief Optimized DSD planar push using pre-selected conversion mode
      *
-     * Uses specialized conversion functions with no per-iteration branch checks.
-     * Mode should be determined at track open and cached in DirettaSync.
+     * Runtime-dispatched form of selectDSDPlanarPush() (bench, one-off callers).
      *
      * @param data Planar DSD data
      * @param inputSize Total input size in bytes
@@ -458,12 +692,49 @@ public:
      */
     size_t pushDSDPlanarOptimized(const uint8_t* data, size_t inputSize,
                                    int numChannels, DSDConversionMode mode) {
+        return (this->*selectDSDPlanarPush(mode, numChannels))(data, inputSize, numChannels);
+    }
+
+    /**
+     * @brief Fused DSD push from interleaved source straight to target layout
+     *
+     * Single pass replacement for "de-interleave to planar, then
+     * pushDSDPlanarOptimized()". The output is identical to that path
+     * with the source declared as DFF (MSB-first). Runtime-dispatched form
+     * of selectDSDInterleavedPush().
+     *
+     * @param data Interleaved source: whole frames (U32) or frame pairs (DoP)
+     * @param inputSize Total input size in bytes
+     * @param numChannels Number of audio channels
+     * @param layout Source layout
+     * @param mode Pre-selected conversion mode (same meaning as for planar push)
+     * @return Input bytes consumed
+     */
+    size_t pushDSDInterleaved(const uint8_t* data, size_t inputSize, int numChannels,
+                              DSDSourceLayout layout, DSDConversionMode mode) {
+        return (this->*selectDSDInterleavedPush(layout, mode, numChannels))(data, inputSize, numChannels);
+    }
+
+    template<PCMConversion Conversion>
+    size_t pushPCMAs(const uint8_t* data, size_t inputBytes, int /*numChannels*/) {
+        if constexpr (Conversion == PCMConversion::Pack24) return push24BitPacked(data, inputBytes);
+        else if constexpr (Conversion == PCMConversion::Upsample16To32) return push16To32(data, inputBytes);
+        else if constexpr (Conversion == PCMConversion::Upsample16To24) return push16To24(data, inputBytes);
+        else if constexpr (Conversion == PCMConversion::Widen24To32) return push24To32(data, inputBytes);
+        else if constexpr (Conversion == PCMConversion::Narrow24To16) return pushNarrowTo16<3>(data, inputBytes);
+        else if constexpr (Conversion == PCMConversion::Narrow32To16) return pushNarrowTo16<4>(data, inputBytes);
+        else return push(data, inputBytes);
+    }
+
+    template<DSDConversionMode Mode, int Channels>
+    size_t pushDSDPlanarAs(const uint8_t* data, size_t inputSize, int numChannels) {
+        if constexpr (Channels > 0) numChannels = Channels;
         if (size_ == 0) return 0;
-        if (numChannels == 0) return 0;
+        if (numChannels <= 0) return 0;
 
         size_t maxBytes = inputSize;
         if (maxBytes > STAGING_SIZE) maxBytes = STAGING_SIZE;
-        size_t free = getFreeSpace();
+        size_t free = writableSpace(maxBytes);
         if (maxBytes > free) maxBytes = free;
 
         size_t bytesPerChannel = maxBytes / static_cast<size_t>(numChannels);
@@ -473,29 +744,94 @@ public:
 
         prefetch_audio_buffer(data, usableInput);
 
+        uint8_t* dst = conversionTarget(usableInput, m_stagingDSD);
         size_t stagedBytes;
+        if constexpr (Mode == DSDConversionMode::BitReverseOnly) {
+            stagedBytes = convertDSD_BitReverse<Channels>(dst, data, usableInput, numChannels);
+        } else if constexpr (Mode == DSDConversionMode::ByteSwapOnly) {
+            stagedBytes = convertDSD_ByteSwap<Channels>(dst, data, usableInput, numChannels);
+        } else if constexpr (Mode == DSDConversionMode::BitReverseAndSwap) {
+            stagedBytes = convertDSD_BitReverseSwap<Channels>(dst, data, usableInput, numChannels);
+        } else {
+            stagedBytes = convertDSD_Passthrough<Channels>(dst, data, usableInput, numChannels);
+        }
+
+        return finishConversion(dst, m_stagingDSD, stagedBytes);
+    }
+
+    template<DSDSourceLayout Layout, DSDConversionMode Mode, int Channels>
+    size_t pushDSDInterleavedAs(const uint8_t* data, size_t inputSize, int numChannels) {
+        if constexpr (Channels > 0) numChannels = Channels;
+        if (size_ == 0) return 0;
+        if (numChannels <= 0) return 0;
+
+        // Output unit: one 4-byte group per channel (4 DSD bytes = 32 bits each)
+        // U32 input: one frame per unit. DoP input: two frames (16 bits each) per unit.
+        size_t outUnit = 4 * static_cast<size_t>(numChannels);
+        size_t inUnit = (Layout == DSDSourceLayout::DoP) ? 2 * outUnit : outUnit;
+
+        size_t units = inputSize / inUnit;
+        size_t maxUnits = STAGING_SIZE / outUnit;
+        size_t maxUnitsByFree = writableSpace(std::min(units, maxUnits) * outUnit) / outUnit;
+        if (units > maxUnits) units = maxUnits;
+        if (units > maxUnitsByFree) units = maxUnitsByFree;
+        if (units == 0) return 0;
+
+        size_t usableInput = units * inUnit;
+        prefetch_audio_buffer(data, usableInput);
+
+        uint8_t* dst = conversionTarget(units * outUnit, m_stagingDSD);
+        constexpr bool modeSwaps = Mode == DSDConversionMode::ByteSwapOnly ||
+                                   Mode == DSDConversionMode::BitReverseAndSwap;
+        constexpr bool modeReverses = Mode == DSDConversionMode::BitReverseOnly ||
+                                      Mode == DSDConversionMode::BitReverseAndSwap;
+        size_t stagedBytes;
+
+        if constexpr (Layout == DSDSourceLayout::DoP) {
+            stagedBytes = convertDSDFromDoP<modeSwaps, modeReverses, Channels>(dst, data, usableInput, numChannels);
+        } else {
+            // U32 words hold DSD bytes MSB-first in LE order: the temporal (DFF)
+            // order is the byte-swapped word, so the mode's swap cancels it out
+            stagedBytes = convertDSDInterleavedU32<!modeSwaps, modeReverses>(dst, data, usableInput);
+        }
+
+        size_t written = finishConversion(dst, m_stagingDSD, stagedBytes);
+        return (written / outUnit) * inUnit;
+    }
+
+private:
+    template<int Channels>
+    static PushFn planarPushFor(DSDConversionMode mode) {
         switch (mode) {
-            case DSDConversionMode::Passthrough:
-                stagedBytes = convertDSD_Passthrough(m_stagingDSD, data, usableInput, numChannels);
-                break;
             case DSDConversionMode::BitReverseOnly:
-                stagedBytes = convertDSD_BitReverse(m_stagingDSD, data, usableInput, numChannels);
-                break;
+                return &DirettaRingBuffer::pushDSDPlanarAs<DSDConversionMode::BitReverseOnly, Channels>;
             case DSDConversionMode::ByteSwapOnly:
-                stagedBytes = convertDSD_ByteSwap(m_stagingDSD, data, usableInput, numChannels);
-                break;
+                return &DirettaRingBuffer::pushDSDPlanarAs<DSDConversionMode::ByteSwapOnly, Channels>;
             case DSDConversionMode::BitReverseAndSwap:
-                stagedBytes = convertDSD_BitReverseSwap(m_stagingDSD, data, usableInput, numChannels);
-                break;
+                return &DirettaRingBuffer::pushDSDPlanarAs<DSDConversionMode::BitReverseAndSwap, Channels>;
+            case DSDConversionMode::Passthrough:
             default:
-                // Fallback to passthrough if unknown mode
-                stagedBytes = convertDSD_Passthrough(m_stagingDSD, data, usableInput, numChannels);
-                break;
+                return &DirettaRingBuffer::pushDSDPlanarAs<DSDConversionMode::Passthrough, Channels>;
         }
+    }
 
-        return writeToRing(m_stagingDSD, stagedBytes);
+    template<DSDSourceLayout Layout, int Channels>
+    static PushFn interleavedPushFor(DSDConversionMode mode) {
+        switch (mode) {
+            case DSDConversionMode::BitReverseOnly:
+                return &DirettaRingBuffer::pushDSDInterleavedAs<Layout, DSDConversionMode::BitReverseOnly, Channels>;
+            case DSDConversionMode::ByteSwapOnly:
+                return &DirettaRingBuffer::pushDSDInterleavedAs<Layout, DSDConversionMode::ByteSwapOnly, Channels>;
+            case DSDConversionMode::BitReverseAndSwap:
+                return &DirettaRingBuffer::pushDSDInterleavedAs<Layout, DSDConversionMode::BitReverseAndSwap, Channels>;
+            case DSDConversionMode::Passthrough:
+            default:
+                return &DirettaRingBuffer::pushDSDInterleavedAs<Layout, DSDConversionMode::Passthrough, Channels>;
+        }
     }
 
+public:
+
     //=========================================================================
     // Format conversion functions - with AVX2 optimization on x86
     //=========================================================================
@@ -516,6 +852,10 @@ public:
         );
 
         size_t i = 0;
+#if DIRETTA_HAS_AVX512
+        i = pack24_512<0>(dst, src, numSamples);
+        outputBytes = i * 3;
+#endif
         for (; i + 8 <= numSamples; i += 8) {
             if (i + 16 <= numSamples) {
                 _mm_prefetch(reinterpret_cast<const char*>(src + (i + 16) * 4), _MM_HINT_T0);
@@ -560,6 +900,10 @@ public:
         );
 
         size_t i = 0;
+#if DIRETTA_HAS_AVX512
+        i = pack24_512<1>(dst, src, numSamples);
+        outputBytes = i * 3;
+#endif
         for (; i + 8 <= numSamples; i += 8) {
             if (i + 16 <= numSamples) {
                 _mm_prefetch(reinterpret_cast<const char*>(src + (i + 16) * 4), _MM_HINT_T0);
@@ -605,6 +949,23 @@ public:
         size_t outputBytes = 0;
 
         size_t i = 0;
+#if DIRETTA_HAS_AVX512
+        // Lane fix-up as permute2x128 below, but with one vpermt2q per output
+        const __m512i first = _mm512_setr_epi64(0, 1, 8, 9, 2, 3, 10, 11);
+        const __m512i second = _mm512_setr_epi64(4, 5, 12, 13, 6, 7, 14, 15);
+        for (; i + 32 <= numSamples; i += 32) {
+            __m512i in = _mm512_loadu_si512(src + i * 2);
+            __m512i zero = _mm512_setzero_si512();
+
+            __m512i lo = _mm512_unpacklo_epi16(zero, in);
+            __m512i hi = _mm512_unpackhi_epi16(zero, in);
+
+            _mm512_storeu_si512(dst + outputBytes, _mm512_permutex2var_epi64(lo, first, hi));
+            outputBytes += 64;
+            _mm512_storeu_si512(dst + outputBytes, _mm512_permutex2var_epi64(lo, second, hi));
+            outputBytes += 64;
+        }
+#endif
         for (; i + 16 <= numSamples; i += 16) {
             __m256i in = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i * 2));
             __m256i zero = _mm256_setzero_si256();
@@ -640,11 +1001,40 @@ public:
      * Returns: number of output bytes written
      *
      * Note: AVX2 shuffle for 3-byte output is complex, scalar is efficient enough
-     * for this relatively rare case (16-bit input to 24-bit-only sink)
+     * for this relatively rare case (16-bit input to 24-bit-only sink).
+     * With VBMI the zero-masked vpermt2b does it in three full stores.
      */
     size_t convert16To24(uint8_t* dst, const uint8_t* src, size_t numSamples) {
         size_t outputBytes = 0;
-        for (size_t i = 0; i < numSamples; i++) {
+        size_t i = 0;
+#if DIRETTA_HAS_AVX512_VBMI
+        // 64 samples (two input vectors) -> 192 bytes; byte k%3 == 0 is the zero pad
+        auto sourceByte = [](int m, int j) {
+            int k = 64 * m + j;
+            return k % 3 == 0 ? 0 : (k / 3) * 2 + k % 3 - 1;
+        };
+        auto padMask = [](int m) {
+            __mmask64 mask = 0;
+            for (int j = 0; j < 64; j++) {
+                if ((64 * m + j) % 3 != 0) mask |= __mmask64(1) << j;
+            }
+            return mask;
+        };
+        static const __m512i idx0 = byteIndex512([&](int j) { return sourceByte(0, j); });
+        static const __m512i idx1 = byteIndex512([&](int j) { return sourceByte(1, j); });
+        static const __m512i idx2 = byteIndex512([&](int j) { return sourceByte(2, j); });
+        static const __mmask64 keep0 = padMask(0), keep1 = padMask(1), keep2 = padMask(2);
+
+        for (; i + 64 <= numSamples; i += 64) {
+            __m512i in0 = _mm512_loadu_si512(src + i * 2);
+            __m512i in1 = _mm512_loadu_si512(src + i * 2 + 64);
+            _mm512_storeu_si512(dst + outputBytes, _mm512_maskz_permutex2var_epi8(keep0, in0, idx0, in1));
+            _mm512_storeu_si512(dst + outputBytes + 64, _mm512_maskz_permutex2var_epi8(keep1, in0, idx1, in1));
+            _mm512_storeu_si512(dst + outputBytes + 128, _mm512_maskz_permutex2var_epi8(keep2, in0, idx2, in1));
+            outputBytes += 192;
+        }
+#endif
+        for (; i < numSamples; i++) {
             dst[outputBytes + 0] = 0x00;              // padding (LSB)
             dst[outputBytes + 1] = src[i * 2 + 0];    // 16-bit LSB
             dst[outputBytes + 2] = src[i * 2 + 1];    // 16-bit MSB
@@ -781,9 +1171,35 @@ public:
 
 #endif // DIRETTA_HAS_AVX2 / DIRETTA_HAS_NEON
 
+    // Fallback path only (see push24To32()), so no SIMD variants
+    size_t convert24To32(uint8_t* dst, const uint8_t* src, size_t numSamples) {
+        size_t outputBytes = 0;
+        for (size_t i = 0; i < numSamples; i++) {
+            dst[outputBytes + 0] = 0x00;
+            dst[outputBytes + 1] = src[i * 3 + 0];
+            dst[outputBytes + 2] = src[i * 3 + 1];
+            dst[outputBytes + 3] = src[i * 3 + 2];
+            outputBytes += 4;
+        }
+        return outputBytes;
+    }
+
+    // Fallback path only (see pushNarrowTo16()): the top two bytes of each
+    // little-endian sample
+    template<size_t InBps>
+    size_t convertNarrowTo16(uint8_t* dst, const uint8_t* src, size_t numSamples) {
+        for (size_t i = 0; i < numSamples; i++) {
+            dst[i * 2 + 0] = src[i * InBps + InBps - 2];
+            dst[i * 2 + 1] = src[i * InBps + InBps - 1];
+        }
+        return numSamples * 2;
+    }
+
     //=========================================================================
     // Specialized DSD conversion functions - no per-iteration branch checks
     // Mode is determined at track open, eliminating runtime conditionals
+    // Channels: 2 instantiates the stereo SIMD path, 0 the generic loop for
+    // numChannels (other counts never reach the stereo code)
     //=========================================================================
 
     /**
@@ -791,17 +1207,23 @@ public:
      * Used when source bit ordering matches target (DSF→LSB or DFF→MSB)
      * NO bit reversal, NO byte swap
      */
+    template<int Channels>
     size_t convertDSD_Passthrough(uint8_t* dst, const uint8_t* src,
                                    size_t totalInputBytes, int numChannels) {
+        if constexpr (Channels > 0) numChannels = Channels;
         size_t bytesPerChannel = totalInputBytes / static_cast<size_t>(numChannels);
         size_t outputBytes = 0;
 
 #if DIRETTA_HAS_AVX2
-        if (numChannels == 2) {
+        if constexpr (Channels == 2) {
             const uint8_t* srcL = src;
             const uint8_t* srcR = src + bytesPerChannel;
 
             size_t i = 0;
+#if DIRETTA_HAS_AVX512
+            i = interleaveDSDStereo512<false, false>(dst, srcL, srcR, bytesPerChannel);
+            outputBytes = 2 * i;
+#endif
             for (; i + 32 <= bytesPerChannel; i += 32) {
                 __m256i left = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(srcL + i));
                 __m256i right = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(srcR + i));
@@ -837,7 +1259,7 @@ public:
             return outputBytes;
         }
 #elif DIRETTA_HAS_NEON
-        if (numChannels == 2) {
+        if constexpr (Channels == 2) {
             const uint8_t* srcL = src;
             const uint8_t* srcR = src + bytesPerChannel;
 
@@ -888,17 +1310,23 @@ public:
      * DSD BitReverse: Apply bit reversal only (no byte swap)
      * Used for DSF→MSB or DFF→LSB target conversions
      */
+    template<int Channels>
     size_t convertDSD_BitReverse(uint8_t* dst, const uint8_t* src,
                                   size_t totalInputBytes, int numChannels) {
+        if constexpr (Channels > 0) numChannels = Channels;
         size_t bytesPerChannel = totalInputBytes / static_cast<size_t>(numChannels);
         size_t outputBytes = 0;
 
 #if DIRETTA_HAS_AVX2
-        if (numChannels == 2) {
+        if constexpr (Channels == 2) {
             const uint8_t* srcL = src;
             const uint8_t* srcR = src + bytesPerChannel;
 
             size_t i = 0;
+#if DIRETTA_HAS_AVX512
+            i = interleaveDSDStereo512<true, false>(dst, srcL, srcR, bytesPerChannel);
+            outputBytes = 2 * i;
+#endif
             for (; i + 32 <= bytesPerChannel; i += 32) {
                 __m256i left = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(srcL + i));
                 __m256i right = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(srcR + i));
@@ -937,7 +1365,7 @@ public:
             return outputBytes;
         }
 #elif DIRETTA_HAS_NEON
-        if (numChannels == 2) {
+        if constexpr (Channels == 2) {
             const uint8_t* srcL = src;
             const uint8_t* srcR = src + bytesPerChannel;
 
@@ -992,13 +1420,15 @@ public:
      * DSD ByteSwap: Apply byte swap only (no bit reversal)
      * Used for endianness conversion
      */
+    template<int Channels>
     size_t convertDSD_ByteSwap(uint8_t* dst, const uint8_t* src,
                                 size_t totalInputBytes, int numChannels) {
+        if constexpr (Channels > 0) numChannels = Channels;
         size_t bytesPerChannel = totalInputBytes / static_cast<size_t>(numChannels);
         size_t outputBytes = 0;
 
 #if DIRETTA_HAS_AVX2
-        if (numChannels == 2) {
+        if constexpr (Channels == 2) {
             const uint8_t* srcL = src;
             const uint8_t* srcR = src + bytesPerChannel;
 
@@ -1008,6 +1438,10 @@ public:
             );
 
             size_t i = 0;
+#if DIRETTA_HAS_AVX512
+            i = interleaveDSDStereo512<false, true>(dst, srcL, srcR, bytesPerChannel);
+            outputBytes = 2 * i;
+#endif
             for (; i + 32 <= bytesPerChannel; i += 32) {
                 __m256i left = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(srcL + i));
                 __m256i right = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(srcR + i));
@@ -1046,7 +1480,7 @@ public:
             return outputBytes;
         }
 #elif DIRETTA_HAS_NEON
-        if (numChannels == 2) {
+        if constexpr (Channels == 2) {
             const uint8_t* srcL = src;
             const uint8_t* srcR = src + bytesPerChannel;
 
@@ -1101,13 +1535,15 @@ public:
      * DSD BitReverse + ByteSwap: Apply both operations
      * Used when both bit reversal and endianness conversion are needed
      */
+    template<int Channels>
     size_t convertDSD_BitReverseSwap(uint8_t* dst, const uint8_t* src,
                                       size_t totalInputBytes, int numChannels) {
+        if constexpr (Channels > 0) numChannels = Channels;
         size_t bytesPerChannel = totalInputBytes / static_cast<size_t>(numChannels);
         size_t outputBytes = 0;
 
 #if DIRETTA_HAS_AVX2
-        if (numChannels == 2) {
+        if constexpr (Channels == 2) {
             const uint8_t* srcL = src;
             const uint8_t* srcR = src + bytesPerChannel;
 
@@ -1117,6 +1553,10 @@ public:
             );
 
             size_t i = 0;
+#if DIRETTA_HAS_AVX512
+            i = interleaveDSDStereo512<true, true>(dst, srcL, srcR, bytesPerChannel);
+            outputBytes = 2 * i;
+#endif
             for (; i + 32 <= bytesPerChannel; i += 32) {
                 __m256i left = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(srcL + i));
                 __m256i right = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(srcR + i));
@@ -1157,7 +1597,7 @@ public:
             return outputBytes;
         }
 #elif DIRETTA_HAS_NEON
-        if (numChannels == 2) {
+        if constexpr (Channels == 2) {
             const uint8_t* srcL = src;
             const uint8_t* srcR = src + bytesPerChannel;
 
@@ -1212,6 +1652,148 @@ public:
         return outputBytes;
     }
 
+    //=========================================================================
+    // Fused DSD conversion functions (interleaved source -> target layout)
+    // SwapWords: output word is the byte-reversed input word
+    // ReverseBits: bit-reverse every output byte
+    //=========================================================================
+
+    /**
+     * Interleaved U32 words -> target words. Stays interleaved, so this is a
+     * pure per-word transform and works for any channel count.
+     * Returns: number of output bytes written (== input bytes, whole words)
+     */
+    template<bool SwapWords, bool ReverseBits>
+    size_t convertDSDInterleavedU32(uint8_t* dst, const uint8_t* src, size_t totalInputBytes) {
+        size_t i = 0;
+
+#if DIRETTA_HAS_AVX2
+        const __m256i byteswap_mask = _mm256_setr_epi8(
+            3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12,
+            3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12
+        );
+
+#if DIRETTA_HAS_AVX512
+        for (; i + 64 <= totalInputBytes; i += 64) {
+            __m512i v = _mm512_loadu_si512(src + i);
+            if constexpr (SwapWords) v = simd_byteswap32_512(v);
+            if constexpr (ReverseBits) v = simd_bit_reverse512(v);
+            _mm512_storeu_si512(dst + i, v);
+        }
+#endif
+        for (; i + 32 <= totalInputBytes; i += 32) {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+            if constexpr (SwapWords) v = _mm256_shuffle_epi8(v, byteswap_mask);
+            if constexpr (ReverseBits) v = simd_bit_reverse(v);
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), v);
+        }
+        _mm256_zeroupper();
+#elif DIRETTA_HAS_NEON
+        for (; i + 16 <= totalInputBytes; i += 16) {
+            uint8x16_t v = vld1q_u8(src + i);
+            if constexpr (SwapWords) v = vrev32q_u8(v);
+            if constexpr (ReverseBits) v = neon_bit_reverse(v);
+            vst1q_u8(dst + i, v);
+        }
+#endif
+
+        // Scalar tail
+        for (; i + 4 <= totalInputBytes; i += 4) {
+            for (size_t b = 0; b < 4; b++) {
+                uint8_t x = src[i + (SwapWords ? 3 - b : b)];
+                dst[i + b] = ReverseBits ? kBitReverseLUT[x] : x;
+            }
+        }
+        return i;
+    }
+
+    /**
+     * DoP S32_LE -> target words. Each output word per channel carries the
+     * DSD MSB/LSB bytes of two consecutive DoP frames: [f0 MSB, f0 LSB, f1 MSB, f1 LSB].
+     * Returns: number of output bytes written (half the consumed input)
+     */
+    template<bool SwapWords, bool ReverseBits, int Channels>
+    size_t convertDSDFromDoP(uint8_t* dst, const uint8_t* src,
+                             size_t totalInputBytes, int numChannels) {
+        if constexpr (Channels > 0) numChannels = Channels;
+        size_t frameBytes = 4 * static_cast<size_t>(numChannels);
+        size_t pairs = totalInputBytes / (2 * frameBytes);
+        size_t p = 0;
+
+#if DIRETTA_HAS_AVX2
+        if constexpr (Channels == 2) {
+            // Per 128-bit lane (one frame pair [L0 R0 L1 R1]) -> low 8 bytes [L word | R word]
+            const __m256i extract = SwapWords
+                ? _mm256_setr_epi8(9, 10, 1, 2, 13, 14, 5, 6, -1, -1, -1, -1, -1, -1, -1, -1,
+                                   9, 10, 1, 2, 13, 14, 5, 6, -1, -1, -1, -1, -1, -1, -1, -1)
+                : _mm256_setr_epi8(2, 1, 10, 9, 6, 5, 14, 13, -1, -1, -1, -1, -1, -1, -1, -1,
+                                   2, 1, 10, 9, 6, 5, 14, 13, -1, -1, -1, -1, -1, -1, -1, -1);
+
+#if DIRETTA_HAS_AVX512
+            // Same per-lane extract, then qwords [0 2 4 6 | 8 10 12 14] of a:b
+            static const __m512i extract512 = SwapWords
+                ? laneIndex512({9, 10, 1, 2, 13, 14, 5, 6, -1, -1, -1, -1, -1, -1, -1, -1})
+                : laneIndex512({2, 1, 10, 9, 6, 5, 14, 13, -1, -1, -1, -1, -1, -1, -1, -1});
+            const __m512i gather = _mm512_setr_epi64(0, 2, 4, 6, 8, 10, 12, 14);
+            for (; p + 8 <= pairs; p += 8) {
+                __m512i a = _mm512_shuffle_epi8(_mm512_loadu_si512(src + p * 16), extract512);
+                __m512i b = _mm512_shuffle_epi8(_mm512_loadu_si512(src + p * 16 + 64), extract512);
+                __m512i v = _mm512_permutex2var_epi64(a, gather, b);
+                if constexpr (ReverseBits) v = simd_bit_reverse512(v);
+                _mm512_storeu_si512(dst + p * 8, v);
+            }
+#endif
+            for (; p + 4 <= pairs; p += 4) {
+                __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + p * 16));
+                __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + p * 16 + 32));
+                a = _mm256_shuffle_epi8(a, extract);
+                b = _mm256_shuffle_epi8(b, extract);
+
+                // qwords [p, p+2, p+1, p+3] -> [p, p+1, p+2, p+3]
+                __m256i v = _mm256_permute4x64_epi64(_mm256_unpacklo_epi64(a, b),
+                                                     _MM_SHUFFLE(3, 1, 2, 0));
+                if constexpr (ReverseBits) v = simd_bit_reverse(v);
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + p * 8), v);
+            }
+            _mm256_zeroupper();
+        }
+#elif DIRETTA_HAS_NEON
+        if constexpr (Channels == 2) {
+            static const uint8_t extract_idx[16] = {
+                2, 1, 10, 9, 6, 5, 14, 13, 18, 17, 26, 25, 22, 21, 30, 29
+            };
+            static const uint8_t extract_swap_idx[16] = {
+                9, 10, 1, 2, 13, 14, 5, 6, 25, 26, 17, 18, 29, 30, 21, 22
+            };
+            const uint8x16_t extract = vld1q_u8(SwapWords ? extract_swap_idx : extract_idx);
+
+            for (; p + 2 <= pairs; p += 2) {
+                uint8x16x2_t in = {{ vld1q_u8(src + p * 16), vld1q_u8(src + p * 16 + 16) }};
+                uint8x16_t v = vqtbl2q_u8(in, extract);
+                if constexpr (ReverseBits) v = neon_bit_reverse(v);
+                vst1q_u8(dst + p * 8, v);
+            }
+        }
+#endif
+
+        // Scalar tail (and non-stereo layouts)
+        for (; p < pairs; p++) {
+            const uint8_t* f0 = src + p * 2 * frameBytes;
+            const uint8_t* f1 = f0 + frameBytes;
+            uint8_t* out = dst + p * frameBytes;
+
+            for (int ch = 0; ch < numChannels; ch++) {
+                const uint8_t word[4] = { f0[ch * 4 + 2], f0[ch * 4 + 1],
+                                          f1[ch * 4 + 2], f1[ch * 4 + 1] };
+                for (size_t b = 0; b < 4; b++) {
+                    uint8_t x = word[SwapWords ? 3 - b : b];
+                    out[ch * 4 + b] = ReverseBits ? kBitReverseLUT[x] : x;
+                }
+            }
+        }
+        return pairs * frameBytes;
+    }
+
     //=========================================================================
     // Pop method (read from buffer)
     //=========================================================================
@@ -1221,47 +1803,141 @@ public:
      */
     size_t pop(uint8_t* dest, size_t len) {
         if (size_ == 0) return 0;
-        size_t avail = getAvailable();
+        size_t avail = readableBytes(len);
         if (len > avail) len = avail;
         if (len == 0) return 0;
 
-        size_t rp = readPos_.load(std::memory_order_acquire);
+        size_t rp = readPos_.load(std::memory_order_relaxed);
         size_t firstChunk = std::min(len, size_ - rp);
 
-        memcpy_audio(dest, buffer_.data() + rp, firstChunk);
+        memcpy_audio(dest, base_ + rp, firstChunk);
         if (firstChunk < len) {
-            memcpy_audio(dest + firstChunk, buffer_.data(), len - firstChunk);
+            memcpy_audio(dest + firstChunk, base_, len - firstChunk);
         }
 
         readPos_.store((rp + len) & mask_, std::memory_order_release);
         return len;
     }
 
-    uint8_t* data() { return buffer_.data(); }
-    const uint8_t* data() const { return buffer_.data(); }
+    //=========================================================================
+    // Zero-copy read API (mirrored storage only)
+    //=========================================================================
+
+    /**
+     * @brief Hand out the next len bytes in place instead of copying them
+     *
+     * The bytes stay counted in getAvailable() and are not overwritten by
+     * the producer until releaseReadRegion() advances the read position.
+     * Releases any region still held from the previous call first.
+     *
+     * @return Pointer to len contiguous bytes, or nullptr if storage is not
+     *         mirrored or fewer than len bytes are available
+     */
+    const uint8_t* acquireReadRegion(size_t len) {
+        releaseReadRegion();
+        if (mirror_ == nullptr || len == 0 || len > readableBytes(len)) return nullptr;
+
+        size_t rp = readPos_.load(std::memory_order_relaxed);
+        heldRead_.store(len, std::memory_order_relaxed);
+        return base_ + rp;
+    }
+
+    /**
+     * @brief Consume the region returned by the last acquireReadRegion()
+     *
+     * No-op when nothing is held. clear() drops a held region without
+     * consuming it.
+     */
+    void releaseReadRegion() {
+        size_t held = heldRead_.exchange(0, std::memory_order_relaxed);
+        if (held == 0) return;
+        held = std::min(held, readableBytes(held));
+        size_t rp = readPos_.load(std::memory_order_relaxed);
+        readPos_.store((rp + held) & mask_, std::memory_order_release);
+    }
+
+    uint8_t* data() { return base_; }
+    const uint8_t* data() const { return base_; }
 
 private:
+    //=========================================================================
+    // SPSC index access
+    //=========================================================================
+    // Each side owns one index and keeps a copy of the other's. The copy
+    // is only reloaded when it seems to leave too little space (producer)
+    // or data (consumer), so in steady state neither side touches the
+    // other's cache line on every call. A stale copy can only understate
+    // what is there, never overstate it.
+
+    // Producer: free bytes, refreshing the read position if below wanted
+    size_t writableSpace(size_t wanted) {
+        size_t wp = writePos_.load(std::memory_order_relaxed);
+        size_t rp = cachedReadPos_;
+        size_t free = (rp - wp - 1) & mask_;
+        if (free < wanted) {
+            rp = readPos_.load(std::memory_order_acquire);
+            cachedReadPos_ = rp;
+            free = (rp - wp - 1) & mask_;
+        }
+        return free;
+    }
+
+    // Consumer: buffered bytes, refreshing the write position if below wanted
+    size_t readableBytes(size_t wanted) {
+        size_t rp = readPos_.load(std::memory_order_relaxed);
+        size_t wp = cachedWritePos_;
+        size_t avail = (wp - rp) & mask_;
+        if (avail < wanted) {
+            wp = writePos_.load(std::memory_order_acquire);
+            cachedWritePos_ = wp;
+            avail = (wp - rp) & mask_;
+        }
+        return avail;
+    }
+
+    /**
+     * Pick the output buffer for a conversion producing outBytes.
+     * Converts straight into the ring when the write doesn't wrap (the
+     * common case), so the staging copy only happens at the wrap point.
+     */
+    uint8_t* conversionTarget(size_t outBytes, uint8_t* staging) {
+        uint8_t* region;
+        size_t available;
+        if (getDirectWriteRegion(outBytes, region, available)) {
+            return region;
+        }
+        return staging;
+    }
+
+    /**
+     * Complete a conversion started with conversionTarget()
+     * @return Bytes added to the ring
+     */
+    size_t finishConversion(uint8_t* dst, const uint8_t* staging, size_t len) {
+        if (dst != staging) {
+            commitDirectWrite(len);
+            return len;
+        }
+        return writeToRing(staging, len);
+    }
+
     /**
      * Write staged data to ring buffer with efficient wraparound handling
      * Uses memcpy_audio_fixed for consistent timing
      */
     size_t writeToRing(const uint8_t* staged, size_t len) {
-        size_t size = buffer_.size();
+        size_t size = size_;
         if (size == 0 || len == 0) return 0;
 
         size_t writePos = writePos_.load(std::memory_order_relaxed);
-        size_t readPos = readPos_.load(std::memory_order_acquire);
-
-        size_t available = (readPos > writePos)
-            ? (readPos - writePos - 1)
-            : (size - writePos + readPos - 1);
+        size_t available = writableSpace(len);
 
         if (len > available) {
             len = available;
         }
         if (len == 0) return 0;
 
-        uint8_t* ring = buffer_.data();
+        uint8_t* ring = base_;
         size_t firstChunk = std::min(len, size - writePos);
 
         if (firstChunk > 0) {
@@ -1299,6 +1975,135 @@ private:
     }
 #endif // DIRETTA_HAS_AVX2
 
+#if DIRETTA_HAS_AVX512
+    static __m512i simd_bit_reverse512(__m512i x) {
+#if DIRETTA_HAS_GFNI
+        // Bit-reversed identity matrix: one gf2p8affineqb per 64 bytes
+        return _mm512_gf2p8affine_epi64_epi8(x, _mm512_set1_epi64(0x8040201008040201LL), 0);
+#else
+        static const __m512i nibble_reverse = laneIndex512({
+            0x0, 0x8, 0x4, 0xC, 0x2, 0xA, 0x6, 0xE,
+            0x1, 0x9, 0x5, 0xD, 0x3, 0xB, 0x7, 0xF
+        });
+
+        __m512i mask_0f = _mm512_set1_epi8(0x0F);
+        __m512i lo_nibbles = _mm512_and_si512(x, mask_0f);
+        __m512i hi_nibbles = _mm512_and_si512(_mm512_srli_epi16(x, 4), mask_0f);
+
+        __m512i lo_reversed = _mm512_shuffle_epi8(nibble_reverse, lo_nibbles);
+        __m512i hi_reversed = _mm512_shuffle_epi8(nibble_reverse, hi_nibbles);
+
+        return _mm512_or_si512(_mm512_slli_epi16(lo_reversed, 4), hi_reversed);
+#endif
+    }
+
+    static __m512i simd_byteswap32_512(__m512i x) {
+        static const __m512i byteswap_mask = laneIndex512({
+            3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12
+        });
+        return _mm512_shuffle_epi8(x, byteswap_mask);
+    }
+
+    // 64 byte indices for vpermb/vpermt2b, index(j) for output byte j
+    template<typename IndexFn>
+    static __m512i byteIndex512(IndexFn index) {
+        alignas(64) uint8_t idx[64];
+        for (int j = 0; j < 64; j++) {
+            idx[j] = static_cast<uint8_t>(index(j));
+        }
+        return _mm512_load_si512(idx);
+    }
+
+    // The same 16-byte vpshufb pattern in every 128-bit lane (-1 = zero)
+    static __m512i laneIndex512(std::initializer_list<int> lane) {
+        const int* pattern = lane.begin();
+        return byteIndex512([pattern](int j) { return pattern[j & 15]; });
+    }
+
+    /**
+     * S24_P32 -> packed 24-bit, Offset = first kept byte (0 LSB-aligned,
+     * 1 MSB-aligned). VBMI: 64 samples -> three full 64-byte stores via
+     * vpermt2b. AVX512BW: 16 samples -> vpshufb + vpermd + one 48-byte
+     * masked store. Returns samples converted; the caller does the rest.
+     */
+    template<int Offset>
+    static size_t pack24_512(uint8_t* dst, const uint8_t* src, size_t numSamples) {
+        size_t i = 0;
+#if DIRETTA_HAS_AVX512_VBMI
+        // Output vector m draws from input vectors m and m+1 (bytes 64m..64m+127)
+        auto sourceByte = [](int m, int j) {
+            int k = 64 * m + j;
+            return (k / 3) * 4 + k % 3 + Offset - 64 * m;
+        };
+        static const __m512i idx0 = byteIndex512([&](int j) { return sourceByte(0, j); });
+        static const __m512i idx1 = byteIndex512([&](int j) { return sourceByte(1, j); });
+        static const __m512i idx2 = byteIndex512([&](int j) { return sourceByte(2, j); });
+
+        for (; i + 64 <= numSamples; i += 64) {
+            const uint8_t* in = src + i * 4;
+            uint8_t* out = dst + i * 3;
+            __m512i in0 = _mm512_loadu_si512(in);
+            __m512i in1 = _mm512_loadu_si512(in + 64);
+            __m512i in2 = _mm512_loadu_si512(in + 128);
+            __m512i in3 = _mm512_loadu_si512(in + 192);
+            _mm512_storeu_si512(out, _mm512_permutex2var_epi8(in0, idx0, in1));
+            _mm512_storeu_si512(out + 64, _mm512_permutex2var_epi8(in1, idx1, in2));
+            _mm512_storeu_si512(out + 128, _mm512_permutex2var_epi8(in2, idx2, in3));
+        }
+#else
+        static const __m512i shuffle_mask = laneIndex512({
+            Offset, Offset + 1, Offset + 2, Offset + 4, Offset + 5, Offset + 6,
+            Offset + 8, Offset + 9, Offset + 10, Offset + 12, Offset + 13, Offset + 14,
+            -1, -1, -1, -1
+        });
+        // 12 bytes per lane -> 48 contiguous bytes
+        const __m512i compact = _mm512_setr_epi32(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, 0, 0, 0, 0);
+
+        for (; i + 16 <= numSamples; i += 16) {
+            __m512i in = _mm512_loadu_si512(src + i * 4);
+            __m512i packed = _mm512_maskz_permutexvar_epi32(0x0FFF, compact, _mm512_shuffle_epi8(in, shuffle_mask));
+            _mm512_mask_storeu_epi32(dst + i * 3, 0x0FFF, packed);
+        }
+#endif
+        return i;
+    }
+
+    /**
+     * Stereo planar DSD -> interleaved 32-bit words [L R L R ...], 64 bytes
+     * per channel per iteration (vpermt2d, no lane fix-up needed).
+     * Returns bytes consumed per channel; output is twice that.
+     */
+    template<bool ReverseBits, bool SwapWords>
+    static size_t interleaveDSDStereo512(uint8_t* dst, const uint8_t* srcL,
+                                         const uint8_t* srcR, size_t bytesPerChannel) {
+        const __m512i idx_lo = _mm512_setr_epi32(0, 16, 1, 17, 2, 18, 3, 19, 4, 20, 5, 21, 6, 22, 7, 23);
+        const __m512i idx_hi = _mm512_setr_epi32(8, 24, 9, 25, 10, 26, 11, 27, 12, 28, 13, 29, 14, 30, 15, 31);
+
+        size_t i = 0;
+        for (; i + 64 <= bytesPerChannel; i += 64) {
+            __m512i left = _mm512_loadu_si512(srcL + i);
+            __m512i right = _mm512_loadu_si512(srcR + i);
+
+            if constexpr (ReverseBits) {
+                left = simd_bit_reverse512(left);
+                right = simd_bit_reverse512(right);
+            }
+
+            __m512i out0 = _mm512_permutex2var_epi32(left, idx_lo, right);
+            __m512i out1 = _mm512_permutex2var_epi32(left, idx_hi, right);
+
+            if constexpr (SwapWords) {
+                out0 = simd_byteswap32_512(out0);
+                out1 = simd_byteswap32_512(out1);
+            }
+
+            _mm512_storeu_si512(dst + 2 * i, out0);
+            _mm512_storeu_si512(dst + 2 * i + 64, out1);
+        }
+        return i;
+    }
+#endif // DIRETTA_HAS_AVX512
+
 #if DIRETTA_HAS_NEON
     /**
      * NEON bit reversal using nibble lookup table
@@ -1339,13 +2144,111 @@ private:
     alignas(64) uint8_t m_staging16To32[STAGING_SIZE];
     alignas(64) uint8_t m_stagingDSD[STAGING_SIZE];
 
+    /**
+     * Map a memfd of ringSize bytes twice, back to back, so that
+     * base[i + ringSize] aliases base[i]. Needs a page-multiple size.
+     * @return Base of the 2 * ringSize mapping, or nullptr
+     */
+    static uint8_t* mapMirror(size_t ringSize, bool huge) {
+        long page = huge ? static_cast<long>(HUGE_PAGE_BYTES) : sysconf(_SC_PAGESIZE);
+        if (page <= 0 || ringSize == 0 || ringSize % static_cast<size_t>(page) != 0) {
+            return nullptr;
+        }
+
+        int fd = memfd_create("diretta-ring", MFD_CLOEXEC | (huge ? MFD_HUGETLB : 0u));
+        if (fd < 0) return nullptr;
+        if (ftruncate(fd, static_cast<off_t>(ringSize)) != 0) {
+            ::close(fd);
+            return nullptr;
+        }
+
+        // Reserve the full span, then put the memfd over both halves. Huge
+        // page mappings must start on a huge page boundary: over-reserve by
+        // one page and trim the slack on either side.
+        size_t slack = huge ? static_cast<size_t>(page) : 0;
+        void* span = mmap(nullptr, 2 * ringSize + slack, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (span == MAP_FAILED) {
+            ::close(fd);
+            return nullptr;
+        }
+        uint8_t* base = static_cast<uint8_t*>(span);
+        if (slack) {
+            uintptr_t addr = reinterpret_cast<uintptr_t>(base);
+            uint8_t* aligned = reinterpret_cast<uint8_t*>((addr + slack - 1) & ~(uintptr_t(slack) - 1));
+            size_t head = static_cast<size_t>(aligned - base);
+            if (head) munmap(base, head);
+            if (slack - head) munmap(aligned + 2 * ringSize, slack - head);
+            base = aligned;
+            span = base;
+        }
+        bool ok = mmap(base, ringSize, PROT_READ | PROT_WRITE,
+                       MAP_SHARED | MAP_FIXED, fd, 0) != MAP_FAILED &&
+                  mmap(base + ringSize, ringSize, PROT_READ | PROT_WRITE,
+                       MAP_SHARED | MAP_FIXED, fd, 0) != MAP_FAILED;
+        ::close(fd);  // The mappings keep the pages alive
+        if (!ok) {
+            munmap(span, 2 * ringSize);
+            return nullptr;
+        }
+        return base;
+    }
+
+    static void unmapMirror(uint8_t* base, size_t ringSize) {
+        if (base) munmap(base, 2 * ringSize);
+    }
+
+    void allocateStorage(size_t ringSize) {
+        // Keep the current mirror for one more generation (see resize())
+        unmapMirror(retiredMirror_, retiredMirrorSize_);
+        retiredMirror_ = mirror_;
+        retiredMirrorSize_ = mirrorSize_;
+
+        mirror_ = nullptr;
+        mirrorHuge_ = false;
+        if (hugePages_) {
+            mirror_ = mapMirror(ringSize, true);
+            mirrorHuge_ = mirror_ != nullptr;
+        }
+        if (!mirror_) {
+            mirror_ = mapMirror(ringSize, false);
+        }
+        mirrorSize_ = mirror_ ? ringSize : 0;
+        if (mirror_) {
+            buffer_.clear();
+            buffer_.shrink_to_fit();
+            base_ = mirror_;
+        } else {
+            buffer_.resize(ringSize);
+            base_ = buffer_.data();
+        }
+        size_ = ringSize;
+        mask_ = size_ - 1;
+    }
+
     static constexpr size_t kRingAlignment = 64;
+    static constexpr size_t HUGE_PAGE_BYTES = 2 * 1024 * 1024;  // x86-64/arm64 default hugetlbfs size
 
+    // Fallback storage when the mirrored mapping is unavailable
     std::vector<uint8_t, AlignedAllocator<uint8_t, kRingAlignment>> buffer_;
+    uint8_t* base_ = nullptr;           // mirror_ or buffer_.data()
+    uint8_t* mirror_ = nullptr;
+    size_t mirrorSize_ = 0;
+    uint8_t* retiredMirror_ = nullptr;
+    size_t retiredMirrorSize_ = 0;
+    bool mirrorHuge_ = false;
+    bool populate_ = false;
+    bool hugePages_ = false;
+    std::atomic<size_t> heldRead_{0};   // Bytes handed out by acquireReadRegion()
     size_t size_ = 0;
     size_t mask_ = 0;
+    // Each index shares its line with its owner's copy of the other one
     alignas(64) std::atomic<size_t> writePos_{0};
+    // Each copy belongs to one side. discard() resets both, which is only
+    // safe with neither side in push/pop (ReconfigureGuard): a side that
+    // stored its copy after the reset would act on the old position.
+    size_t cachedReadPos_ = 0;               // Producer's copy of readPos_
     alignas(64) std::atomic<size_t> readPos_{0};
+    size_t cachedWritePos_ = 0;              // Consumer's copy of writePos_
     std::atomic<uint8_t> silenceByte_{0};
 
 public:
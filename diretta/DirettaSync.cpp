@@ -7,10 +7,14 @@
  */
 
 #include "DirettaSync.h"
+#include "Futex.h"   // W1: parking the SDK worker
 #include <stdexcept>
 #include <iomanip>
 #include <pthread.h>
 #include <sched.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <unistd.h>
 
 namespace {
 
@@ -28,29 +32,6 @@ bool interruptibleWait(std::mutex& mutex, std::condition_variable& cv,
     return !interrupted;  // Return true if timeout (normal), false if interrupted
 }
 
-// F1: Worker thread priority elevation for reduced jitter
-// Sets SCHED_FIFO real-time priority (requires root on Linux)
-// Returns true on success, false on failure (logs warning but continues)
-bool setRealtimePriority(int priority = 50) {
-    struct sched_param param;
-    param.sched_priority = priority;
-
-    int ret = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
-    if (ret != 0) {
-        // Not fatal - may not have CAP_SYS_NICE or running as non-root
-        if (g_verbose) {
-            std::cerr << "[DirettaSync] Warning: Could not set SCHED_FIFO priority "
-                      << priority << " (error " << ret << ")" << std::endl;
-        }
-        return false;
-    }
-
-    if (g_verbose) {
-        std::cout << "[DirettaSync] Worker thread set to SCHED_FIFO priority " << priority << std::endl;
-    }
-    return true;
-}
-
 class RingAccessGuard {
 public:
     RingAccessGuard(std::atomic<int>& users, const std::atomic<bool>& reconfiguring)
@@ -81,19 +62,83 @@ private:
     std::atomic<int>& users_;
     bool active_;
 };
+
+// Sink format preference lists; the index of the accepted entry is what
+// TargetCache remembers
+constexpr int PCM_SINK_BITS[] = {32, 24, 16};
+
+struct DsdSinkVariant {
+    const char* name;
+    bool sinkLSB;        // Bit order the sink expects
+    bool littleEndian;   // 32-bit words byte-swapped
+};
+
+// The last entry (base format only) is treated as LSB | BIG
+constexpr DsdSinkVariant DSD_SINK_VARIANTS[] = {
+    {"LSB | BIG", true, false},       // Most common for DSF files
+    {"MSB | BIG", false, false},
+    {"LSB | LITTLE", true, true},
+    {"MSB | LITTLE", false, true},
+    {"FMT_DSD1 only", true, false},   // Last resort
+};
+
+void setPcmSinkFormat(DIRETTA::FormatConfigure& fmt, int bits) {
+    switch (bits) {
+        case 32: fmt.setFormat(DIRETTA::FormatID::FMT_PCM_SIGNED_32); break;
+        case 24: fmt.setFormat(DIRETTA::FormatID::FMT_PCM_SIGNED_24); break;
+        default: fmt.setFormat(DIRETTA::FormatID::FMT_PCM_SIGNED_16); break;
+    }
+}
+
+void setDsdSinkFormat(DIRETTA::FormatConfigure& fmt, size_t variant) {
+    switch (variant) {
+        case 0:
+            fmt.setFormat(DIRETTA::FormatID::FMT_DSD1 | DIRETTA::FormatID::FMT_DSD_SIZ_32 |
+                          DIRETTA::FormatID::FMT_DSD_LSB | DIRETTA::FormatID::FMT_DSD_BIG);
+            break;
+        case 1:
+            fmt.setFormat(DIRETTA::FormatID::FMT_DSD1 | DIRETTA::FormatID::FMT_DSD_SIZ_32 |
+                          DIRETTA::FormatID::FMT_DSD_MSB | DIRETTA::FormatID::FMT_DSD_BIG);
+            break;
+        case 2:
+            fmt.setFormat(DIRETTA::FormatID::FMT_DSD1 | DIRETTA::FormatID::FMT_DSD_SIZ_32 |
+                          DIRETTA::FormatID::FMT_DSD_LSB | DIRETTA::FormatID::FMT_DSD_LITTLE);
+            break;
+        case 3:
+            fmt.setFormat(DIRETTA::FormatID::FMT_DSD1 | DIRETTA::FormatID::FMT_DSD_SIZ_32 |
+                          DIRETTA::FormatID::FMT_DSD_MSB | DIRETTA::FormatID::FMT_DSD_LITTLE);
+            break;
+        default:
+            fmt.setFormat(DIRETTA::FormatID::FMT_DSD1);
+            break;
+    }
+}
+
+std::string sinkFormatKey(const char* family, uint32_t rate, int channels) {
+    return std::string(family) + ":" + std::to_string(rate) + ":" + std::to_string(channels);
+}
+
 } // namespace
 
 //=============================================================================
 // Constructor / Destructor
 //=============================================================================
 
-DirettaSync::DirettaSync() {
+DirettaSync::DirettaSync()
+    : m_streamData(DirettaBuffer::MAX_STREAM_BUFFER_BYTES)
+    , m_silencePCM(DirettaBuffer::SILENCE_PAGE_BYTES, 0x00)
+    , m_silenceDSD(DirettaBuffer::SILENCE_PAGE_BYTES, 0x69) {
     m_ringBuffer.resize(44100 * 2 * 4, 0x00);
+    m_flowEventFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
     DIRETTA_LOG("Created");
 }
 
 DirettaSync::~DirettaSync() {
     disable();
+    shutdownWorker();  // W1: Worker outlives release(); also covers a failed enable()
+    if (m_flowEventFd >= 0) {
+        ::close(m_flowEventFd);
+    }
     DIRETTA_LOG("Destroyed");
 }
 
@@ -108,24 +153,49 @@ bool DirettaSync::enable(const DirettaConfig& config) {
     }
 
     m_config = config;
+    m_bufferTuner.configure(config.adaptiveBuffer, config.bufferScaleMin, config.bufferScaleMax);
+    if (config.realtimeMemory || config.hugePages) {
+        // Storage is re-allocated per format in open(), never while streaming;
+        // populating it there keeps the first cycles free of page faults
+        m_ringBuffer.setMemoryMode(config.realtimeMemory, config.hugePages);
+        m_ringBuffer.prefaultStaging();
+    }
+    size_t cachedFormats = m_targetCache.open(config.sinkCachePath);
+    if (!config.sinkCachePath.empty()) {
+        LOG_INFO("[DirettaSync] Sink format cache: " << config.sinkCachePath
+                 << " (" << cachedFormats << " entries)");
+    }
+    size_t cachedTargets = m_discoveryCache.open(config.discoveryCachePath);
+    if (!config.discoveryCachePath.empty()) {
+        LOG_INFO("[DirettaSync] Discovery cache: " << config.discoveryCachePath
+                 << " (" << cachedTargets << " entries)");
+    }
     DIRETTA_LOG("Enabling...");
 
-    if (!discoverTarget()) {
-        DIRETTA_LOG("Failed to discover target");
-        return false;
-    }
+    if (!useCachedTarget()) {
+        if (!discoverTarget()) {
+            DIRETTA_LOG("Failed to discover target");
+            return false;
+        }
 
-    if (!measureMTU()) {
-        DIRETTA_LOG("MTU measurement failed, using fallback");
+        if (!measureMTU()) {
+            DIRETTA_LOG("MTU measurement failed, using fallback");
+        }
+        storeDiscovery();
     }
 
     m_calculator = std::make_unique<DirettaCycleCalculator>(m_effectiveMTU);
 
     if (!openSyncConnection()) {
         DIRETTA_LOG("Failed to open sync connection");
+        joinRevalidation();
         return false;
     }
 
+    if (m_targetUnconfirmed) {
+        startRevalidation();
+    }
+
     m_enabled = true;
     DIRETTA_LOG("Enabled, MTU=" << m_effectiveMTU);
     return true;
@@ -140,10 +210,12 @@ void DirettaSync::disable() {
         m_transitionWakeup.store(true, std::memory_order_release);
     }
     m_transitionCv.notify_all();
+    wakeFlowWaiter();
 
     if (m_open) {
         close();
     }
+    joinRevalidation();
 
     if (m_enabled) {
         shutdownWorker();
@@ -196,6 +268,26 @@ bool DirettaSync::openSyncConnection() {
 bool DirettaSync::discoverTarget() {
     DIRETTA_LOG("Discovering Diretta target...");
 
+    DiscoveredTarget target;
+    if (!findTarget(target)) {
+        return false;
+    }
+
+    DIRETTA_LOG("Found " << target.found << " target(s)");
+    if (target.found == 1 || m_targetIndex == 0) {
+        DIRETTA_LOG("Selected: " << target.name);
+    } else if (m_targetIndex > 0 && m_targetIndex < static_cast<int>(target.found)) {
+        DIRETTA_LOG("Selected target #" << (m_targetIndex + 1));
+    } else {
+        DIRETTA_LOG("Selected first target: " << target.name);
+    }
+
+    m_targetAddress = target.address;
+    m_targetKey = target.key;
+    return true;
+}
+
+bool DirettaSync::findTarget(DiscoveredTarget& target) const {
     DIRETTA::Find::Setting findSettings;
     findSettings.Loopback = false;
     findSettings.ProductID = 0;
@@ -215,22 +307,21 @@ bool DirettaSync::discoverTarget() {
         return false;
     }
 
-    DIRETTA_LOG("Found " << results.size() << " target(s)");
-
-    if (results.size() == 1 || m_targetIndex == 0) {
-        auto it = results.begin();
-        m_targetAddress = it->first;
-        DIRETTA_LOG("Selected: " << it->second.targetName);
-    } else if (m_targetIndex > 0 && m_targetIndex < static_cast<int>(results.size())) {
-        auto it = results.begin();
+    auto it = results.begin();
+    if (m_targetIndex > 0 && m_targetIndex < static_cast<int>(results.size())) {
         std::advance(it, m_targetIndex);
-        m_targetAddress = it->first;
-        DIRETTA_LOG("Selected target #" << (m_targetIndex + 1));
-    } else {
-        auto it = results.begin();
-        m_targetAddress = it->first;
-        DIRETTA_LOG("Selected first target: " << it->second.targetName);
     }
+    target.address = it->first;
+    target.name = it->second.targetName;
+    target.found = results.size();
+
+    // What the sink accepts is a property of the device and its firmware;
+    // a firmware update gets a new key and is probed afresh
+    const auto& info = it->second;
+    std::ostringstream key;
+    key << info.targetName << '/' << info.outputName << " port " << info.PO
+        << " pid 0x" << std::hex << info.productID << std::dec << " v" << info.version;
+    target.key = key.str();
 
     find.close();
     return true;
@@ -251,29 +342,170 @@ bool DirettaSync::measureMTU() {
 
     DIRETTA_LOG("Measuring MTU...");
 
+    uint32_t measuredMTU = 0;
+    if (probeMTU(m_targetAddress, measuredMTU)) {
+        m_effectiveMTU = measuredMTU;
+        DIRETTA_LOG("Measured MTU=" << m_effectiveMTU);
+        return true;
+    }
+
+    m_effectiveMTU = m_config.mtuFallback;
+    DIRETTA_LOG("MTU measurement failed, using fallback=" << m_effectiveMTU);
+    return false;
+}
+
+bool DirettaSync::probeMTU(const ACQUA::IPAddress& address, uint32_t& mtu) const {
     DIRETTA::Find::Setting findSettings;
     findSettings.Loopback = false;
     findSettings.ProductID = 0;
 
     DIRETTA::Find find(findSettings);
     if (!find.open()) {
-        m_effectiveMTU = m_config.mtuFallback;
         return false;
     }
 
-    uint32_t measuredMTU = 0;
-    bool ok = find.measSendMTU(m_targetAddress, measuredMTU);
+    mtu = 0;
+    bool ok = find.measSendMTU(address, mtu);
     find.close();
+    return ok && mtu > 0;
+}
 
-    if (ok && measuredMTU > 0) {
-        m_effectiveMTU = measuredMTU;
-        DIRETTA_LOG("Measured MTU=" << m_effectiveMTU);
+//=============================================================================
+// Discovery Cache
+//=============================================================================
+
+std::string DirettaSync::discoverySelection() const {
+    return "index " + std::to_string(std::max(m_targetIndex, 0));
+}
+
+bool DirettaSync::useCachedTarget() {
+    DiscoveryCache::Entry entry;
+    if (!m_discoveryCache.lookup(discoverySelection(), entry)) {
+        return false;
+    }
+    ACQUA::IPAddress address;
+    if (!DiscoveryCache::decodeAddress(entry.address, address)) {
+        DIRETTA_LOG("Cached discovery for " << discoverySelection() << " has no usable address");
+        return false;
+    }
+
+    m_targetAddress = address;
+    m_targetKey = entry.target;
+    if (mtuConfigured()) {
+        measureMTU();
+    } else {
+        m_effectiveMTU = entry.mtu > 0 ? entry.mtu : m_config.mtuFallback;
+    }
+    m_targetUnconfirmed = true;
+
+    LOG_INFO("[DirettaSync] Using cached target " << m_targetKey << ", MTU " << m_effectiveMTU
+             << " (revalidating in the background)");
+    return true;
+}
+
+void DirettaSync::storeDiscovery() {
+    DiscoveryCache::Entry entry;
+    entry.target = m_targetKey;
+    entry.mtu = m_effectiveMTU;
+    DiscoveryCache::encodeAddress(m_targetAddress, entry.address);
+    if (!m_discoveryCache.store(discoverySelection(), entry)) {
+        LOG_WARN("[DirettaSync] Could not write discovery cache " << m_config.discoveryCachePath);
+    }
+}
+
+void DirettaSync::startRevalidation() {
+    joinRevalidation();
+
+    // Works on copies: the target members belong to the open() thread
+    DiscoveredTarget cached;
+    cached.address = m_targetAddress;
+    cached.key = m_targetKey;
+    uint32_t cachedMTU = m_effectiveMTU;
+    bool probe = !mtuConfigured();
+
+    m_revalidateThread = std::thread([this, cached, cachedMTU, probe] {
+        DiscoveredTarget found;
+        if (!findTarget(found)) {
+            LOG_WARN("[DirettaSync] Cached target not found by discovery; "
+                     "a failed connect will retry discovery");
+            return;
+        }
+        uint32_t mtu = cachedMTU;
+        if (probe && !probeMTU(found.address, mtu)) {
+            mtu = cachedMTU;
+        }
+
+        DiscoveryCache::Entry entry;
+        entry.target = found.key;
+        entry.mtu = probe ? mtu : cachedMTU;
+        DiscoveryCache::encodeAddress(found.address, entry.address);
+        if (!m_discoveryCache.store(discoverySelection(), entry)) {
+            LOG_WARN("[DirettaSync] Could not write discovery cache " << m_config.discoveryCachePath);
+        }
+
+        if (found.address == cached.address && found.key == cached.key && mtu == cachedMTU) {
+            DIRETTA_LOG("Cached target confirmed by discovery");
+            return;
+        }
+        LOG_INFO("[DirettaSync] Target changed since the cache was written: " << found.key
+                 << ", MTU " << mtu << " (used from the next connect)");
+        std::lock_guard<std::mutex> lock(m_revalidateMutex);
+        m_revalidatedTarget = found;
+        m_revalidatedMTU = mtu;
+        m_hasRevalidated = true;
+    });
+}
+
+void DirettaSync::joinRevalidation() {
+    if (m_revalidateThread.joinable()) {
+        m_revalidateThread.join();
+    }
+}
+
+/**
+ * Switch to what the background discovery found, if it differed from the
+ * cache. Only called before a full connect, never while streaming.
+ * @return true if the target or MTU changed
+ */
+bool DirettaSync::adoptRevalidatedTarget() {
+    std::lock_guard<std::mutex> lock(m_revalidateMutex);
+    if (!m_hasRevalidated) return false;
+    m_hasRevalidated = false;
+
+    m_targetAddress = m_revalidatedTarget.address;
+    m_targetKey = m_revalidatedTarget.key;
+    if (m_revalidatedMTU != m_effectiveMTU) {
+        m_effectiveMTU = m_revalidatedMTU;
+        m_calculator = std::make_unique<DirettaCycleCalculator>(m_effectiveMTU);
+    }
+    m_targetUnconfirmed = false;
+    DIRETTA_LOG("Switched to revalidated target " << m_targetKey << ", MTU=" << m_effectiveMTU);
+    return true;
+}
+
+/**
+ * The cached target didn't accept setSink(): use the background result, or
+ * run a full discovery now.
+ * @return true if there is a target to retry with
+ */
+bool DirettaSync::rediscoverTarget() {
+    m_targetUnconfirmed = false;
+    joinRevalidation();
+    if (adoptRevalidatedTarget()) {
         return true;
     }
 
-    m_effectiveMTU = m_config.mtuFallback;
-    DIRETTA_LOG("MTU measurement failed, using fallback=" << m_effectiveMTU);
-    return false;
+    LOG_WARN("[DirettaSync] Cached target did not answer, running full discovery");
+    if (!discoverTarget()) {
+        return false;
+    }
+    uint32_t previousMTU = m_effectiveMTU;
+    measureMTU();
+    if (m_effectiveMTU != previousMTU) {
+        m_calculator = std::make_unique<DirettaCycleCalculator>(m_effectiveMTU);
+    }
+    storeDiscovery();
+    return true;
 }
 
 bool DirettaSync::verifyTargetAvailable() {
@@ -408,284 +640,90 @@ bool DirettaSync::open(const AudioFormat& format) {
     bool newIsDsd = format.isDSD;
     bool needFullConnect = true;  // Whether we need connectPrepare/connect/connectWait
 
-    // Fast path: Already open with same format - just reset buffer and resume
-    // This avoids the expensive setSink/connect sequence for same-format track transitions
-    if (m_open && m_hasPreviousFormat) {
-        bool sameFormat = (m_previousFormat.sampleRate == format.sampleRate &&
-                          m_previousFormat.bitDepth == format.bitDepth &&
-                          m_previousFormat.channels == format.channels &&
-                          m_previousFormat.isDSD == format.isDSD);
+    // T1: Reuse the plan drainForTransition() made while the previous
+    // track's tail was playing, or decide now
+    TransitionPlan plan = (m_hasPendingPlan && m_pendingPlanFormat == format)
+        ? m_pendingPlan : planTransition(format);
+    m_hasPendingPlan = false;
 
+    if (plan.kind != TransitionKind::Fresh) {
         std::cout << "[DirettaSync]   Previous: " << m_previousFormat.sampleRate << "Hz/"
                   << m_previousFormat.bitDepth << "bit/" << m_previousFormat.channels << "ch"
                   << (m_previousFormat.isDSD ? " DSD" : " PCM") << std::endl;
         std::cout << "[DirettaSync]   Current:  " << format.sampleRate << "Hz/"
                   << format.bitDepth << "bit/" << format.channels << "ch"
                   << (format.isDSD ? " DSD" : " PCM") << std::endl;
+    }
 
-        if (sameFormat) {
-            std::cout << "[DirettaSync] Same format - quick resume (no setSink)" << std::endl;
-
-            // Send silence before transition to flush Diretta pipeline
-            if (m_isDsdMode.load(std::memory_order_acquire)) {
-                requestShutdownSilence(30);
-                auto start = std::chrono::steady_clock::now();
-                while (m_silenceBuffersRemaining.load(std::memory_order_acquire) > 0) {
-                    if (std::chrono::steady_clock::now() - start > std::chrono::milliseconds(100)) break;
-                    std::this_thread::yield();
-                }
+    // Fast path: Already open with same format - just reset buffer and resume
+    // This avoids the expensive setSink/connect sequence for same-format track transitions
+    if (plan.kind == TransitionKind::Quick) {
+        std::cout << "[DirettaSync] Same format - quick resume (no setSink)" << std::endl;
+
+        // Send silence before transition to flush Diretta pipeline
+        if (m_isDsdMode.load(std::memory_order_acquire)) {
+            requestShutdownSilence(30);
+            auto start = std::chrono::steady_clock::now();
+            while (m_silenceBuffersRemaining.load(std::memory_order_acquire) > 0) {
+                if (std::chrono::steady_clock::now() - start > std::chrono::milliseconds(100)) break;
+                std::this_thread::yield();
             }
+        }
 
-            // Clear buffer and reset flags
-            // NOTE: Do NOT reset m_postOnlineDelayDone for quick resume!
-            // The DAC is already stable from the previous track - no need
-            // to send additional silence after prefill completes.
+        // Clear buffer and reset flags
+        // NOTE: Do NOT reset m_postOnlineDelayDone for quick resume!
+        // The DAC is already stable from the previous track - no need
+        // to send additional silence after prefill completes.
+        {
+            // The worker is still running: it emits silence meanwhile
+            ReconfigureGuard guard(*this);
             m_ringBuffer.clear();
             m_prefillComplete = false;
-            // m_postOnlineDelayDone stays true - DAC already stable
-            m_stabilizationCount = 0;
-            m_stopRequested = false;
-            m_draining = false;
-            m_silenceBuffersRemaining = 0;
-            play();
-            m_playing = true;
-            m_paused = false;
-
-            // Log MS mode on quick resume — supportMSmode is populated after first session
-            if (g_logLevel >= LogLevel::DEBUG) {
-                const auto& info = getSinkInfo();
-                uint16_t msmode = info.supportMSmode;
-                if (msmode != 0) {
-                    const char* activeMode = "NONE";
-                    if (msmode & 0x04) activeMode = "MS3";
-                    else if (msmode & 0x01) activeMode = "MS1";
-                    DIRETTA_LOG("MS mode negotiated: " << activeMode);
-                }
-            }
-
-            std::cout << "[DirettaSync] ========== OPEN COMPLETE (quick) ==========" << std::endl;
-            return true;
-        } else {
-            // Format change detected
-            bool wasDSD = m_previousFormat.isDSD;
-            bool nowDSD = format.isDSD;
-            bool nowPCM = !format.isDSD;
-
-            // Detect rate changes (DSD or PCM)
-            // DSD512×44.1 (22,579,200 Hz) ↔ DSD512×48 (24,576,000 Hz) requires clock domain change
-            bool isDsdRateChange = wasDSD && nowDSD &&
-                                   (m_previousFormat.sampleRate != format.sampleRate);
-            bool isPcmRateChange = !wasDSD && nowPCM &&
-                                   (m_previousFormat.sampleRate != format.sampleRate);
-
-            if (wasDSD && (nowPCM || isDsdRateChange)) {
-                // DSD→PCM or any DSD rate change: Full close/reopen for clean transition
-                // I2S targets are timing-sensitive and need a clean break
-                // Rate changes cause noise if target's internal buffers aren't fully flushed
-                // Clock domain changes (44.1kHz ↔ 48kHz family) also require full reset
-                // Note: We can't send silence here because playback is already stopped
-                // (auto-stop happens before URI change), so getNewStream() isn't being called
-                if (nowPCM) {
-                    std::cout << "[DirettaSync] DSD->PCM transition - full close/reopen" << std::endl;
-                } else {
-                    int prevMultiplier = m_previousFormat.sampleRate / 2822400;
-                    int newMultiplier = format.sampleRate / 2822400;
-                    std::cout << "[DirettaSync] DSD" << (prevMultiplier * 64) << "->DSD"
-                              << (newMultiplier * 64) << " rate change - full close/reopen" << std::endl;
-                }
-
-                int dsdMultiplier = m_previousFormat.sampleRate / 2822400;  // DSD64=1, DSD512=8
-                std::cout << "[DirettaSync] Previous format was DSD" << (dsdMultiplier * 64) << std::endl;
-
-                // Clear any pending silence requests (playback is stopped, can't send anyway)
-                m_silenceBuffersRemaining = 0;
+        }
+        m_tailDraining.store(false, std::memory_order_release);
+        // m_postOnlineDelayDone stays true - DAC already stable
+        m_stabilizationCount = 0;
+        m_stopRequested = false;
+        m_draining = false;
+        m_silenceBuffersRemaining = 0;
+        play();
+        m_playing = true;
+        m_paused = false;
 
-                // Stop playback and disconnect
-                stop();
-                disconnect(true);
+        // Log MS mode on quick resume — supportMSmode is populated after first session
+        if (g_logLevel >= LogLevel::DEBUG) {
+            const auto& info = getSinkInfo();
+            uint16_t msmode = info.supportMSmode;
+            if (msmode != 0) {
+                const char* activeMode = "NONE";
+                if (msmode & 0x04) activeMode = "MS3";
+                else if (msmode & 0x01) activeMode = "MS1";
+                DIRETTA_LOG("MS mode negotiated: " << activeMode);
+            }
+        }
 
-                // CRITICAL: Stop worker thread BEFORE closing SDK to prevent use-after-free
-                m_running = false;
-                {
-                    std::lock_guard<std::mutex> lock(m_workerMutex);
-                    if (m_workerThread.joinable()) {
-                        m_workerThread.join();
-                    }
-                }
+        std::cout << "[DirettaSync] ========== OPEN COMPLETE (quick) ==========" << std::endl;
+        return true;
+    }
 
-                // Now safe to close SDK - worker thread is stopped
-                DIRETTA::Sync::close();
-
-                m_open = false;
-                m_playing = false;
-                m_paused = false;
-
-                // Extended delay for target to fully reset
-                // DSD→PCM needs delay for clock domain switch
-                // DSD rate downgrade needs time to flush internal buffers
-                // G4: Scale delay with DSD rate - higher rates have deeper pipelines
-                // Also scale for high target PCM rates which need extra PLL settling time
-                // G1: Use interruptible wait for responsive shutdown
-                int baseDelay = 200 * std::max(1, dsdMultiplier);  // 200ms (DSD64) to 1600ms (DSD512)
-                int pcmBonus = 0;
-                if (nowPCM && format.sampleRate >= 176400) {
-                    // Only apply PCM bonus when transitioning TO PCM (not DSD→DSD rate change)
-                    int pcmMultiplier = format.sampleRate / 44100;  // 1 for 44100, 8 for 352800
-                    pcmBonus = 100 * pcmMultiplier;  // Extra for high-rate PCM
-                }
-                int resetDelayMs = baseDelay + pcmBonus;
-                std::cout << "[DirettaSync] Waiting " << resetDelayMs
-                          << "ms for target to reset..." << std::endl;
-                interruptibleWait(m_transitionMutex, m_transitionCv, m_transitionWakeup, resetDelayMs);
-
-                // Mark SDK as closed — will be freshly reopened via openSyncConnection()
-                m_sdkOpen = false;
-
-                // Fall through to full open path (needFullConnect is already true)
-            } else if (isPcmRateChange) {
-                // PCM rate change: Full close/reopen for clean transition
-                // Same issue as DSD - stale samples at old rate cause transition noise
-                std::cout << "[DirettaSync] PCM " << m_previousFormat.sampleRate << "Hz->"
-                          << format.sampleRate << "Hz rate change - full close/reopen" << std::endl;
-
-                // Clear any pending silence requests
-                m_silenceBuffersRemaining = 0;
-
-                // Stop playback and disconnect
-                stop();
-                disconnect(true);
-
-                // CRITICAL: Stop worker thread BEFORE closing SDK to prevent use-after-free
-                m_running = false;
-                {
-                    std::lock_guard<std::mutex> lock(m_workerMutex);
-                    if (m_workerThread.joinable()) {
-                        m_workerThread.join();
-                    }
-                }
+    if (plan.kind == TransitionKind::Reopen) {
+        // Format change: full close/reopen. Playback of the previous track
+        // has ended (drainForTransition() played out its tail), so there is
+        // nothing left to send silence with.
+        std::cout << "[DirettaSync] " << plan.reason << std::endl;
+        teardownForTransition();
+        m_tailDraining.store(false, std::memory_order_release);
 
-                // Now safe to close SDK - worker thread is stopped
-                DIRETTA::Sync::close();
-
-                m_open = false;
-                m_playing = false;
-                m_paused = false;
-
-                // Shorter delay for PCM rate change (TEST: reduced from 200 to 100)
-                // G1: Use interruptible wait for responsive shutdown
-                int resetDelayMs = 100;
-                std::cout << "[DirettaSync] Waiting " << resetDelayMs
-                          << "ms for target to reset..." << std::endl;
-                interruptibleWait(m_transitionMutex, m_transitionCv, m_transitionWakeup, resetDelayMs);
-
-                // Mark SDK as closed — will be freshly reopened via openSyncConnection()
-                m_sdkOpen = false;
-
-                // Fall through to full open path
-            } else {
-                // PCM→DSD (or bit depth change)
-                // Detect same-family high-rate transitions that need full reset
-                // The target's PLL gets stuck when transitioning within same clock family
-                // at high rates (e.g., PCM 352.8kHz → DSD512×44.1)
-
-                // Helper lambda to determine clock family (441 = 44.1kHz, 480 = 48kHz)
-                auto getClockFamily = [](uint32_t sampleRate) -> int {
-                    if (sampleRate % 44100 == 0) return 441;
-                    if (sampleRate % 48000 == 0) return 480;
-                    return 0;
-                };
-
-                int oldFamily = getClockFamily(m_previousFormat.sampleRate);
-                int newFamily = getClockFamily(format.sampleRate);
-                bool sameFamily = (oldFamily != 0 && oldFamily == newFamily);
-
-                // High-rate: PCM 176.4kHz+ (4fs) or DSD256+ (which corresponds to 4fs base)
-                bool oldIsHighRate = m_previousFormat.sampleRate >= 176400;  // Previous was high-rate PCM
-                bool newIsHighRate = format.sampleRate >= 11289600;  // DSD256×44.1 = 11,289,600
-
-                bool needsFullReset = sameFamily && (oldIsHighRate || newIsHighRate);
-
-                if (needsFullReset) {
-                    // Same clock family high-rate PCM→DSD transition
-                    // Full close/reopen required to reset target's PLL
-                    int dsdMultiplier = format.sampleRate / 2822400;  // Target DSD rate
-                    std::cout << "[DirettaSync] High-rate PCM->DSD" << (dsdMultiplier * 64)
-                              << " (same " << oldFamily << "Hz family) - full close/reopen" << std::endl;
-
-                    // Clear any pending silence requests
-                    m_silenceBuffersRemaining = 0;
-
-                    // Stop playback and disconnect
-                    stop();
-                    disconnect(true);
-
-                    // CRITICAL: Stop worker thread BEFORE closing SDK to prevent use-after-free
-                    m_running = false;
-                    {
-                        std::lock_guard<std::mutex> lock(m_workerMutex);
-                        if (m_workerThread.joinable()) {
-                            m_workerThread.join();
-                        }
-                    }
-
-                    // Now safe to close SDK - worker thread is stopped
-                    DIRETTA::Sync::close();
-
-                    m_open = false;
-                    m_playing = false;
-                    m_paused = false;
-
-                    // Delay for target to reset - scale with target DSD rate
-                    int resetDelayMs = 200 * std::max(1, dsdMultiplier);  // 200ms (DSD64) to 1600ms (DSD512)
-                    std::cout << "[DirettaSync] Waiting " << resetDelayMs
-                              << "ms for target to reset..." << std::endl;
-                    interruptibleWait(m_transitionMutex, m_transitionCv, m_transitionWakeup, resetDelayMs);
-
-                    // Mark SDK as closed — will be freshly reopened via openSyncConnection()
-                    m_sdkOpen = false;
-
-                    // Fall through to full open path
-                } else {
-                    // Different clock family or low-rate: full teardown + fresh reopen
-                    std::cout << "[DirettaSync] Format change - full teardown" << std::endl;
-
-                    // Clear any pending silence requests
-                    m_silenceBuffersRemaining = 0;
-
-                    // Stop playback and disconnect
-                    stop();
-                    disconnect(true);
-
-                    // CRITICAL: Stop worker thread BEFORE closing SDK to prevent use-after-free
-                    m_running = false;
-                    {
-                        std::lock_guard<std::mutex> lock(m_workerMutex);
-                        if (m_workerThread.joinable()) {
-                            m_workerThread.join();
-                        }
-                    }
-
-                    // Now safe to close SDK - worker thread is stopped
-                    DIRETTA::Sync::close();
-
-                    m_open = false;
-                    m_playing = false;
-                    m_paused = false;
-
-                    // Mark SDK as closed — will be freshly reopened via openSyncConnection()
-                    m_sdkOpen = false;
-
-                    // Wait for target to process the format change
-                    int resetDelayMs = 200;
-                    std::cout << "[DirettaSync] Waiting " << resetDelayMs
-                              << "ms for target to reset..." << std::endl;
-                    interruptibleWait(m_transitionMutex, m_transitionCv, m_transitionWakeup, resetDelayMs);
-                }
-            }
-            needFullConnect = true;
-        }
+        // G1: Use interruptible wait for responsive shutdown
+        std::cout << "[DirettaSync] Waiting " << plan.resetDelayMs
+                  << "ms for target to reset..." << std::endl;
+        interruptibleWait(m_transitionMutex, m_transitionCv, m_transitionWakeup, plan.resetDelayMs);
+        needFullConnect = true;
     }
 
+    // Background discovery found a different target/MTU than the cache
+    adoptRevalidatedTarget();
+
     // Reopen SDK if it was closed during format transition
     // Using openSyncConnection() ensures a completely fresh SDK state,
     // preventing state accumulation across multiple format changes.
@@ -737,29 +775,47 @@ bool DirettaSync::open(const AudioFormat& format) {
         bitsPerSample = acceptedBits;
 
         int direttaBps = (acceptedBits == 32) ? 4 : (acceptedBits == 24) ? 3 : 2;
-        int inputBps = (format.bitDepth == 32 || format.bitDepth == 24) ? 4 : 2;
+        // Source width as sent: S32, packed S24 or S16
+        int inputBps = (format.bitDepth == 32) ? 4 : (format.bitDepth == 24) ? 3 : 2;
 
-        configureRingPCM(format.sampleRate, format.channels, direttaBps, inputBps, format.isCompressed);
+        if (!configureRingPCM(format.sampleRate, format.channels, direttaBps, inputBps, format.isCompressed)) {
+            return false;
+        }
     }
 
     unsigned int cycleTimeUs = calculateCycleTime(effectiveSampleRate, effectiveChannels, bitsPerSample);
     ACQUA::Clock cycleTime = ACQUA::Clock::MicroSeconds(cycleTimeUs);
+    m_cycleTimeNs.store(static_cast<uint64_t>(cycleTimeUs) * 1000, std::memory_order_relaxed);
 
     // Initial delay - Target needs time to prepare for new format
     // Longer delay for first open/reconnect, shorter for reconfigure
-    int initialDelayMs = needFullConnect ? 500 : 200;
-    std::this_thread::sleep_for(std::chrono::milliseconds(initialDelayMs));
+    // T1: After a teardown the target has been resetting since disconnect,
+    // so only the remainder is waited here
+    int initialDelayMs = needFullConnect ? DirettaRetry::PREPARE_DELAY_FULL_MS
+                                         : DirettaRetry::PREPARE_DELAY_QUICK_MS;
+    if (plan.kind == TransitionKind::Reopen) {
+        auto sinceTeardown = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - m_teardownTime).count();
+        initialDelayMs = std::max(0, initialDelayMs - static_cast<int>(sinceTeardown));
+    }
+    if (initialDelayMs > 0) {
+        interruptibleWait(m_transitionMutex, m_transitionCv, m_transitionWakeup, initialDelayMs);
+    }
 
     // setSink reconfiguration
-    bool sinkSet = false;
     int maxAttempts = needFullConnect ? DirettaRetry::SETSINK_RETRIES_FULL : DirettaRetry::SETSINK_RETRIES_QUICK;
     int retryDelayMs = needFullConnect ? DirettaRetry::SETSINK_DELAY_FULL_MS : DirettaRetry::SETSINK_DELAY_QUICK_MS;
-    for (int attempt = 0; attempt < maxAttempts && !sinkSet; attempt++) {
-        if (attempt > 0) {
-            DIRETTA_LOG("setSink retry #" << attempt);
-            std::this_thread::sleep_for(std::chrono::milliseconds(retryDelayMs));
-        }
-        sinkSet = setSink(m_targetAddress, cycleTime, false, m_effectiveMTU);
+    if (m_targetUnconfirmed) {
+        maxAttempts = std::min(maxAttempts, DirettaRetry::SETSINK_RETRIES_CACHED);
+    }
+    bool sinkSet = retryWithBackoff("setSink", maxAttempts, retryDelayMs, [&] {
+        return setSink(m_targetAddress, cycleTime, false, m_effectiveMTU);
+    });
+
+    // Cached address went stale (DHCP, target moved): discover, then start
+    // over so the sink formats are negotiated with the target that answers
+    if (!sinkSet && m_targetUnconfirmed && rediscoverTarget()) {
+        return open(format);
     }
 
     if (!sinkSet) {
@@ -782,14 +838,8 @@ bool DirettaSync::open(const AudioFormat& format) {
             return false;
         }
 
-        bool connected = false;
-        for (int attempt = 0; attempt < DirettaRetry::CONNECT_RETRIES && !connected; attempt++) {
-            if (attempt > 0) {
-                DIRETTA_LOG("connect retry #" << attempt);
-                std::this_thread::sleep_for(std::chrono::milliseconds(DirettaRetry::CONNECT_DELAY_MS));
-            }
-            connected = connect(0);
-        }
+        bool connected = retryWithBackoff("connect", DirettaRetry::CONNECT_RETRIES,
+                                          DirettaRetry::CONNECT_DELAY_MS, [&] { return connect(0); });
 
         if (!connected) {
             std::cerr << "[DirettaSync] connect failed" << std::endl;
@@ -806,8 +856,11 @@ bool DirettaSync::open(const AudioFormat& format) {
     }
 
     // Clear buffer and start playback
-    m_ringBuffer.clear();
-    m_prefillComplete = false;
+    {
+        ReconfigureGuard guard(*this);
+        m_ringBuffer.clear();
+        m_prefillComplete = false;
+    }
     m_postOnlineDelayDone = false;
 
     play();
@@ -823,11 +876,14 @@ bool DirettaSync::open(const AudioFormat& format) {
     m_previousFormat = format;
     m_hasPreviousFormat = true;
     m_currentFormat = format;
+    m_statsSampleRate.store(format.sampleRate, std::memory_order_relaxed);
+    m_statsDsd.store(format.isDSD, std::memory_order_relaxed);
 
     m_open = true;
     m_playing = true;
     m_paused = false;
 
+    m_targetUnconfirmed = false;
     std::cout << "[DirettaSync] ========== OPEN COMPLETE ==========" << std::endl;
     return true;
 }
@@ -840,6 +896,8 @@ void DirettaSync::close() {
         return;
     }
 
+    m_tailDraining.store(false, std::memory_order_release);
+
     // Request shutdown silence
     requestShutdownSilence(m_isDsdMode.load(std::memory_order_acquire) ? 50 : 20);
 
@@ -866,6 +924,7 @@ void DirettaSync::close() {
     m_open = false;
     m_playing = false;
     m_paused = false;
+    wakeFlowWaiter();
 
     DIRETTA_LOG("Close() done");
 }
@@ -882,14 +941,8 @@ void DirettaSync::release() {
     if (m_sdkOpen) {
         DIRETTA_LOG("Closing SDK connection...");
 
-        // Shutdown worker thread
-        m_running = false;
-        {
-            std::lock_guard<std::mutex> lock(m_workerMutex);
-            if (m_workerThread.joinable()) {
-                m_workerThread.join();
-            }
-        }
+        // W1: Park the worker (it stays alive for the next open)
+        parkWorker();
 
         // Close SDK-level connection
         DIRETTA::Sync::close();
@@ -911,17 +964,11 @@ bool DirettaSync::reopenForFormatChange() {
     stop();
     disconnect(true);
 
-    // CRITICAL: Stop worker thread BEFORE closing SDK to prevent use-after-free
+    // CRITICAL: Park worker thread BEFORE closing SDK to prevent use-after-free
     // The worker thread calls getNewStream() which accesses SDK structures
-    m_running = false;
-    {
-        std::lock_guard<std::mutex> lock(m_workerMutex);
-        if (m_workerThread.joinable()) {
-            m_workerThread.join();
-        }
-    }
+    parkWorker();
 
-    // Now safe to close SDK - worker thread is stopped
+    // Now safe to close SDK - worker thread is parked
     DIRETTA::Sync::close();
 
     // Reset state flags so subsequent open path starts fresh.
@@ -954,6 +1001,195 @@ bool DirettaSync::reopenForFormatChange() {
     return true;
 }
 
+DirettaSync::TransitionPlan DirettaSync::planTransition(const AudioFormat& format) const {
+    TransitionPlan plan;
+    if (!m_open || !m_hasPreviousFormat) {
+        return plan;
+    }
+
+    const AudioFormat& prev = m_previousFormat;
+    if (prev == format) {
+        plan.kind = TransitionKind::Quick;
+        return plan;
+    }
+
+    plan.kind = TransitionKind::Reopen;
+    bool wasDSD = prev.isDSD;
+    bool nowDSD = format.isDSD;
+    bool nowPCM = !format.isDSD;
+
+    // Detect rate changes (DSD or PCM)
+    // DSD512×44.1 (22,579,200 Hz) ↔ DSD512×48 (24,576,000 Hz) requires clock domain change
+    bool isDsdRateChange = wasDSD && nowDSD && (prev.sampleRate != format.sampleRate);
+    bool isPcmRateChange = !wasDSD && nowPCM && (prev.sampleRate != format.sampleRate);
+
+    std::ostringstream reason;
+    if (wasDSD && (nowPCM || isDsdRateChange)) {
+        // DSD→PCM or any DSD rate change: Full close/reopen for clean transition
+        // I2S targets are timing-sensitive and need a clean break
+        // Rate changes cause noise if target's internal buffers aren't fully flushed
+        // Clock domain changes (44.1kHz ↔ 48kHz family) also require full reset
+        int dsdMultiplier = prev.sampleRate / 2822400;  // DSD64=1, DSD512=8
+        if (nowPCM) {
+            reason << "DSD->PCM transition - full close/reopen";
+        } else {
+            int newMultiplier = format.sampleRate / 2822400;
+            reason << "DSD" << (dsdMultiplier * 64) << "->DSD" << (newMultiplier * 64)
+                   << " rate change - full close/reopen";
+        }
+        reason << " (previous format was DSD" << (dsdMultiplier * 64) << ")";
+
+        // Extended delay for target to fully reset
+        // DSD→PCM needs delay for clock domain switch
+        // DSD rate downgrade needs time to flush internal buffers
+        // G4: Scale delay with DSD rate - higher rates have deeper pipelines
+        // Also scale for high target PCM rates which need extra PLL settling time
+        int baseDelay = 200 * std::max(1, dsdMultiplier);  // 200ms (DSD64) to 1600ms (DSD512)
+        int pcmBonus = 0;
+        if (nowPCM && format.sampleRate >= 176400) {
+            // Only apply PCM bonus when transitioning TO PCM (not DSD→DSD rate change)
+            int pcmMultiplier = format.sampleRate / 44100;  // 1 for 44100, 8 for 352800
+            pcmBonus = 100 * pcmMultiplier;  // Extra for high-rate PCM
+        }
+        plan.resetDelayMs = baseDelay + pcmBonus;
+    } else if (isPcmRateChange) {
+        // PCM rate change: Full close/reopen for clean transition
+        // Same issue as DSD - stale samples at old rate cause transition noise
+        reason << "PCM " << prev.sampleRate << "Hz->" << format.sampleRate
+               << "Hz rate change - full close/reopen";
+        plan.resetDelayMs = 100;  // Shorter delay for PCM rate change (TEST: reduced from 200 to 100)
+    } else {
+        // PCM→DSD (or bit depth change)
+        // Detect same-family high-rate transitions that need full reset
+        // The target's PLL gets stuck when transitioning within same clock family
+        // at high rates (e.g., PCM 352.8kHz → DSD512×44.1)
+        auto getClockFamily = [](uint32_t sampleRate) -> int {
+            if (sampleRate % 44100 == 0) return 441;
+            if (sampleRate % 48000 == 0) return 480;
+            return 0;
+        };
+
+        int oldFamily = getClockFamily(prev.sampleRate);
+        int newFamily = getClockFamily(format.sampleRate);
+        bool sameFamily = (oldFamily != 0 && oldFamily == newFamily);
+
+        // High-rate: PCM 176.4kHz+ (4fs) or DSD256+ (which corresponds to 4fs base)
+        bool oldIsHighRate = prev.sampleRate >= 176400;      // Previous was high-rate PCM
+        bool newIsHighRate = format.sampleRate >= 11289600;  // DSD256×44.1 = 11,289,600
+
+        if (sameFamily && (oldIsHighRate || newIsHighRate)) {
+            // Full close/reopen required to reset target's PLL
+            int dsdMultiplier = format.sampleRate / 2822400;  // Target DSD rate
+            reason << "High-rate PCM->DSD" << (dsdMultiplier * 64)
+                   << " (same " << oldFamily << "Hz family) - full close/reopen";
+            plan.resetDelayMs = 200 * std::max(1, dsdMultiplier);  // 200ms (DSD64) to 1600ms (DSD512)
+        } else {
+            // Different clock family or low-rate: full teardown + fresh reopen
+            reason << "Format change - full teardown";
+            plan.resetDelayMs = 200;
+        }
+    }
+    plan.reason = reason.str();
+    return plan;
+}
+
+void DirettaSync::teardownForTransition() {
+    // Clear any pending silence requests (playback is stopped, can't send anyway)
+    m_silenceBuffersRemaining = 0;
+
+    // Stop playback and disconnect
+    stop();
+    disconnect(true);
+    m_teardownTime = std::chrono::steady_clock::now();
+
+    // CRITICAL: Park worker thread BEFORE closing SDK to prevent use-after-free
+    parkWorker();
+
+    // Now safe to close SDK - worker thread is parked
+    DIRETTA::Sync::close();
+
+    m_open = false;
+    m_playing = false;
+    m_paused = false;
+
+    // Mark SDK as closed — will be freshly reopened via openSyncConnection()
+    m_sdkOpen = false;
+}
+
+// T1: Retry fn, backing off from BACKOFF_START_MS to maxDelayMs, for as long
+// as the fixed schedule (attempts tries, maxDelayMs apart) would have waited
+bool DirettaSync::retryWithBackoff(const char* what, int attempts, int maxDelayMs,
+                                   const std::function<bool()>& fn) {
+    const int budgetMs = std::max(0, attempts - 1) * maxDelayMs;
+    int waitedMs = 0;
+    for (int attempt = 0; ; attempt++) {
+        if (attempt > 0) {
+            int delayMs = std::min(maxDelayMs, DirettaRetry::BACKOFF_START_MS << std::min(attempt - 1, 8));
+            delayMs = std::min(delayMs, budgetMs - waitedMs);
+            DIRETTA_LOG(what << " retry #" << attempt << " after " << delayMs << "ms");
+            if (!interruptibleWait(m_transitionMutex, m_transitionCv, m_transitionWakeup, delayMs)) {
+                return false;  // Shutdown
+            }
+            waitedMs += delayMs;
+        }
+        if (fn()) return true;
+        if (waitedMs >= budgetMs) return false;
+    }
+}
+
+bool DirettaSync::drainForTransition(const AudioFormat& next) {
+    // T1: Decide the transition while the tail is still playing
+    m_pendingPlan = planTransition(next);
+    m_pendingPlanFormat = next;
+    m_hasPendingPlan = true;
+
+    size_t bytesPerBuffer = static_cast<size_t>(m_bytesPerBuffer.load(std::memory_order_acquire));
+    if (!m_open || !m_playing || m_paused || bytesPerBuffer == 0) {
+        return true;
+    }
+
+    // A track shorter than the prefill never started playing: play it now
+    m_prefillComplete = true;
+    m_tailDrained.store(false, std::memory_order_relaxed);
+    m_tailDraining.store(true, std::memory_order_release);
+
+    // One buffer is 1 ms of audio
+    size_t tailMs = m_ringBuffer.getAvailable() / bytesPerBuffer;
+    auto deadline = std::chrono::steady_clock::now() +
+                    std::chrono::milliseconds(tailMs + DirettaRetry::DRAIN_SLACK_MS);
+    DIRETTA_LOG("Draining " << tailMs << "ms before transition"
+                << (m_pendingPlan.kind == TransitionKind::Reopen ? " (full reopen next)" : ""));
+
+    bool drained = false;
+    while (m_open && !m_stopRequested.load(std::memory_order_acquire)) {
+        // Announce the wait before re-checking, as in waitForLowWater()
+        m_drainWaiting.store(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (m_tailDrained.load(std::memory_order_relaxed) ||
+            m_ringBuffer.getAvailable() < bytesPerBuffer) {
+            drained = true;
+            break;
+        }
+
+        auto left = std::chrono::duration_cast<std::chrono::milliseconds>(
+            deadline - std::chrono::steady_clock::now()).count();
+        if (left <= 0) break;
+
+        struct pollfd pfd = { m_flowEventFd, POLLIN, 0 };
+        if (::poll(&pfd, 1, static_cast<int>(std::min<long long>(left, 100))) > 0) {
+            uint64_t count;
+            ssize_t rc = ::read(m_flowEventFd, &count, sizeof(count));
+            (void)rc;
+        }
+    }
+    m_drainWaiting.store(0, std::memory_order_relaxed);
+
+    if (!drained) {
+        DIRETTA_LOG("Drain timeout with " << m_ringBuffer.getAvailable() << " bytes left");
+    }
+    return drained;
+}
+
 void DirettaSync::fullReset() {
     DIRETTA_LOG("fullReset()");
 
@@ -997,39 +1233,62 @@ void DirettaSync::fullReset() {
 // Sink Configuration
 //=============================================================================
 
-void DirettaSync::configureSinkPCM(int rate, int channels, int inputBits, int& acceptedBits) {
-    (void)inputBits;
-    std::lock_guard<std::mutex> lock(m_configMutex);
-
-    DIRETTA::FormatConfigure fmt;
+// First of PCM_SINK_BITS the target accepts, leaving fmt set to it.
+// Known target: the width it accepted last time, no probing.
+// Caller holds m_configMutex. Returns 0 if no width is accepted.
+int DirettaSync::lookupPcmBits(DIRETTA::FormatConfigure& fmt, int rate, int channels) {
     fmt.setSpeed(rate);
     fmt.setChannel(channels);
 
-    fmt.setFormat(DIRETTA::FormatID::FMT_PCM_SIGNED_32);
-    if (checkSinkSupport(fmt)) {
-        setSinkConfigure(fmt);
-        acceptedBits = 32;
-        DIRETTA_LOG("Sink PCM: " << rate << "Hz " << channels << "ch 32-bit");
-        return;
+    const std::string formatKey = sinkFormatKey("pcm", rate, channels);
+    int cached;
+    if (m_targetCache.lookup(m_targetKey, formatKey, cached)) {
+        setPcmSinkFormat(fmt, cached);
+        DIRETTA_LOG("Sink PCM: " << rate << "Hz " << channels << "ch " << cached << "-bit (cached)");
+        return cached;
     }
 
-    fmt.setFormat(DIRETTA::FormatID::FMT_PCM_SIGNED_24);
-    if (checkSinkSupport(fmt)) {
-        setSinkConfigure(fmt);
-        acceptedBits = 24;
-        DIRETTA_LOG("Sink PCM: " << rate << "Hz " << channels << "ch 24-bit");
-        return;
+    for (int bits : PCM_SINK_BITS) {
+        setPcmSinkFormat(fmt, bits);
+        if (checkSinkSupport(fmt)) {
+            DIRETTA_LOG("Sink PCM: " << rate << "Hz " << channels << "ch " << bits << "-bit");
+            if (!m_targetCache.store(m_targetKey, formatKey, bits)) {
+                LOG_WARN("[DirettaSync] Could not write sink format cache " << m_config.sinkCachePath);
+            }
+            return bits;
+        }
     }
+    return 0;
+}
 
-    fmt.setFormat(DIRETTA::FormatID::FMT_PCM_SIGNED_16);
-    if (checkSinkSupport(fmt)) {
-        setSinkConfigure(fmt);
-        acceptedBits = 16;
-        DIRETTA_LOG("Sink PCM: " << rate << "Hz " << channels << "ch 16-bit");
-        return;
-    }
+int DirettaSync::preferredPcmBits(int rate, int channels) {
+    if (!m_enabled) return 0;
+    std::lock_guard<std::mutex> lock(m_configMutex);
+    DIRETTA::FormatConfigure fmt;
+    return lookupPcmBits(fmt, rate, channels);
+}
+
+void DirettaSync::configureSinkPCM(int rate, int channels, int inputBits, int& acceptedBits) {
+    std::lock_guard<std::mutex> lock(m_configMutex);
 
-    throw std::runtime_error("No supported PCM format found");
+    DIRETTA::FormatConfigure fmt;
+    acceptedBits = lookupPcmBits(fmt, rate, channels);
+    if (acceptedBits == 0) {
+        throw std::runtime_error("No supported PCM format found");
+    }
+
+    // The source was asked for a narrower width (preferredPcmBits() at
+    // another rate): keep it if the sink takes it here, rather than widen
+    if (inputBits < acceptedBits && (inputBits == 24 || inputBits == 16)) {
+        setPcmSinkFormat(fmt, inputBits);
+        if (checkSinkSupport(fmt)) {
+            acceptedBits = inputBits;
+            DIRETTA_LOG("Sink PCM: " << inputBits << "-bit to match the source");
+        } else {
+            setPcmSinkFormat(fmt, acceptedBits);
+        }
+    }
+    setSinkConfigure(fmt);
 }
 
 void DirettaSync::configureSinkDSD(uint32_t dsdBitRate, int channels, const AudioFormat& format) {
@@ -1050,108 +1309,57 @@ void DirettaSync::configureSinkDSD(uint32_t dsdBitRate, int channels, const Audi
     fmt.setSpeed(dsdBitRate);
     fmt.setChannel(channels);
 
-    // Try LSB | BIG first (most common for DSF files)
-    fmt.setFormat(DIRETTA::FormatID::FMT_DSD1 |
-                  DIRETTA::FormatID::FMT_DSD_SIZ_32 |
-                  DIRETTA::FormatID::FMT_DSD_LSB |
-                  DIRETTA::FormatID::FMT_DSD_BIG);
-    if (checkSinkSupport(fmt)) {
-        setSinkConfigure(fmt);
-        m_needDsdBitReversal.store(!sourceIsLSB, std::memory_order_release);  // Reverse if source is MSB (DFF)
-        m_needDsdByteSwap.store(false, std::memory_order_release);  // BIG endian = no swap
-        // Set cached conversion mode: no swap, maybe bit reverse
-        m_dsdConversionMode.store(m_needDsdBitReversal.load(std::memory_order_acquire)
-            ? DirettaRingBuffer::DSDConversionMode::BitReverseOnly
-            : DirettaRingBuffer::DSDConversionMode::Passthrough, std::memory_order_release);
-        DIRETTA_LOG("Sink DSD: LSB | BIG"
-                    << (m_needDsdBitReversal.load(std::memory_order_acquire) ? " (bit reversal)" : "")
-                    << " mode=" << static_cast<int>(m_dsdConversionMode.load(std::memory_order_relaxed)));
-        return;
-    }
-
-    // Try MSB | BIG
-    fmt.setFormat(DIRETTA::FormatID::FMT_DSD1 |
-                  DIRETTA::FormatID::FMT_DSD_SIZ_32 |
-                  DIRETTA::FormatID::FMT_DSD_MSB |
-                  DIRETTA::FormatID::FMT_DSD_BIG);
-    if (checkSinkSupport(fmt)) {
-        setSinkConfigure(fmt);
-        m_needDsdBitReversal.store(sourceIsLSB, std::memory_order_release);  // Reverse if source is LSB (DSF)
-        m_needDsdByteSwap.store(false, std::memory_order_release);  // BIG endian = no swap
-        // Set cached conversion mode: no swap, maybe bit reverse
-        m_dsdConversionMode.store(m_needDsdBitReversal.load(std::memory_order_acquire)
-            ? DirettaRingBuffer::DSDConversionMode::BitReverseOnly
-            : DirettaRingBuffer::DSDConversionMode::Passthrough, std::memory_order_release);
-        DIRETTA_LOG("Sink DSD: MSB | BIG"
-                    << (m_needDsdBitReversal.load(std::memory_order_acquire) ? " (bit reversal)" : "")
-                    << " mode=" << static_cast<int>(m_dsdConversionMode.load(std::memory_order_relaxed)));
-        return;
+    constexpr size_t numVariants = sizeof(DSD_SINK_VARIANTS) / sizeof(DSD_SINK_VARIANTS[0]);
+    const std::string formatKey = sinkFormatKey("dsd", dsdBitRate, channels);
+    size_t variant = numVariants;
+    bool fromCache = false;
+
+    int cached;
+    if (m_targetCache.lookup(m_targetKey, formatKey, cached) &&
+        cached >= 0 && static_cast<size_t>(cached) < numVariants) {
+        variant = static_cast<size_t>(cached);
+        setDsdSinkFormat(fmt, variant);
+        fromCache = true;
+    } else {
+        for (size_t i = 0; i < numVariants; i++) {
+            setDsdSinkFormat(fmt, i);
+            if (checkSinkSupport(fmt)) {
+                variant = i;
+                break;
+            }
+        }
     }
 
-    // Try LSB | LITTLE
-    fmt.setFormat(DIRETTA::FormatID::FMT_DSD1 |
-                  DIRETTA::FormatID::FMT_DSD_SIZ_32 |
-                  DIRETTA::FormatID::FMT_DSD_LSB |
-                  DIRETTA::FormatID::FMT_DSD_LITTLE);
-    if (checkSinkSupport(fmt)) {
-        setSinkConfigure(fmt);
-        m_needDsdBitReversal.store(!sourceIsLSB, std::memory_order_release);
-        m_needDsdByteSwap.store(true, std::memory_order_release);  // LITTLE endian = swap bytes
-        // Set cached conversion mode: always swap, maybe bit reverse
-        m_dsdConversionMode.store(m_needDsdBitReversal.load(std::memory_order_acquire)
-            ? DirettaRingBuffer::DSDConversionMode::BitReverseAndSwap
-            : DirettaRingBuffer::DSDConversionMode::ByteSwapOnly, std::memory_order_release);
-        DIRETTA_LOG("Sink DSD: LSB | LITTLE"
-                    << (m_needDsdBitReversal.load(std::memory_order_acquire) ? " (bit reversal)" : "")
-                    << " (byte swap) mode=" << static_cast<int>(m_dsdConversionMode.load(std::memory_order_relaxed)));
-        return;
+    if (variant == numVariants) {
+        throw std::runtime_error("No supported DSD format found");
     }
 
-    // Try MSB | LITTLE
-    fmt.setFormat(DIRETTA::FormatID::FMT_DSD1 |
-                  DIRETTA::FormatID::FMT_DSD_SIZ_32 |
-                  DIRETTA::FormatID::FMT_DSD_MSB |
-                  DIRETTA::FormatID::FMT_DSD_LITTLE);
-    if (checkSinkSupport(fmt)) {
-        setSinkConfigure(fmt);
-        m_needDsdBitReversal.store(sourceIsLSB, std::memory_order_release);
-        m_needDsdByteSwap.store(true, std::memory_order_release);  // LITTLE endian = swap bytes
-        // Set cached conversion mode: always swap, maybe bit reverse
-        m_dsdConversionMode.store(m_needDsdBitReversal.load(std::memory_order_acquire)
-            ? DirettaRingBuffer::DSDConversionMode::BitReverseAndSwap
-            : DirettaRingBuffer::DSDConversionMode::ByteSwapOnly, std::memory_order_release);
-        DIRETTA_LOG("Sink DSD: MSB | LITTLE"
-                    << (m_needDsdBitReversal.load(std::memory_order_acquire) ? " (bit reversal)" : "")
-                    << " (byte swap) mode=" << static_cast<int>(m_dsdConversionMode.load(std::memory_order_relaxed)));
-        return;
+    setSinkConfigure(fmt);
+    if (!fromCache && !m_targetCache.store(m_targetKey, formatKey, static_cast<int>(variant))) {
+        LOG_WARN("[DirettaSync] Could not write sink format cache " << m_config.sinkCachePath);
     }
 
-    // Last resort - assume LSB | BIG target
-    fmt.setFormat(DIRETTA::FormatID::FMT_DSD1);
-    if (checkSinkSupport(fmt)) {
-        setSinkConfigure(fmt);
-        m_needDsdBitReversal.store(!sourceIsLSB, std::memory_order_release);
-        m_needDsdByteSwap.store(false, std::memory_order_release);
-        DIRETTA_LOG("Sink DSD: FMT_DSD1 only"
-                    << (m_needDsdBitReversal.load(std::memory_order_acquire) ? " (bit reversal)" : ""));
-
-        // Set cached conversion mode for optimized DSD path
-        bool needReverse = m_needDsdBitReversal.load(std::memory_order_acquire);
-        bool needSwap = m_needDsdByteSwap.load(std::memory_order_acquire);
-        if (needReverse && needSwap) {
-            m_dsdConversionMode.store(DirettaRingBuffer::DSDConversionMode::BitReverseAndSwap, std::memory_order_release);
-        } else if (needReverse) {
-            m_dsdConversionMode.store(DirettaRingBuffer::DSDConversionMode::BitReverseOnly, std::memory_order_release);
-        } else if (needSwap) {
-            m_dsdConversionMode.store(DirettaRingBuffer::DSDConversionMode::ByteSwapOnly, std::memory_order_release);
-        } else {
-            m_dsdConversionMode.store(DirettaRingBuffer::DSDConversionMode::Passthrough, std::memory_order_release);
-        }
-        DIRETTA_LOG("DSD conversion mode: " << static_cast<int>(m_dsdConversionMode.load(std::memory_order_relaxed)));
-        return;
+    // Reverse bits when source and sink bit order differ; swap bytes for a
+    // little-endian sink. Cached as the conversion mode for the DSD path.
+    const DsdSinkVariant& v = DSD_SINK_VARIANTS[variant];
+    bool needReverse = v.sinkLSB != sourceIsLSB;
+    bool needSwap = v.littleEndian;
+    m_needDsdBitReversal.store(needReverse, std::memory_order_release);
+    m_needDsdByteSwap.store(needSwap, std::memory_order_release);
+    if (needReverse && needSwap) {
+        m_dsdConversionMode.store(DirettaRingBuffer::DSDConversionMode::BitReverseAndSwap, std::memory_order_release);
+    } else if (needReverse) {
+        m_dsdConversionMode.store(DirettaRingBuffer::DSDConversionMode::BitReverseOnly, std::memory_order_release);
+    } else if (needSwap) {
+        m_dsdConversionMode.store(DirettaRingBuffer::DSDConversionMode::ByteSwapOnly, std::memory_order_release);
+    } else {
+        m_dsdConversionMode.store(DirettaRingBuffer::DSDConversionMode::Passthrough, std::memory_order_release);
     }
-
-    throw std::runtime_error("No supported DSD format found");
+    DIRETTA_LOG("Sink DSD: " << v.name
+                << (needReverse ? " (bit reversal)" : "")
+                << (needSwap ? " (byte swap)" : "")
+                << (fromCache ? " (cached)" : "")
+                << " mode=" << static_cast<int>(m_dsdConversionMode.load(std::memory_order_relaxed)));
 }
 
 //=============================================================================
@@ -1169,6 +1377,7 @@ size_t DirettaSync::calculateAlignedPrefill(size_t bytesPerSecond, size_t bytesP
     } else {
         targetMs = DirettaBuffer::PREFILL_MS_UNCOMPRESSED;
     }
+    targetMs = static_cast<size_t>(targetMs * m_bufferTuner.scale(isDSD));
 
     // Convert to bytes
     size_t targetBytes = (bytesPerSecond * targetMs) / 1000;
@@ -1188,7 +1397,18 @@ size_t DirettaSync::calculateAlignedPrefill(size_t bytesPerSecond, size_t bytesP
     return targetBuffers;
 }
 
-void DirettaSync::configureRingPCM(int rate, int channels, int direttaBps, int inputBps, bool isCompressed) {
+bool DirettaSync::configureRingPCM(int rate, int channels, int direttaBps, int inputBps, bool isCompressed) {
+    // Widths the ring has a push path for (below); anything else would be
+    // copied as sink-width frames and play as noise at the wrong speed
+    bool convertible = inputBps == direttaBps || (direttaBps == 3 && inputBps == 4) ||
+                       (direttaBps == 4 && (inputBps == 2 || inputBps == 3)) ||
+                       (direttaBps == 3 && inputBps == 2) || (direttaBps == 2 && (inputBps == 3 || inputBps == 4));
+    if (!convertible) {
+        std::cerr << "[DirettaSync] No PCM conversion from " << (inputBps * 8) << "-bit to "
+                  << (direttaBps * 8) << "-bit" << std::endl;
+        return false;
+    }
+
     std::lock_guard<std::mutex> lock(m_configMutex);
     ReconfigureGuard guard(*this);
 
@@ -1205,13 +1425,50 @@ void DirettaSync::configureRingPCM(int rate, int channels, int direttaBps, int i
     m_isLowBitrate.store(direttaBps <= 2 && rate <= 48000, std::memory_order_release);
     m_dsdConversionMode.store(DirettaRingBuffer::DSDConversionMode::Passthrough, std::memory_order_release);
 
+    // Conversions take input-width frames, the copy sink-width frames
+    using PCMConversion = DirettaRingBuffer::PCMConversion;
+    PushPaths paths;
+    if (direttaBps == 3 && inputBps == 4) {
+        paths.send = DirettaRingBuffer::selectPCMPush(PCMConversion::Pack24);
+        paths.sendFrameBytes = 4 * static_cast<size_t>(channels);  // S24_P32
+        paths.sendLabel = "PCM24";
+    } else if (direttaBps == 4 && inputBps == 2) {
+        paths.send = DirettaRingBuffer::selectPCMPush(PCMConversion::Upsample16To32);
+        paths.sendFrameBytes = 2 * static_cast<size_t>(channels);
+        paths.sendLabel = "PCM16->32";
+    } else if (direttaBps == 4 && inputBps == 3) {
+        paths.send = DirettaRingBuffer::selectPCMPush(PCMConversion::Widen24To32);
+        paths.sendFrameBytes = 3 * static_cast<size_t>(channels);
+        paths.sendLabel = "PCM24->32";
+    } else if (direttaBps == 3 && inputBps == 2) {
+        // Sink only supports 24-bit, not 32-bit
+        paths.send = DirettaRingBuffer::selectPCMPush(PCMConversion::Upsample16To24);
+        paths.sendFrameBytes = 2 * static_cast<size_t>(channels);
+        paths.sendLabel = "PCM16->24";
+    } else if (direttaBps == 2 && inputBps == 3) {
+        paths.send = DirettaRingBuffer::selectPCMPush(PCMConversion::Narrow24To16);
+        paths.sendFrameBytes = 3 * static_cast<size_t>(channels);
+        paths.sendLabel = "PCM24->16";
+    } else if (direttaBps == 2 && inputBps == 4) {
+        paths.send = DirettaRingBuffer::selectPCMPush(PCMConversion::Narrow32To16);
+        paths.sendFrameBytes = 4 * static_cast<size_t>(channels);
+        paths.sendLabel = "PCM32->16";
+    } else {
+        paths.send = DirettaRingBuffer::selectPCMPush(PCMConversion::Copy);
+        paths.sendFrameBytes = static_cast<size_t>(direttaBps) * channels;
+        paths.sendLabel = "PCM";
+    }
+    m_pushPaths = paths;
+
     // Increment format generation to invalidate cached values in sendAudio
     m_formatGeneration.fetch_add(1, std::memory_order_release);
     // C1: Also increment consumer generation for getNewStream
     m_consumerStateGen.fetch_add(1, std::memory_order_release);
 
     size_t bytesPerSecond = static_cast<size_t>(rate) * channels * direttaBps;
-    size_t ringSize = DirettaBuffer::calculateBufferSize(bytesPerSecond, DirettaBuffer::PCM_BUFFER_SECONDS);
+    endBufferSession();
+    size_t ringSize = DirettaBuffer::calculateBufferSize(
+        bytesPerSecond, DirettaBuffer::PCM_BUFFER_SECONDS * m_bufferTuner.scale(false));
 
     m_ringBuffer.resize(ringSize, 0x00);
     ringSize = m_ringBuffer.size();
@@ -1249,12 +1506,16 @@ void DirettaSync::configureRingPCM(int rate, int channels, int direttaBps, int i
         m_prefillTarget = totalBytes;
     }
     m_prefillComplete = false;
+    m_bufferTuner.beginSession(false, ringSize, bytesPerSecond, bytesPerBuffer, m_config.flowLowWater);
 
     DIRETTA_LOG("Ring PCM: " << rate << "Hz " << channels << "ch "
                 << direttaBps << "bps, buffer=" << ringSize
                 << ", prefill=" << m_prefillTargetBuffers << " buffers ("
                 << m_prefillTarget << " bytes, "
-                << (isCompressed ? "compressed" : "uncompressed") << ")");
+                << (isCompressed ? "compressed" : "uncompressed") << ")"
+                << (m_ringBuffer.isMirrored() ? " [mirrored]" : "")
+                << (m_ringBuffer.isHugePages() ? " [huge pages]" : ""));
+    return true;
 }
 
 void DirettaSync::configureRingDSD(uint32_t byteRate, int channels) {
@@ -1268,13 +1529,26 @@ void DirettaSync::configureRingDSD(uint32_t byteRate, int channels) {
     m_channels.store(channels, std::memory_order_release);
     m_isLowBitrate.store(false, std::memory_order_release);
 
+    // Conversion mode was chosen by configureSinkDSD()
+    DirettaRingBuffer::DSDConversionMode mode = m_dsdConversionMode.load(std::memory_order_acquire);
+    PushPaths paths;
+    paths.send = DirettaRingBuffer::selectDSDPlanarPush(mode, channels);
+    paths.sendLabel = "DSD";
+    paths.dsdU32 = DirettaRingBuffer::selectDSDInterleavedPush(
+        DirettaRingBuffer::DSDSourceLayout::InterleavedU32, mode, channels);
+    paths.dsdDoP = DirettaRingBuffer::selectDSDInterleavedPush(
+        DirettaRingBuffer::DSDSourceLayout::DoP, mode, channels);
+    m_pushPaths = paths;
+
     // Increment format generation to invalidate cached values in sendAudio
     m_formatGeneration.fetch_add(1, std::memory_order_release);
     // C1: Also increment consumer generation for getNewStream
     m_consumerStateGen.fetch_add(1, std::memory_order_release);
 
     uint32_t bytesPerSecond = byteRate * channels;
-    size_t ringSize = DirettaBuffer::calculateBufferSize(bytesPerSecond, DirettaBuffer::DSD_BUFFER_SECONDS);
+    endBufferSession();
+    size_t ringSize = DirettaBuffer::calculateBufferSize(
+        bytesPerSecond, DirettaBuffer::DSD_BUFFER_SECONDS * m_bufferTuner.scale(true));
 
     m_ringBuffer.resize(ringSize, 0x69);  // DSD silence
     ringSize = m_ringBuffer.size();
@@ -1292,10 +1566,22 @@ void DirettaSync::configureRingDSD(uint32_t byteRate, int channels) {
     m_prefillTargetBuffers = calculateAlignedPrefill(bytesPerSecond, bytesPerBuffer, true, false);
     m_prefillTarget = m_prefillTargetBuffers * bytesPerBuffer;
     m_prefillComplete = false;
+    m_bufferTuner.beginSession(true, ringSize, bytesPerSecond, bytesPerBuffer, m_config.flowLowWater);
 
     DIRETTA_LOG("Ring DSD: byteRate=" << byteRate << " ch=" << channels
                 << " buffer=" << ringSize << " prefill=" << m_prefillTargetBuffers
-                << " buffers (" << m_prefillTarget << " bytes)");
+                << " buffers (" << m_prefillTarget << " bytes)"
+                << (m_ringBuffer.isMirrored() ? " [mirrored]" : "")
+                << (m_ringBuffer.isHugePages() ? " [huge pages]" : ""));
+}
+
+void DirettaSync::endBufferSession() {
+    BufferTuner::Verdict v = m_bufferTuner.endSession();
+    if (!v.changed) return;
+    LOG_INFO("[DirettaSync] " << (v.dsd ? "DSD" : "PCM") << " buffer scale "
+             << std::fixed << std::setprecision(2) << v.oldScale << " -> " << v.newScale
+             << " (" << std::setprecision(1) << v.seconds << " s, " << v.lateDeliveries
+             << " late, dip " << v.dipMs << "/" << v.lowWaterMs << " ms)");
 }
 
 //=============================================================================
@@ -1366,9 +1652,13 @@ void DirettaSync::resumePlayback() {
     m_stopRequested = false;
     m_silenceBuffersRemaining = 0;
 
-    // Clear stale buffer data and require fresh prefill
-    m_ringBuffer.clear();
-    m_prefillComplete = false;
+    // Clear stale buffer data and require fresh prefill (the worker is
+    // running, emitting silence while paused)
+    {
+        ReconfigureGuard guard(*this);
+        m_ringBuffer.clear();
+        m_prefillComplete = false;
+    }
 
     play();
     m_paused = false;
@@ -1377,6 +1667,21 @@ void DirettaSync::resumePlayback() {
     DIRETTA_LOG("Resumed - buffer cleared, waiting for prefill");
 }
 
+size_t DirettaSync::flushBuffered() {
+    if (!m_open) return 0;
+
+    size_t dropped;
+    {
+        // The worker emits silence while the ring is reconfiguring
+        ReconfigureGuard guard(*this);
+        dropped = m_ringBuffer.getAvailable();
+        m_ringBuffer.discard();
+        m_prefillComplete = false;
+    }
+    DIRETTA_LOG("Flushed " << dropped << " buffered bytes, waiting for prefill");
+    return dropped;
+}
+
 void DirettaSync::sendPreTransitionSilence() {
     // Pre-transition silence disabled - was causing issues during format switching
     // The stopPlayback() silence mechanism handles this case adequately
@@ -1386,107 +1691,164 @@ void DirettaSync::sendPreTransitionSilence() {
 // Audio Data (Push Interface)
 //=============================================================================
 
-size_t DirettaSync::sendAudio(const uint8_t* data, size_t numSamples) {
-    if (m_draining.load(std::memory_order_acquire)) return 0;
-    if (m_stopRequested.load(std::memory_order_acquire)) return 0;
-    if (!is_online()) return 0;
-
-    RingAccessGuard ringGuard(m_ringUsers, m_reconfiguring);
-    if (!ringGuard.active()) return 0;
-
+void DirettaSync::refreshFormatCache() {
     // Generation counter optimization: single atomic load vs 5-6 loads
     // Only reload format atomics when format has actually changed
     uint32_t gen = m_formatGeneration.load(std::memory_order_acquire);
     if (gen != m_cachedFormatGen) {
         m_cachedDsdMode = m_isDsdMode.load(std::memory_order_acquire);
-        m_cachedPack24bit = m_need24BitPack.load(std::memory_order_acquire);
-        m_cachedUpsample16to32 = m_need16To32Upsample.load(std::memory_order_acquire);
-        m_cachedUpsample16to24 = m_need16To24Upsample.load(std::memory_order_acquire);
         m_cachedChannels = m_channels.load(std::memory_order_acquire);
-        m_cachedBytesPerSample = m_bytesPerSample.load(std::memory_order_acquire);
-        m_cachedDsdConversionMode = m_dsdConversionMode.load(std::memory_order_acquire);
+        m_cachedDirectCopy = !m_cachedDsdMode && !m_need24BitPack.load(std::memory_order_acquire) &&
+                             !m_need16To32Upsample.load(std::memory_order_acquire) &&
+                             !m_need16To24Upsample.load(std::memory_order_acquire) &&
+                             m_bytesPerSample.load(std::memory_order_acquire) ==
+                                 m_inputBytesPerSample.load(std::memory_order_acquire);
+        m_cachedPushPaths = m_pushPaths;
         m_cachedFormatGen = gen;
     }
+}
+
+void DirettaSync::onAudioPushed(size_t inputBytes, size_t written, const char* formatLabel) {
+    if (written == 0) return;
+
+    // Check prefill completion
+    if (!m_prefillComplete.load(std::memory_order_acquire)) {
+        if (m_ringBuffer.getAvailable() >= m_prefillTarget) {
+            m_prefillComplete = true;
+            m_bufferTuner.onPrefillComplete();
+            DIRETTA_LOG(formatLabel << " prefill complete: " << m_ringBuffer.getAvailable() << " bytes");
+        }
+    } else {
+        size_t avail = m_ringBuffer.getAvailable();
+        m_bufferTuner.onDelivery(avail > written ? avail - written : 0, written);
+    }
+
+    if (g_verbose) {
+        int count = m_pushCount.fetch_add(1, std::memory_order_relaxed) + 1;
+        if (count <= 3 || count % 500 == 0) {
+            // A3: Async logging in hot path - avoids cout blocking
+            DIRETTA_LOG_ASYNC("sendAudio #{} in={} out={} avail={} [{}]", count, inputBytes,
+                              written, m_ringBuffer.getAvailable(), formatLabel);
+        }
+    }
+}
+
+size_t DirettaSync::sendAudio(const uint8_t* data, size_t numSamples) {
+    HistogramTimer timer(m_histSendAudio);
+    m_lastPushLen = 0;
+    if (m_draining.load(std::memory_order_acquire)) return 0;
+    if (m_stopRequested.load(std::memory_order_acquire)) return 0;
+    if (!is_online()) return 0;
 
-    // Use cached values (no atomic loads in hot path)
-    bool dsdMode = m_cachedDsdMode;
-    bool pack24bit = m_cachedPack24bit;
-    bool upsample16to32 = m_cachedUpsample16to32;
-    bool upsample16to24 = m_cachedUpsample16to24;
+    RingAccessGuard ringGuard(m_ringUsers, m_reconfiguring);
+    if (!ringGuard.active()) return 0;
+
+    refreshFormatCache();
+
+    // Path resolved at configureRing*() - no per-call format branching
+    const PushPaths& path = m_cachedPushPaths;
+    if (!path.send) return 0;
     int numChannels = m_cachedChannels;
-    int bytesPerSample = m_cachedBytesPerSample;
 
-    size_t written = 0;
-    size_t totalBytes;
-    const char* formatLabel;
+    // DSD: numSamples encoding from AudioEngine is (totalBytes * 8) / channels.
+    // PCM: numSamples is the frame count.
+    size_t totalBytes = m_cachedDsdMode ? (numSamples * numChannels) / 8
+                                        : numSamples * path.sendFrameBytes;
 
-    if (dsdMode) {
-        // DSD: numSamples encoding from AudioEngine
-        // numSamples = (totalBytes * 8) / channels
-        // Reverse: totalBytes = numSamples * channels / 8
-        totalBytes = (numSamples * numChannels) / 8;
+    m_lastPushPos = m_ringBuffer.writePosition();
+    size_t written = (m_ringBuffer.*path.send)(data, totalBytes, numChannels);
+    m_lastPushLen = m_ringBuffer.bytesWrittenSince(m_lastPushPos);
 
-        // Use optimized path with cached conversion mode (no per-iteration branching)
-        written = m_ringBuffer.pushDSDPlanarOptimized(
-            data, totalBytes, numChannels, m_cachedDsdConversionMode);
-        formatLabel = "DSD";
+    onAudioPushed(totalBytes, written, path.sendLabel);
+    return written;
+}
 
-    } else if (pack24bit) {
-        // PCM 24-bit: numSamples is sample count
-        size_t bytesPerFrame = 4 * numChannels;  // S24_P32
-        totalBytes = numSamples * bytesPerFrame;
+size_t DirettaSync::sendAudioDSD(const uint8_t* data, size_t inputBytes,
+                                 DirettaRingBuffer::DSDSourceLayout layout) {
+    HistogramTimer timer(m_histSendAudio);
+    m_lastPushLen = 0;
+    if (m_draining.load(std::memory_order_acquire)) return 0;
+    if (m_stopRequested.load(std::memory_order_acquire)) return 0;
+    if (!is_online()) return 0;
 
-        written = m_ringBuffer.push24BitPacked(data, totalBytes);
-        formatLabel = "PCM24";
+    RingAccessGuard ringGuard(m_ringUsers, m_reconfiguring);
+    if (!ringGuard.active()) return 0;
 
-    } else if (upsample16to32) {
-        // PCM 16->32
-        size_t bytesPerFrame = 2 * numChannels;
-        totalBytes = numSamples * bytesPerFrame;
+    refreshFormatCache();
+    if (!m_cachedDsdMode) return 0;
 
-        written = m_ringBuffer.push16To32(data, totalBytes);
-        formatLabel = "PCM16->32";
+    DirettaRingBuffer::PushFn push = (layout == DirettaRingBuffer::DSDSourceLayout::DoP)
+        ? m_cachedPushPaths.dsdDoP : m_cachedPushPaths.dsdU32;
+    if (!push) return 0;
+    m_lastPushPos = m_ringBuffer.writePosition();
+    size_t consumed = (m_ringBuffer.*push)(data, inputBytes, m_cachedChannels);
+    m_lastPushLen = m_ringBuffer.bytesWrittenSince(m_lastPushPos);
 
-    } else if (upsample16to24) {
-        // PCM 16->24 (sink only supports 24-bit, not 32-bit)
-        size_t bytesPerFrame = 2 * numChannels;
-        totalBytes = numSamples * bytesPerFrame;
+    onAudioPushed(inputBytes, consumed, "DSD");
+    return consumed;
+}
 
-        written = m_ringBuffer.push16To24(data, totalBytes);
-        formatLabel = "PCM16->24";
+size_t DirettaSync::sendAudioDirect(size_t maxBytes, size_t granule,
+                                    DirectFillFn fill, void* ctx) {
+    HistogramTimer timer(m_histSendAudio);
+    m_lastPushLen = 0;
+    if (m_draining.load(std::memory_order_acquire)) return 0;
+    if (m_stopRequested.load(std::memory_order_acquire)) return 0;
+    if (!is_online()) return 0;
+    if (granule == 0) return 0;
 
-    } else {
-        // PCM direct copy
-        size_t bytesPerFrame = static_cast<size_t>(bytesPerSample) * numChannels;
-        totalBytes = numSamples * bytesPerFrame;
+    RingAccessGuard ringGuard(m_ringUsers, m_reconfiguring);
+    if (!ringGuard.active()) return 0;
 
-        written = m_ringBuffer.push(data, totalBytes);
-        formatLabel = "PCM";
-    }
+    refreshFormatCache();
+    if (!m_cachedDirectCopy) return 0;
+
+    size_t len = maxBytes - (maxBytes % granule);
+    uint8_t* region;
+    size_t available;
+    if (!m_ringBuffer.getDirectWriteRegion(len, region, available)) return 0;
+
+    // The pipe read is the caller's time, not ours
+    auto fillStart = std::chrono::steady_clock::now();
+    size_t written = fill(ctx, region, len);
+    timer.exclude(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - fillStart).count()));
+    written -= written % granule;
+    m_lastPushPos = m_ringBuffer.writePosition();
+    m_ringBuffer.commitDirectWrite(written);
+    m_lastPushLen = written;
+
+    onAudioPushed(len, written, "PCM-direct");
+    return written;
+}
 
-    // Check prefill completion
-    if (written > 0) {
-        if (!m_prefillComplete.load(std::memory_order_acquire)) {
-            if (m_ringBuffer.getAvailable() >= m_prefillTarget) {
-                m_prefillComplete = true;
-                DIRETTA_LOG(formatLabel << " prefill complete: " << m_ringBuffer.getAvailable() << " bytes");
-            }
-        }
+size_t DirettaSync::sendConvertedFrom(const DirettaSync& leader) {
+    HistogramTimer timer(m_histSendAudio);
+    m_lastPushLen = 0;
+    if (leader.m_lastPushLen == 0) return 0;
+    if (m_draining.load(std::memory_order_acquire)) return 0;
+    if (m_stopRequested.load(std::memory_order_acquire)) return 0;
+    if (!is_online()) return 0;
 
-        if (g_verbose) {
-            int count = m_pushCount.fetch_add(1, std::memory_order_relaxed) + 1;
-            if (count <= 3 || count % 500 == 0) {
-                // A3: Async logging in hot path - avoids cout blocking
-                DIRETTA_LOG_ASYNC("sendAudio #" << count << " in=" << totalBytes
-                                  << " out=" << written << " avail=" << m_ringBuffer.getAvailable()
-                                  << " [" << formatLabel << "]");
-            }
-        }
-    }
+    RingAccessGuard ringGuard(m_ringUsers, m_reconfiguring);
+    if (!ringGuard.active()) return 0;
 
+    m_lastPushPos = m_ringBuffer.writePosition();
+    size_t written = m_ringBuffer.pushFrom(leader.m_ringBuffer, leader.m_lastPushPos, leader.m_lastPushLen);
+    m_lastPushLen = written;
+
+    onAudioPushed(leader.m_lastPushLen, written, "fan-out");
     return written;
 }
 
+bool DirettaSync::sameConversion(const DirettaSync& other) const {
+    return m_isDsdMode.load(std::memory_order_acquire) == other.m_isDsdMode.load(std::memory_order_acquire) &&
+           m_channels.load(std::memory_order_acquire) == other.m_channels.load(std::memory_order_acquire) &&
+           m_pushPaths.send == other.m_pushPaths.send &&
+           m_pushPaths.dsdU32 == other.m_pushPaths.dsdU32 &&
+           m_pushPaths.dsdDoP == other.m_pushPaths.dsdDoP;
+}
+
 float DirettaSync::getBufferLevel() const {
     RingAccessGuard ringGuard(m_ringUsers, m_reconfiguring);
     if (!ringGuard.active()) return 0.0f;
@@ -1495,6 +1857,32 @@ float DirettaSync::getBufferLevel() const {
     return static_cast<float>(m_ringBuffer.getAvailable()) / static_cast<float>(size);
 }
 
+bool DirettaSync::waitForLowWater(std::chrono::milliseconds timeout) {
+    // Announce the wait before re-checking so a pop can't slip in between
+    m_flowWaiting.store(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+
+    if (getBufferLevel() > m_config.flowLowWater) {
+        DIRETTA_COUNT("flow_waits", 1);
+        struct pollfd pfd = { m_flowEventFd, POLLIN, 0 };
+        if (::poll(&pfd, 1, static_cast<int>(timeout.count())) > 0) {
+            uint64_t count;
+            ssize_t rc = ::read(m_flowEventFd, &count, sizeof(count));
+            (void)rc;
+        }
+    }
+
+    m_flowWaiting.store(0, std::memory_order_relaxed);
+    return getBufferLevel() <= m_config.flowLowWater;
+}
+
+void DirettaSync::wakeFlowWaiter() {
+    if (m_flowEventFd < 0) return;
+    uint64_t one = 1;
+    ssize_t rc = ::write(m_flowEventFd, &one, sizeof(one));
+    (void)rc;
+}
+
 void DirettaSync::dumpStats() const {
     std::cout << "\n════════════════════════════════════════" << std::endl;
     std::cout << "[DirettaSync] Runtime Statistics" << std::endl;
@@ -1519,9 +1907,64 @@ void DirettaSync::dumpStats() const {
     std::cout << "  Streams:     " << m_streamCount.load(std::memory_order_relaxed) << std::endl;
     std::cout << "  Pushes:      " << m_pushCount.load(std::memory_order_relaxed) << std::endl;
     std::cout << "  Underruns:   " << m_underrunCount.load(std::memory_order_relaxed) << std::endl;
+
+    auto row = [](const char* name, const Histogram& h, double scale, const char* unit) {
+        std::cout << "  " << std::left << std::setw(13) << name << std::right
+                  << std::fixed << std::setprecision(1)
+                  << "p50 " << h.percentile(0.50) / scale
+                  << "  p99 " << h.percentile(0.99) / scale
+                  << "  max " << h.max() / scale << " " << unit << std::endl;
+    };
+    std::cout << "  ---- latency (n=" << m_histStreamExec.count() << " streams) ----" << std::endl;
+    row("Stream exec", m_histStreamExec, 1000.0, "us");
+    row("Interval", m_histStreamInterval, 1000.0, "us");
+    row("Jitter", m_histCycleJitter, 1000.0, "us");
+    row("sendAudio", m_histSendAudio, 1000.0, "us");
+    row("Ring fill", m_histRingFill, 10.0, "%");
     std::cout << "════════════════════════════════════════\n" << std::endl;
 }
 
+void DirettaSync::writeStatsJson(std::ostream& os) const {
+    // Not from m_currentFormat or the ring directly: open() rewrites both
+    // on the producer thread while this runs on the stats thread. The ring
+    // reads as empty while a reconfigure holds it.
+    size_t ringSize = 0;
+    size_t ringAvail = 0;
+    {
+        RingAccessGuard ringGuard(m_ringUsers, m_reconfiguring);
+        if (ringGuard.active()) {
+            ringSize = m_ringBuffer.size();
+            ringAvail = m_ringBuffer.getAvailable();
+        }
+    }
+    os << "{\"state\":\""
+       << (m_playing.load(std::memory_order_relaxed) ? "playing" :
+           m_paused.load(std::memory_order_relaxed) ? "paused" :
+           m_open.load(std::memory_order_relaxed) ? "open" : "stopped")
+       << "\",\"sample_rate\":" << m_statsSampleRate.load(std::memory_order_relaxed)
+       << ",\"dsd\":" << (m_statsDsd.load(std::memory_order_relaxed) ? "true" : "false")
+       << ",\"ring_size\":" << ringSize
+       << ",\"ring_avail\":" << ringAvail
+       << ",\"cycle_time_ns\":" << m_cycleTimeNs.load(std::memory_order_relaxed)
+       << ",\"mtu\":" << m_effectiveMTU.load(std::memory_order_relaxed)
+       << ",\"streams\":" << m_streamCount.load(std::memory_order_relaxed)
+       << ",\"pushes\":" << m_pushCount.load(std::memory_order_relaxed)
+       << ",\"underruns\":" << m_underrunCount.load(std::memory_order_relaxed)
+       << ",\"buffer_scale_pcm\":" << m_bufferTuner.scale(false)
+       << ",\"buffer_scale_dsd\":" << m_bufferTuner.scale(true)
+       << ",\"stream_exec_ns\":";
+    m_histStreamExec.writeJson(os);
+    os << ",\"stream_interval_ns\":";
+    m_histStreamInterval.writeJson(os);
+    os << ",\"cycle_jitter_ns\":";
+    m_histCycleJitter.writeJson(os);
+    os << ",\"send_audio_ns\":";
+    m_histSendAudio.writeJson(os);
+    os << ",\"ring_fill_permille\":";
+    m_histRingFill.writeJson(os);
+    os << "}";
+}
+
 //=============================================================================
 // DIRETTA::Sync Overrides
 //=============================================================================
@@ -1534,6 +1977,21 @@ bool DirettaSync::getNewStream(diretta_stream& baseStream) {
 
     m_workerActive = true;
 
+    // Stats: this call's execution time, and the cycle interval since the last
+    HistogramTimer execTimer(m_histStreamExec);
+    {
+        auto now = std::chrono::steady_clock::now();
+        auto interval = std::chrono::duration_cast<std::chrono::nanoseconds>(now - m_lastStreamCall).count();
+        // Skip the first call after a stop/pause (interval > 1s)
+        if (interval > 0 && interval < 1000000000LL) {
+            uint64_t ns = static_cast<uint64_t>(interval);
+            uint64_t cycle = m_cycleTimeNs.load(std::memory_order_relaxed);
+            m_histStreamInterval.record(ns);
+            m_histCycleJitter.record(ns > cycle ? ns - cycle : cycle - ns);
+        }
+        m_lastStreamCall = now;
+    }
+
     // C1: Generation counter optimization for stable state
     // Single atomic load in common case (format rarely changes during playback)
     uint32_t gen = m_consumerStateGen.load(std::memory_order_acquire);
@@ -1566,8 +2024,9 @@ bool DirettaSync::getNewStream(diretta_stream& baseStream) {
     }
 
     // SDK 148 WORKAROUND: Use our own buffer instead of Stream::resize()
-    // Resize our persistent buffer if needed
-    if (m_streamData.size() != static_cast<size_t>(currentBytesPerBuffer)) {
+    // Sized for the largest buffer at construction; growing here would
+    // allocate on the SCHED_FIFO thread
+    if (m_streamData.size() < static_cast<size_t>(currentBytesPerBuffer)) {
         m_streamData.resize(currentBytesPerBuffer);
     }
 
@@ -1580,18 +2039,21 @@ bool DirettaSync::getNewStream(diretta_stream& baseStream) {
 
     RingAccessGuard ringGuard(m_ringUsers, m_reconfiguring);
     if (!ringGuard.active()) {
-        std::memset(dest, currentSilenceByte, currentBytesPerBuffer);
+        emitSilence(baseStream, currentSilenceByte, currentBytesPerBuffer);
         m_workerActive = false;
         return true;
     }
 
+    // Z1: The SDK is done with the ring region handed out last cycle
+    m_ringBuffer.releaseReadRegion();
+
     bool currentIsDsd = m_cachedConsumerIsDsd;
     size_t currentRingSize = m_ringBuffer.size();
 
     // Shutdown silence
     int silenceRemaining = m_silenceBuffersRemaining.load(std::memory_order_acquire);
     if (silenceRemaining > 0) {
-        std::memset(dest, currentSilenceByte, currentBytesPerBuffer);
+        emitSilence(baseStream, currentSilenceByte, currentBytesPerBuffer);
         m_silenceBuffersRemaining.fetch_sub(1, std::memory_order_acq_rel);
         m_workerActive = false;
         return true;
@@ -1599,7 +2061,7 @@ bool DirettaSync::getNewStream(diretta_stream& baseStream) {
 
     // Stop requested
     if (m_stopRequested.load(std::memory_order_acquire)) {
-        std::memset(dest, currentSilenceByte, currentBytesPerBuffer);
+        emitSilence(baseStream, currentSilenceByte, currentBytesPerBuffer);
         m_workerActive = false;
         return true;
     }
@@ -1608,16 +2070,15 @@ bool DirettaSync::getNewStream(diretta_stream& baseStream) {
     if (!m_prefillComplete.load(std::memory_order_acquire)) {
         // Diagnostic: Log prefill progress periodically (only in verbose mode)
         if (g_verbose) {
-            static int prefillLogCount = 0;
-            size_t avail = m_ringBuffer.getAvailable();
-            if (prefillLogCount++ % 50 == 0) {  // Log every 50th call (~100ms at typical rates)
+            // Every 50th call (~100ms at typical rates)
+            if (m_prefillWaitCount.fetch_add(1, std::memory_order_relaxed) % 50 == 0) {
+                size_t avail = m_ringBuffer.getAvailable();
                 float pct = (m_prefillTarget > 0) ? (100.0f * avail / m_prefillTarget) : 0.0f;
-                std::cout << "[Prefill] Waiting: " << avail << "/" << m_prefillTarget
-                          << " bytes (" << std::fixed << std::setprecision(1) << pct << "%)"
-                          << (currentIsDsd ? " [DSD]" : " [PCM]") << std::endl;
+                DIRETTA_LOG_ASYNC("[Prefill] Waiting: {}/{} bytes ({.1}%) {}", avail, m_prefillTarget,
+                                  pct, currentIsDsd ? "[DSD]" : "[PCM]");
             }
         }
-        std::memset(dest, currentSilenceByte, currentBytesPerBuffer);
+        emitSilence(baseStream, currentSilenceByte, currentBytesPerBuffer);
         m_workerActive = false;
         return true;
     }
@@ -1657,41 +2118,72 @@ bool DirettaSync::getNewStream(diretta_stream& baseStream) {
         if (count >= stabilizationTarget) {
             m_postOnlineDelayDone = true;
             m_stabilizationCount.store(0, std::memory_order_relaxed);
-            DIRETTA_LOG("Post-online stabilization complete (" << count << " buffers)");
+            DIRETTA_LOG_ASYNC("Post-online stabilization complete ({} buffers)", count);
         }
-        std::memset(dest, currentSilenceByte, currentBytesPerBuffer);
+        emitSilence(baseStream, currentSilenceByte, currentBytesPerBuffer);
         m_workerActive = false;
         return true;
     }
 
     int count = m_streamCount.fetch_add(1, std::memory_order_relaxed) + 1;
-    size_t avail = m_ringBuffer.getAvailable();
+    // Exact fill for the stats and the flow wake below; the pop reuses it
+    size_t avail = m_ringBuffer.refreshAvailable();
 
     if (g_verbose && (count <= 5 || count % 5000 == 0)) {
         float fillPct = (currentRingSize > 0) ? (100.0f * avail / currentRingSize) : 0.0f;
         // A3: Async logging in hot path - avoids cout blocking in Diretta callback
-        DIRETTA_LOG_ASYNC("getNewStream #" << count << " bpb=" << currentBytesPerBuffer
-                          << " avail=" << avail << " (" << std::fixed << std::setprecision(1)
-                          << fillPct << "%) " << (currentIsDsd ? "[DSD]" : "[PCM]"));
+        DIRETTA_LOG_ASYNC("getNewStream #{} bpb={} avail={} ({.1}%) {}", count, currentBytesPerBuffer,
+                          avail, fillPct, currentIsDsd ? "[DSD]" : "[PCM]");
     }
 
     // Underrun - count silently, log at session end
     if (avail < static_cast<size_t>(currentBytesPerBuffer)) {
-        m_underrunCount.fetch_add(1, std::memory_order_relaxed);
-        std::memset(dest, currentSilenceByte, currentBytesPerBuffer);
+        if (m_tailDraining.load(std::memory_order_relaxed)) {
+            // T1: The previous track has played out ahead of a transition:
+            // not an underrun. Wake drainForTransition() (fence as in G1).
+            m_tailDrained.store(true, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (m_drainWaiting.load(std::memory_order_relaxed) &&
+                m_drainWaiting.exchange(0, std::memory_order_relaxed)) {
+                wakeFlowWaiter();
+            }
+        } else {
+            m_underrunCount.fetch_add(1, std::memory_order_relaxed);
+            m_underrunTotal.fetch_add(1, std::memory_order_relaxed);
+            DIRETTA_COUNT("underruns", 1);
+        }
+        emitSilence(baseStream, currentSilenceByte, currentBytesPerBuffer);
         m_workerActive = false;
         return true;
     }
 
     // Pop from ring buffer
-    m_ringBuffer.pop(dest, currentBytesPerBuffer);
+    m_histRingFill.record(currentRingSize > 0 ? avail * 1000 / currentRingSize : 0);
+
+    // Z1: With mirrored storage, point the SDK straight into the ring. The
+    // region stays reserved until the next callback releases it above.
+    const uint8_t* region = m_config.zeroCopyStream
+        ? m_ringBuffer.acquireReadRegion(currentBytesPerBuffer) : nullptr;
+    if (region) {
+        baseStream.Data.P = const_cast<uint8_t*>(region);
+    } else {
+        m_ringBuffer.pop(dest, currentBytesPerBuffer);
+    }
 
-    // G1: Signal producer that space is now available
-    // Use try_lock to avoid blocking the time-critical consumer thread
-    // If producer isn't waiting, this is a no-op (harmless notification)
-    if (m_flowMutex.try_lock()) {
-        m_flowMutex.unlock();
-        m_spaceAvailable.notify_one();
+    // G1: Wake the producer once fill has dropped to the low watermark.
+    // The fence pairs with the one in waitForLowWater(): either we see the
+    // waiting flag or the producer sees the pop. One eventfd write per wakeup.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (m_flowWaiting.load(std::memory_order_relaxed) &&
+        avail - currentBytesPerBuffer <= static_cast<size_t>(currentRingSize * m_config.flowLowWater) &&
+        m_flowWaiting.exchange(0, std::memory_order_relaxed)) {
+        wakeFlowWaiter();
+    }
+    // T1: Same pairing for drainForTransition(), once less than a buffer is left
+    if (m_drainWaiting.load(std::memory_order_relaxed) &&
+        avail - currentBytesPerBuffer < static_cast<size_t>(currentBytesPerBuffer) &&
+        m_drainWaiting.exchange(0, std::memory_order_relaxed)) {
+        wakeFlowWaiter();
     }
 
     m_workerActive = false;
@@ -1701,35 +2193,96 @@ bool DirettaSync::getNewStream(diretta_stream& baseStream) {
 bool DirettaSync::startSyncWorker() {
     std::lock_guard<std::mutex> lock(m_workerMutex);
 
-    DIRETTA_LOG("startSyncWorker (running=" << m_running.load() << ")");
+    DIRETTA_LOG("startSyncWorker (state=" << m_workerState.load() << ")");
 
-    if (m_running.load() && m_workerThread.joinable()) {
-        DIRETTA_LOG("Worker already running");
-        return true;
-    }
+    m_stopRequested = false;
 
+    // W1: One worker for the lifetime of this object. Sync::open() after a
+    // format change only unparks it, so the SCHED_FIFO promotion (and any
+    // CPU pinning applied to its TID) carries over.
     if (m_workerThread.joinable()) {
-        m_workerThread.join();
+        m_workerState.store(WORKER_RUNNING);
+        futexWake(m_workerState);
+        DIRETTA_LOG("Worker unparked");
+        return true;
     }
 
-    m_running = true;
-    m_stopRequested = false;
+    m_workerState.store(WORKER_RUNNING);
+    m_workerParked.store(0);
 
     m_workerThread = std::thread([this]() {
         // F1: Elevate worker thread priority for reduced jitter
-        // SCHED_FIFO priority 50 (mid-range real-time) - requires root/CAP_SYS_NICE
-        setRealtimePriority(50);
+        // SCHED_FIFO priority 50 (mid-range real-time) by default - requires
+        // root/CAP_SYS_NICE. Pinning and policy come from --worker-cpu etc.
+        ThreadTuning tuning = m_config.workerThread;
+
+        // SCHED_DEADLINE without an explicit period runs at the cycle time
+        // open() chose. With cycleTimeAuto that changes per format while
+        // this thread lives on, so the period follows it below.
+        bool followCycle = tuning.policy == SchedPolicy::Deadline && tuning.deadlinePeriodUs == 0;
+        uint64_t periodNs = m_cycleTimeNs.load(std::memory_order_relaxed);
+        if (followCycle) {
+            tuning.deadlinePeriodUs = periodNs > 0 ? static_cast<unsigned int>(periodNs / 1000)
+                                                   : m_config.cycleTime;
+        }
+        applyThreadTuning("sq2d-worker", "DirettaSync worker", tuning);
+
+        for (;;) {
+            uint32_t state = m_workerState.load();
+            if (state == WORKER_EXIT) break;
+
+            if (state == WORKER_PARKED) {
+                // Acknowledge, then sleep until unparked: parkWorker() may
+                // now close the SDK
+                m_workerParked.store(1);
+                futexWake(m_workerParked);
+                futexWait(m_workerState, WORKER_PARKED);
+                continue;
+            }
+
+            // Clear the acknowledgement, then re-check: a park that raced
+            // with the unpark either sees 0 here or is seen by this load
+            if (m_workerParked.load(std::memory_order_relaxed) != 0) {
+                m_workerParked.store(0);
+                continue;
+            }
+
+            if (followCycle) {
+                uint64_t cycleNs = m_cycleTimeNs.load(std::memory_order_relaxed);
+                if (cycleNs != periodNs && cycleNs > 0) {
+                    periodNs = cycleNs;
+                    followCycle = updateDeadlinePeriod("DirettaSync worker",
+                                                       static_cast<unsigned int>(cycleNs / 1000));
+                }
+            }
 
-        while (m_running.load(std::memory_order_acquire)) {
             if (!syncWorker()) {
                 std::this_thread::sleep_for(std::chrono::microseconds(100));
             }
         }
+
+        m_workerParked.store(1);
+        futexWake(m_workerParked);
     });
 
     return true;
 }
 
+// W1: Stop calling into the SDK and wait until the worker has left
+// syncWorker(). After this, Sync::close() cannot race with getNewStream().
+void DirettaSync::parkWorker() {
+    std::lock_guard<std::mutex> lock(m_workerMutex);
+    if (!m_workerThread.joinable()) return;
+
+    uint32_t expected = WORKER_RUNNING;
+    m_workerState.compare_exchange_strong(expected, WORKER_PARKED);
+
+    while (m_workerParked.load() == 0) {
+        futexWait(m_workerParked, 0);
+    }
+    DIRETTA_LOG("Worker parked");
+}
+
 //=============================================================================
 // Internal Helpers
 //=============================================================================
@@ -1745,9 +2298,21 @@ void DirettaSync::endReconfigure() {
     m_reconfiguring.store(false, std::memory_order_release);
 }
 
+// Z2: Point the SDK at the prebuilt silence buffer for this byte. Only an
+// unexpected silence byte or an oversized buffer still costs a memset.
+void DirettaSync::emitSilence(diretta_stream& stream, uint8_t silenceByte, size_t bytes) {
+    const auto& page = (silenceByte == 0x69) ? m_silenceDSD : m_silencePCM;
+    if (page[0] == silenceByte && bytes <= page.size()) {
+        stream.Data.P = const_cast<uint8_t*>(page.data());
+        return;
+    }
+    std::memset(stream.Data.P, silenceByte, bytes);
+}
+
 void DirettaSync::shutdownWorker() {
     m_stopRequested = true;
-    m_running = false;
+    m_workerState.store(WORKER_EXIT);
+    futexWake(m_workerState);
 
     int waitCount = 0;
     while (m_workerActive.load(std::memory_order_acquire) && waitCount < 100) {
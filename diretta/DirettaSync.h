@@ -9,7 +9,13 @@
 #ifndef DIRETTA_SYNC_H
 #define DIRETTA_SYNC_H
 
+#include "BufferTuner.h"
 #include "DirettaRingBuffer.h"
+#include "Histogram.h"
+#include "LogRing.h"
+#include "DiscoveryCache.h"
+#include "TargetCache.h"
+#include "ThreadTuning.h"
 
 #include <Sync.hpp>
 #include <Find.hpp>
@@ -30,70 +36,7 @@
 #include <cstring>
 #include <sstream>
 #include <condition_variable>
-
-//=============================================================================
-// Lock-free Log Ring Buffer (for non-blocking logging in hot paths)
-//=============================================================================
-
-struct LogEntry {
-    uint64_t timestamp_us;      // Microseconds since epoch
-    char message[248];          // Message text (256 - 8 = 248 for alignment)
-};
-static_assert(sizeof(LogEntry) == 256, "LogEntry must be 256 bytes");
-
-class LogRing {
-public:
-    static constexpr size_t CAPACITY = 1024;  // Must be power of 2
-    static constexpr size_t MASK = CAPACITY - 1;
-
-    LogRing() : m_writePos(0), m_readPos(0) {}
-
-    // Lock-free push (returns false if full - message dropped)
-    bool push(const char* msg) {
-        size_t wp = m_writePos.load(std::memory_order_relaxed);
-        size_t rp = m_readPos.load(std::memory_order_acquire);
-
-        if (((wp + 1) & MASK) == rp) {
-            return false;  // Full, drop message
-        }
-
-        // Get timestamp
-        auto now = std::chrono::steady_clock::now();
-        m_entries[wp].timestamp_us = std::chrono::duration_cast<std::chrono::microseconds>(
-            now.time_since_epoch()).count();
-
-        // Copy message (truncate if needed)
-        strncpy(m_entries[wp].message, msg, sizeof(m_entries[wp].message) - 1);
-        m_entries[wp].message[sizeof(m_entries[wp].message) - 1] = '\0';
-
-        m_writePos.store((wp + 1) & MASK, std::memory_order_release);
-        return true;
-    }
-
-    // Pop for drain thread (returns false if empty)
-    bool pop(LogEntry& entry) {
-        size_t rp = m_readPos.load(std::memory_order_relaxed);
-        size_t wp = m_writePos.load(std::memory_order_acquire);
-
-        if (rp == wp) {
-            return false;  // Empty
-        }
-
-        entry = m_entries[rp];
-        m_readPos.store((rp + 1) & MASK, std::memory_order_release);
-        return true;
-    }
-
-    bool empty() const {
-        return m_readPos.load(std::memory_order_acquire) ==
-               m_writePos.load(std::memory_order_acquire);
-    }
-
-private:
-    LogEntry m_entries[CAPACITY];
-    alignas(64) std::atomic<size_t> m_writePos;
-    alignas(64) std::atomic<size_t> m_readPos;
-};
+#include <functional>
 
 // Global log ring (initialized in main.cpp)
 extern LogRing* g_logRing;
@@ -108,7 +51,8 @@ extern bool g_verbose;
 #ifdef NOLOG
 // Production build: compile out all verbose logging for zero overhead
 #define DIRETTA_LOG(msg) do {} while(0)
-#define DIRETTA_LOG_ASYNC(msg) do {} while(0)
+#define DIRETTA_LOG_ASYNC(...) do {} while(0)
+#define DIRETTA_COUNT(name, delta) do {} while(0)
 #else
 // Debug build: check g_logLevel at runtime
 #define DIRETTA_LOG(msg) do { \
@@ -117,12 +61,18 @@ extern bool g_verbose;
     } \
 } while(0)
 
-// Async logging macro for hot paths (non-blocking)
-#define DIRETTA_LOG_ASYNC(msg) do { \
+// Async logging for hot paths: format string + raw arguments, formatted
+// later by the LogRing drain thread (see LogRing.h for placeholders)
+#define DIRETTA_LOG_ASYNC(...) do { \
     if (g_logRing && g_logLevel >= LogLevel::DEBUG) { \
-        std::ostringstream _oss; \
-        _oss << msg; \
-        g_logRing->push(_oss.str().c_str()); \
+        g_logRing->log(__VA_ARGS__); \
+    } \
+} while(0)
+
+// Named hot-path counter, totals printed by the drain thread
+#define DIRETTA_COUNT(name, delta) do { \
+    if (g_logRing) { \
+        g_logRing->count(name, delta); \
     } \
 } while(0)
 #endif
@@ -169,6 +119,7 @@ namespace DirettaRetry {
     // setSink configuration
     constexpr int SETSINK_RETRIES_FULL = 20;      // After disconnect
     constexpr int SETSINK_RETRIES_QUICK = 15;     // Quick reconfigure
+    constexpr int SETSINK_RETRIES_CACHED = 4;     // Cached address: rediscover rather than wait
     constexpr int SETSINK_DELAY_FULL_MS = 500;
     constexpr int SETSINK_DELAY_QUICK_MS = 300;
 
@@ -179,6 +130,16 @@ namespace DirettaRetry {
     // Format change reopen
     constexpr int REOPEN_SINK_RETRIES = 10;
     constexpr int REOPEN_SINK_DELAY_MS = 500;
+
+    // T1: setSink/connect retries back off from here up to their fixed delay
+    constexpr int BACKOFF_START_MS = 50;
+
+    // Target preparation after a (re)connect, counted from the teardown
+    constexpr int PREPARE_DELAY_FULL_MS = 500;
+    constexpr int PREPARE_DELAY_QUICK_MS = 200;
+
+    // Slack on top of the ring's audio when draining before a transition
+    constexpr int DRAIN_SLACK_MS = 250;
 }
 
 //=============================================================================
@@ -205,12 +166,21 @@ namespace DirettaBuffer {
     constexpr unsigned int FORMAT_SWITCH_DELAY_MS = 800;
     constexpr unsigned int POST_ONLINE_SILENCE_BUFFERS = 20;  // Was 50 - reduced for faster start
 
+    // Producer flow control: sleep above HIGH, woken by the consumer at LOW
+    constexpr float FLOW_HIGH_WATER = 0.75f;
+    constexpr float FLOW_LOW_WATER = 0.70f;
+
     // UPnP push model needs larger buffers than MPD's pull model
     // 64KB = ~370ms floor at 44.1kHz/16-bit, negligible at higher rates
     constexpr size_t MIN_BUFFER_BYTES = 65536;  // Was 3072000
     constexpr size_t MAX_BUFFER_BYTES = 16777216;
     constexpr size_t MIN_PREFILL_BYTES = 1024;
 
+    // Prebuilt silence handed to the SDK: one 1 ms buffer of 768 kHz/8ch/32-bit
+    // PCM (24 KB) plus one accumulator frame, and DSD1024 stereo (11 KB)
+    constexpr size_t SILENCE_PAGE_BYTES = 32768;
+    constexpr size_t MAX_STREAM_BUFFER_BYTES = SILENCE_PAGE_BYTES;  // Same bound for m_streamData
+
     inline size_t calculateBufferSize(size_t bytesPerSecond, float seconds) {
         size_t size = static_cast<size_t>(bytesPerSecond * seconds);
         size = std::max(size, MIN_BUFFER_BYTES);
@@ -294,6 +264,17 @@ struct DirettaConfig {
     unsigned int dacStabilizationMs = DirettaBuffer::DAC_STABILIZATION_MS;
     unsigned int onlineWaitMs = DirettaBuffer::ONLINE_WAIT_MS;
     unsigned int formatSwitchDelayMs = DirettaBuffer::FORMAT_SWITCH_DELAY_MS;
+    float flowLowWater = DirettaBuffer::FLOW_LOW_WATER;    // Fraction of ring size
+    float flowHighWater = DirettaBuffer::FLOW_HIGH_WATER;
+    bool zeroCopyStream = true;   // Hand the SDK ring memory (mirrored ring only)
+    bool adaptiveBuffer = true;   // Rescale ring/prefill per session (BufferTuner)
+    float bufferScaleMin = 0.25f; // Bounds, as a fraction of the DirettaBuffer defaults
+    float bufferScaleMax = 2.0f;
+    std::string sinkCachePath;    // Persist negotiated sink formats here ("" = memory only)
+    std::string discoveryCachePath; // Persist target address + MTU here ("" = discover every start)
+    ThreadTuning workerThread;    // SDK worker CPU/policy (default SCHED_FIFO 50, unpinned)
+    bool realtimeMemory = false;  // Populate ring storage and staging up front (with mlockall)
+    bool hugePages = false;       // Try hugetlbfs pages for rings of 2 MB and up
 };
 
 //=============================================================================
@@ -351,6 +332,16 @@ public:
     bool isOpen() const { return m_open; }
     bool isOnline() { return is_online(); }
 
+    /**
+     * @brief PCM bit depth the target takes at this rate (32, 24 or 16)
+     *
+     * The width open() configures, from the sink format cache or a probe
+     * that is then cached. Lets the caller have its source produce that
+     * width, so the ring copies instead of converting. Needs enable().
+     * @return Accepted bits, 0 if the target takes no PCM at this rate
+     */
+    int preferredPcmBits(int rate, int channels);
+
     //=========================================================================
     // Playback Control
     //=========================================================================
@@ -360,6 +351,16 @@ public:
     void pausePlayback();
     void resumePlayback();
 
+    /**
+     * @brief Drop buffered audio after a skip or seek (same connection)
+     *
+     * Empties the ring and waits for prefill again, so the target hears
+     * silence until the new position has buffered instead of the stale
+     * tail. No SDK stop/reopen or setSink; the format stays as it is.
+     * @return Bytes dropped
+     */
+    size_t flushBuffered();
+
     /**
      * @brief Send silence buffers before format transition
      *
@@ -384,10 +385,69 @@ public:
      */
     size_t sendAudio(const uint8_t* data, size_t numSamples);
 
+    /**
+     * @brief Send interleaved DSD straight from the source layout
+     * @param data Interleaved U32 frames or DoP frame pairs
+     * @param inputBytes Buffer size in bytes
+     * @param layout Source layout (squeezelite u32 or DoP)
+     * @return Input bytes consumed
+     *
+     * Single pass: the ring converts to the sink layout without the planar
+     * intermediate sendAudio() expects.
+     */
+    size_t sendAudioDSD(const uint8_t* data, size_t inputBytes,
+                        DirettaRingBuffer::DSDSourceLayout layout);
+
+    /**
+     * @brief Zero-copy push: let the producer write straight into the ring
+     * @param maxBytes Bytes to offer (rounded down to granule)
+     * @param granule Frame size in bytes; fill() must write whole frames
+     * @param fill Callable size_t(uint8_t* dst, size_t cap), returns bytes written
+     * @return Bytes committed to the ring
+     *
+     * Only used for PCM that needs no conversion (input and sink sample width
+     * match). fill() is not invoked when that doesn't hold, or when maxBytes
+     * of contiguous space isn't available (ring wrap point) - the caller then
+     * falls back to sendAudio().
+     */
+    template<typename Fill>
+    size_t sendAudioDirect(size_t maxBytes, size_t granule, Fill& fill) {
+        return sendAudioDirect(maxBytes, granule,
+            [](void* ctx, uint8_t* dst, size_t cap) -> size_t {
+                return (*static_cast<Fill*>(ctx))(dst, cap);
+            }, &fill);
+    }
+
+    /**
+     * @brief Fan-out: push what `leader` added to its ring in its last send*() call
+     *
+     * For a second target with the same conversion (sameConversion()): the
+     * leader's converted output is copied instead of converting the source
+     * again. Both are fed from the same producer thread.
+     * @return Bytes added to this ring
+     */
+    size_t sendConvertedFrom(const DirettaSync& leader);
+
+    // Same ring push paths and channel count: fed the same source, both
+    // rings receive identical bytes
+    bool sameConversion(const DirettaSync& other) const;
+
     float getBufferLevel() const;
     const AudioFormat& getFormat() const { return m_currentFormat; }
+
+    // Underruns since construction (the per-session count resets on stop)
+    uint64_t getUnderrunTotal() const { return m_underrunTotal.load(std::memory_order_relaxed); }
     void dumpStats() const;
 
+    /**
+     * @brief Write counters and hot-path histograms as a JSON object
+     *
+     * Latencies are in nanoseconds, ring fill in permille of ring size.
+     * Safe to call from any thread while streaming: reads only atomics,
+     * and the ring under a RingAccessGuard.
+     */
+    void writeStatsJson(std::ostream& os) const;
+
     /**
      * @brief Check if prefill is complete (ring buffer has enough data to start playback)
      * @return true if prefill threshold has been reached
@@ -421,33 +481,41 @@ public:
     //=========================================================================
 
     /**
-     * @brief Get flow control mutex for condition variable wait
-     * @return Reference to flow mutex
+     * @brief Play out the current track before switching to `next`
+     *
+     * Called by the producer as soon as the next track's header arrives.
+     * Decides the transition (quick resume or full reopen, reset delay)
+     * while the tail still plays, then sleeps until the consumer has
+     * drained the ring, bounded by the ring's audio plus DRAIN_SLACK_MS.
+     * The following open(next) reuses the plan.
+     *
+     * @return true if the ring drained, false on timeout
      */
-    std::mutex& getFlowMutex() { return m_flowMutex; }
+    bool drainForTransition(const AudioFormat& next);
+
+    /**
+     * @brief Check if the ring is above the high watermark
+     * @return true if the producer should wait before pushing more
+     */
+    bool isAboveHighWater() const {
+        return getBufferLevel() > m_config.flowHighWater;
+    }
 
     /**
-     * @brief Wait for buffer space with timeout
-     * @param lock Unique lock on flow mutex (must be locked)
+     * @brief Sleep until the consumer drains the ring to the low watermark
      * @param timeout Maximum wait duration
-     * @return true if notified, false if timeout
+     * @return true if fill is at or below the low watermark
      *
-     * Used by DSD send path to replace blocking 5ms sleep with event-based
-     * waiting. Reduces jitter from ±2.5ms to ±50µs.
+     * The consumer (getNewStream) wakes the producer through an eventfd
+     * when fill crosses the low mark, without taking a lock on the
+     * SCHED_FIFO thread. The timeout only bounds shutdown latency.
      */
-    template<typename Rep, typename Period>
-    bool waitForSpace(std::unique_lock<std::mutex>& lock,
-                      std::chrono::duration<Rep, Period> timeout) {
-        return m_spaceAvailable.wait_for(lock, timeout) == std::cv_status::no_timeout;
-    }
+    bool waitForLowWater(std::chrono::milliseconds timeout);
 
     /**
-     * @brief Signal that buffer space is available
-     * Called by consumer (getNewStream) after popping data
+     * @brief Wake a producer blocked in waitForLowWater()
      */
-    void notifySpaceAvailable() {
-        m_spaceAvailable.notify_one();
-    }
+    void wakeFlowWaiter();
 
     //=========================================================================
     // Target Management
@@ -473,21 +541,67 @@ private:
     // Internal Methods
     //=========================================================================
 
+    // Result of one discovery, so the background revalidation can run it
+    // without touching the target members
+    struct DiscoveredTarget {
+        ACQUA::IPAddress address;
+        std::string key;               // Identity + firmware, as m_targetKey
+        std::string name;
+        size_t found = 0;              // Targets that answered
+    };
+
     bool discoverTarget();
+    bool findTarget(DiscoveredTarget& target) const;
     bool measureMTU();
+    bool probeMTU(const ACQUA::IPAddress& address, uint32_t& mtu) const;
+    bool mtuConfigured() const { return m_mtuOverride > 0 || m_config.mtu > 0; }
+    std::string discoverySelection() const;
+    bool useCachedTarget();
+    void storeDiscovery();
+    void startRevalidation();
+    void joinRevalidation();
+    bool adoptRevalidatedTarget();
+    bool rediscoverTarget();
     bool openSyncConnection();
     bool reopenForFormatChange();
     void fullReset();
+    void parkWorker();
     void shutdownWorker();
 
+    int lookupPcmBits(DIRETTA::FormatConfigure& fmt, int rate, int channels);
     void configureSinkPCM(int rate, int channels, int inputBits, int& acceptedBits);
     void configureSinkDSD(uint32_t dsdBitRate, int channels, const AudioFormat& format);
-    void configureRingPCM(int rate, int channels, int direttaBps, int inputBps, bool isCompressed);
+    bool configureRingPCM(int rate, int channels, int direttaBps, int inputBps, bool isCompressed);
     void configureRingDSD(uint32_t byteRate, int channels);
+    void endBufferSession();
+
+    // T1: Format transition pipeline
+    enum class TransitionKind {
+        Fresh,   // Not open, or no previous format: full open
+        Quick,   // Same format: clear the ring and resume
+        Reopen   // Tear down, wait resetDelayMs, then full open
+    };
+
+    struct TransitionPlan {
+        TransitionKind kind = TransitionKind::Fresh;
+        int resetDelayMs = 0;
+        std::string reason;   // Logged when the transition runs
+    };
+
+    TransitionPlan planTransition(const AudioFormat& format) const;
+    void teardownForTransition();
+    bool retryWithBackoff(const char* what, int attempts, int maxDelayMs,
+                          const std::function<bool()>& fn);
     size_t calculateAlignedPrefill(size_t bytesPerSecond, size_t bytesPerBuffer,
                                    bool isDSD, bool isCompressed);
     void beginReconfigure();
     void endReconfigure();
+    void emitSilence(diretta_stream& stream, uint8_t silenceByte, size_t bytes);
+
+    using DirectFillFn = size_t (*)(void* ctx, uint8_t* dst, size_t cap);
+    size_t sendAudioDirect(size_t maxBytes, size_t granule, DirectFillFn fill, void* ctx);
+    void refreshFormatCache();
+    void onAudioPushed(size_t inputBytes, size_t written, const char* formatLabel);
 
     void applyTransferMode(DirettaTransferMode mode, ACQUA::Clock cycleTime);
     unsigned int calculateCycleTime(uint32_t sampleRate, int channels, int bitsPerSample);
@@ -515,9 +629,18 @@ private:
 
     // Target
     ACQUA::IPAddress m_targetAddress;
+    std::string m_targetKey;            // Identity + firmware, for m_targetCache
+    TargetCache m_targetCache;          // Sink formats each target accepted
+    DiscoveryCache m_discoveryCache;    // Address + MTU per --target selection
+    bool m_targetUnconfirmed = false;   // From m_discoveryCache, no open() has reached it yet
+    std::thread m_revalidateThread;
+    std::mutex m_revalidateMutex;       // Guards the fields below
+    bool m_hasRevalidated = false;      // Background discovery finished and differs from the cache
+    DiscoveredTarget m_revalidatedTarget;
+    uint32_t m_revalidatedMTU = 0;
     int m_targetIndex = -1;
     uint32_t m_mtuOverride = 0;
-    uint32_t m_effectiveMTU = 1500;
+    std::atomic<uint32_t> m_effectiveMTU{1500};   // Also read by the worker and the stats
 
     // Connection state
     std::atomic<bool> m_enabled{false};      // Target discovered, ready to use
@@ -531,8 +654,10 @@ private:
     AudioFormat m_previousFormat;
     bool m_hasPreviousFormat = false;
 
-    // Worker thread
-    std::atomic<bool> m_running{false};
+    // Worker thread (W1: created once, parked while the SDK is closed)
+    enum WorkerState : uint32_t { WORKER_PARKED = 0, WORKER_RUNNING = 1, WORKER_EXIT = 2 };
+    std::atomic<uint32_t> m_workerState{WORKER_PARKED};   // futex word
+    std::atomic<uint32_t> m_workerParked{1};              // futex word, worker out of the SDK
     std::atomic<bool> m_stopRequested{false};
     std::atomic<bool> m_draining{false};
     std::atomic<bool> m_workerActive{false};
@@ -542,11 +667,11 @@ private:
     std::atomic<bool> m_reconfiguring{false};
     mutable std::atomic<int> m_ringUsers{0};
 
-    // G1: Flow control for DSD atomic sends
-    // Condition variable allows producer to wait for buffer space
-    // without burning CPU or introducing 5ms sleep jitter
-    std::mutex m_flowMutex;
-    std::condition_variable m_spaceAvailable;
+    // G1: Producer flow control
+    // Producer sets m_flowWaiting and sleeps on the eventfd; the consumer
+    // writes it once fill reaches the low watermark (no mutex, no polling)
+    int m_flowEventFd = -1;
+    std::atomic<uint32_t> m_flowWaiting{0};
 
     // G1: Condition variable for interruptible format transition waits
     // Allows blocking waits to be interrupted on shutdown rather than sleeping
@@ -554,6 +679,15 @@ private:
     std::condition_variable m_transitionCv;
     std::atomic<bool> m_transitionWakeup{false};
 
+    // T1: Plan made by drainForTransition() for the next open()
+    TransitionPlan m_pendingPlan;
+    AudioFormat m_pendingPlanFormat;
+    bool m_hasPendingPlan = false;
+    std::chrono::steady_clock::time_point m_teardownTime{};
+    std::atomic<uint32_t> m_drainWaiting{0};   // Producer waits for an empty ring
+    std::atomic<bool> m_tailDraining{false};    // Empty ring is end of track, not underrun
+    std::atomic<bool> m_tailDrained{false};     // Consumer ran out during the drain
+
     // Ring buffer
     DirettaRingBuffer m_ringBuffer;
 
@@ -562,6 +696,11 @@ private:
     // We manage our own buffer and directly set diretta_stream.Data.P/Size fields.
     std::vector<uint8_t> m_streamData;
 
+    // Z2: Read-only silence buffers for PCM (0x00) and DSD (0x69), built once
+    // so the silence paths in getNewStream() write nothing
+    std::vector<uint8_t, AlignedAllocator<uint8_t, 64>> m_silencePCM;
+    std::vector<uint8_t, AlignedAllocator<uint8_t, 64>> m_silenceDSD;
+
     // Format parameters (atomic snapshot for audio thread)
     std::atomic<int> m_sampleRate{44100};
     std::atomic<int> m_channels{2};
@@ -591,12 +730,27 @@ private:
     // Protected by generation counter check - no race with configureRingXXX
     uint32_t m_cachedFormatGen{0};
     bool m_cachedDsdMode{false};
-    bool m_cachedPack24bit{false};
-    bool m_cachedUpsample16to32{false};
-    bool m_cachedUpsample16to24{false};
     int m_cachedChannels{2};
-    int m_cachedBytesPerSample{2};
-    DirettaRingBuffer::DSDConversionMode m_cachedDsdConversionMode{DirettaRingBuffer::DSDConversionMode::Passthrough};
+    bool m_cachedDirectCopy{false};
+
+    // Ring push functions for the current format, resolved once in
+    // configureRingPCM/DSD (see DirettaRingBuffer::selectPCMPush()).
+    // Written under ReconfigureGuard, so no producer is inside sendAudio*()
+    // meanwhile; the producer copies them with the generation.
+    struct PushPaths {
+        DirettaRingBuffer::PushFn send = nullptr;     // sendAudio(): PCM or planar DSD
+        size_t sendFrameBytes = 0;                    // PCM input bytes per frame
+        const char* sendLabel = "PCM";
+        DirettaRingBuffer::PushFn dsdU32 = nullptr;   // sendAudioDSD(), interleaved u32
+        DirettaRingBuffer::PushFn dsdDoP = nullptr;   // sendAudioDSD(), DoP
+    };
+    PushPaths m_pushPaths;
+    PushPaths m_cachedPushPaths;
+
+    // Span the last send*() call added to the ring, for sendConvertedFrom()
+    // (producer only)
+    size_t m_lastPushPos = 0;
+    size_t m_lastPushLen = 0;
 
     // C1: Consumer generation counter for getNewStream fast path
     // Incremented alongside m_formatGeneration in configureRingXXX
@@ -618,11 +772,27 @@ private:
     std::atomic<bool> m_postOnlineDelayDone{false};
     std::atomic<int> m_silenceBuffersRemaining{0};
     std::atomic<int> m_stabilizationCount{0};
+    std::atomic<int> m_prefillWaitCount{0};   // Throttles the verbose prefill log
 
     // Statistics
     std::atomic<int> m_streamCount{0};
     std::atomic<int> m_pushCount{0};
     std::atomic<uint32_t> m_underrunCount{0};
+    std::atomic<uint64_t> m_underrunTotal{0};
+
+    // Hot-path histograms (single writer each: SDK worker or producer)
+    Histogram m_histStreamExec;        // getNewStream() execution, ns
+    Histogram m_histStreamInterval;    // Time between getNewStream() calls, ns
+    Histogram m_histCycleJitter;       // |interval - cycle time|, ns
+    Histogram m_histSendAudio;         // sendAudio*() duration, ns
+    Histogram m_histRingFill;          // Ring fill at each pop, permille
+    std::chrono::steady_clock::time_point m_lastStreamCall{};  // Consumer only
+    std::atomic<uint64_t> m_cycleTimeNs{0};
+    std::atomic<uint32_t> m_statsSampleRate{0};   // m_currentFormat, for writeStatsJson()
+    std::atomic<bool> m_statsDsd{false};
+
+    // Ring size / prefill scale learned from producer jitter
+    BufferTuner m_bufferTuner;
 };
 
 #endif // DIRETTA_SYNC_H
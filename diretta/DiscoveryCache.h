@@ -0,0 +1,169 @@
+/**
+ * @file DiscoveryCache.h
+ * @brief Last discovery result per target selection, optionally on disk
+ *
+ * enable() used to run Find::findOutput() (a network search that waits for
+ * answers) and Find::measSendMTU() (a probe sequence) before anything could
+ * play. Both answers rarely change, so they are remembered per target
+ * selection and the next start connects to the cached target directly;
+ * DirettaSync revalidates in the background and runs a full discovery if
+ * the cached target doesn't answer.
+ *
+ * Keys are the selection ("index 0", as --target), so a different --target
+ * never picks up another target's entry. Values:
+ * - target: identity + firmware, the TargetCache key for the same device
+ * - mtu: effective MTU measured for it
+ * - address: raw bytes of the SDK address, hex encoded. Only address types
+ *   that are trivially copyable can be restored (encodeAddress() fails
+ *   otherwise, and the entry is used for the MTU alone)
+ *
+ * With a path set, entries are loaded once and rewritten (tmp + rename) on
+ * every change. One line per entry:
+ *   <selection>\t<target>\t<mtu>\t<address>
+ */
+
+#ifndef SQUEEZE2DIRETTA_DISCOVERY_CACHE_H
+#define SQUEEZE2DIRETTA_DISCOVERY_CACHE_H
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <string>
+#include <type_traits>
+
+class DiscoveryCache {
+public:
+    struct Entry {
+        std::string target;
+        uint32_t mtu = 0;
+        std::string address;   // Hex; empty if the address could not be encoded
+
+        bool operator==(const Entry& other) const {
+            return target == other.target && mtu == other.mtu && address == other.address;
+        }
+        bool operator!=(const Entry& other) const { return !(*this == other); }
+    };
+
+    /**
+     * @brief Use a backing file (empty = memory only) and load it
+     * @return Entries loaded
+     */
+    size_t open(const std::string& path) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_path = path;
+        m_entries.clear();
+        if (m_path.empty()) return 0;
+
+        std::ifstream in(m_path);
+        std::string line;
+        while (std::getline(in, line)) {
+            size_t t1 = line.find('\t');
+            size_t t2 = t1 == std::string::npos ? t1 : line.find('\t', t1 + 1);
+            size_t t3 = t2 == std::string::npos ? t2 : line.find('\t', t2 + 1);
+            if (t3 == std::string::npos) continue;
+            try {
+                Entry entry;
+                entry.target = line.substr(t1 + 1, t2 - t1 - 1);
+                entry.mtu = static_cast<uint32_t>(std::stoul(line.substr(t2 + 1, t3 - t2 - 1)));
+                entry.address = line.substr(t3 + 1);
+                m_entries[line.substr(0, t1)] = entry;
+            } catch (const std::exception&) {
+                // Skip malformed lines; the entry is re-learned by discovery
+            }
+        }
+        return m_entries.size();
+    }
+
+    bool lookup(const std::string& selection, Entry& entry) const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_entries.find(selection);
+        if (it == m_entries.end()) return false;
+        entry = it->second;
+        return true;
+    }
+
+    /**
+     * @brief Remember a discovery result
+     * @return false if the backing file could not be written
+     */
+    bool store(const std::string& selection, Entry entry) {
+        for (char& c : entry.target) {
+            if (c == '\t' || c == '\n' || c == '\r') c = ' ';
+        }
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto result = m_entries.emplace(selection, entry);
+        if (!result.second) {
+            if (result.first->second == entry) return true;
+            result.first->second = entry;
+        }
+        return save();
+    }
+
+    template<typename Address>
+    static bool encodeAddress(const Address& address, std::string& hex) {
+        hex.clear();
+        if constexpr (std::is_trivially_copyable_v<Address>) {
+            static const char digits[] = "0123456789abcdef";
+            unsigned char bytes[sizeof(Address)];
+            std::memcpy(bytes, &address, sizeof(Address));
+            for (unsigned char b : bytes) {
+                hex += digits[b >> 4];
+                hex += digits[b & 0x0F];
+            }
+            return true;
+        } else {
+            return false;
+        }
+    }
+
+    // false if the entry was written for a different address type
+    template<typename Address>
+    static bool decodeAddress(const std::string& hex, Address& address) {
+        if constexpr (std::is_trivially_copyable_v<Address>) {
+            if (hex.size() != 2 * sizeof(Address)) return false;
+            unsigned char bytes[sizeof(Address)];
+            for (size_t i = 0; i < sizeof(Address); i++) {
+                int hi = hexDigit(hex[2 * i]);
+                int lo = hexDigit(hex[2 * i + 1]);
+                if (hi < 0 || lo < 0) return false;
+                bytes[i] = static_cast<unsigned char>(hi << 4 | lo);
+            }
+            std::memcpy(&address, bytes, sizeof(Address));
+            return true;
+        } else {
+            return false;
+        }
+    }
+
+private:
+    static int hexDigit(char c) {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        return -1;
+    }
+
+    bool save() const {
+        if (m_path.empty()) return true;
+        std::string tmp = m_path + ".tmp";
+        {
+            std::ofstream out(tmp, std::ios::trunc);
+            if (!out) return false;
+            for (const auto& e : m_entries) {
+                out << e.first << '\t' << e.second.target << '\t' << e.second.mtu
+                    << '\t' << e.second.address << '\n';
+            }
+            if (!out.flush()) return false;
+        }
+        return std::rename(tmp.c_str(), m_path.c_str()) == 0;
+    }
+
+    mutable std::mutex m_mutex;
+    std::string m_path;
+    std::map<std::string, Entry> m_entries;
+};
+
+#endif // SQUEEZE2DIRETTA_DISCOVERY_CACHE_H
@@ -0,0 +1,39 @@
+/**
+ * @file Futex.h
+ * @brief Futex wait/wake on a 32-bit atomic
+ *
+ * For threads that park on a word the other side changes: the SDK worker
+ * (DirettaSync) and the --read-ahead pool (ReadAhead.h). Private futexes,
+ * so the word must not be shared across processes.
+ */
+
+#ifndef SQUEEZE2DIRETTA_FUTEX_H
+#define SQUEEZE2DIRETTA_FUTEX_H
+
+#include <atomic>
+#include <climits>
+#include <cstdint>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t) &&
+              std::atomic<uint32_t>::is_always_lock_free,
+              "futex word must be a plain 32-bit integer");
+
+// Returns at once if word != expected; spurious wakeups and timeouts are
+// re-checked by the caller
+inline void futexWait(std::atomic<uint32_t>& word, uint32_t expected,
+                      const struct timespec* timeout = nullptr) {
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAIT_PRIVATE,
+            expected, timeout, nullptr, 0);
+}
+
+// Wakes every waiter
+inline void futexWake(std::atomic<uint32_t>& word) {
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&word), FUTEX_WAKE_PRIVATE,
+            INT_MAX, nullptr, nullptr, 0);
+}
+
+#endif // SQUEEZE2DIRETTA_FUTEX_H
@@ -0,0 +1,132 @@
+/**
+ * @file Histogram.h
+ * @brief Lock-free log-linear histogram for hot-path latency/size stats
+ *
+ * HDR-style bucketing: values below 8 get their own bucket, above that
+ * each power of two is split into 8 linear sub-buckets (~12.5% worst-case
+ * relative error) up to 2^64. 496 buckets, 4 KB per histogram.
+ *
+ * Single writer, any number of readers: record() is a few relaxed loads
+ * and stores (no lock prefix), so it's safe on the SCHED_FIFO worker.
+ * Readers may see a snapshot that is a few samples out of step between
+ * count and buckets, which is fine for monitoring.
+ */
+
+#ifndef SQUEEZE2DIRETTA_HISTOGRAM_H
+#define SQUEEZE2DIRETTA_HISTOGRAM_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+class Histogram {
+public:
+    static constexpr int SUB_BITS = 3;
+    static constexpr int SUB_BUCKETS = 1 << SUB_BITS;
+    static constexpr int BUCKETS = (64 - SUB_BITS + 1) * SUB_BUCKETS;
+
+    void record(uint64_t value) {
+        bump(m_buckets[bucketOf(value)]);
+        bump(m_count);
+        m_sum.store(m_sum.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+        if (value > m_max.load(std::memory_order_relaxed)) {
+            m_max.store(value, std::memory_order_relaxed);
+        }
+    }
+
+    uint64_t count() const { return m_count.load(std::memory_order_relaxed); }
+    uint64_t max() const { return m_max.load(std::memory_order_relaxed); }
+
+    double mean() const {
+        uint64_t n = count();
+        return n ? static_cast<double>(m_sum.load(std::memory_order_relaxed)) / n : 0.0;
+    }
+
+    /**
+     * Value at quantile q (0..1), reported as the upper bound of the bucket
+     * holding it (clamped to the observed max).
+     */
+    uint64_t percentile(double q) const {
+        uint64_t total = 0;
+        for (int i = 0; i < BUCKETS; i++) total += m_buckets[i].load(std::memory_order_relaxed);
+        if (total == 0) return 0;
+
+        uint64_t rank = static_cast<uint64_t>(q * static_cast<double>(total - 1)) + 1;
+        uint64_t seen = 0;
+        for (int i = 0; i < BUCKETS; i++) {
+            seen += m_buckets[i].load(std::memory_order_relaxed);
+            if (seen >= rank) {
+                uint64_t upper = upperBound(i);
+                uint64_t observedMax = max();
+                return upper < observedMax ? upper : observedMax;
+            }
+        }
+        return max();
+    }
+
+    // {"count":N,"mean":x,"p50":..,"p90":..,"p99":..,"p999":..,"max":..}
+    void writeJson(std::ostream& os) const {
+        os << "{\"count\":" << count()
+           << ",\"mean\":" << static_cast<uint64_t>(mean())
+           << ",\"p50\":" << percentile(0.50)
+           << ",\"p90\":" << percentile(0.90)
+           << ",\"p99\":" << percentile(0.99)
+           << ",\"p999\":" << percentile(0.999)
+           << ",\"max\":" << max() << "}";
+    }
+
+    static int bucketOf(uint64_t v) {
+        if (v < SUB_BUCKETS) return static_cast<int>(v);
+        int e = 63 - __builtin_clzll(v);
+        return (e - SUB_BITS + 1) * SUB_BUCKETS +
+               static_cast<int>((v >> (e - SUB_BITS)) & (SUB_BUCKETS - 1));
+    }
+
+    static uint64_t upperBound(int bucket) {
+        if (bucket < SUB_BUCKETS) return static_cast<uint64_t>(bucket);
+        int e = bucket / SUB_BUCKETS + SUB_BITS - 1;
+        uint64_t sub = static_cast<uint64_t>(bucket % SUB_BUCKETS);
+        uint64_t base = (uint64_t(1) << e) | (sub << (e - SUB_BITS));
+        return base + ((uint64_t(1) << (e - SUB_BITS)) - 1);
+    }
+
+private:
+    static void bump(std::atomic<uint64_t>& a) {
+        a.store(a.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    std::atomic<uint64_t> m_buckets[BUCKETS] = {};
+    std::atomic<uint64_t> m_count{0};
+    std::atomic<uint64_t> m_sum{0};
+    std::atomic<uint64_t> m_max{0};
+};
+
+/**
+ * Records the lifetime of the scope in nanoseconds.
+ */
+class HistogramTimer {
+public:
+    explicit HistogramTimer(Histogram& h)
+        : m_hist(h), m_start(std::chrono::steady_clock::now()) {}
+
+    ~HistogramTimer() {
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - m_start).count();
+        m_hist.record(static_cast<uint64_t>(ns) - m_excludedNs);
+    }
+
+    // Leave out time spent outside this stage (e.g. a caller's callback)
+    void exclude(uint64_t ns) { m_excludedNs += ns; }
+
+    HistogramTimer(const HistogramTimer&) = delete;
+    HistogramTimer& operator=(const HistogramTimer&) = delete;
+
+private:
+    Histogram& m_hist;
+    std::chrono::steady_clock::time_point m_start;
+    uint64_t m_excludedNs = 0;
+};
+
+#endif // SQUEEZE2DIRETTA_HISTOGRAM_H
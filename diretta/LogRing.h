@@ -0,0 +1,321 @@
+/**
+ * @file LogRing.h
+ * @brief Allocation-free async logging and counters for hot paths
+ *
+ * DIRETTA_LOG_ASYNC("getNewStream #{} avail={} ({.1}%)", count, avail, pct)
+ * stores the format string pointer and the raw arguments (integers,
+ * doubles, string literals) in a fixed-size entry: no ostringstream, no
+ * heap, no formatting on the producer or the SCHED_FIFO worker.
+ * DIRETTA_COUNT("underrun", 1) adds to a named counter the same way.
+ *
+ * A low-priority drain thread ("sq2d-log", SCHED_OTHER, nice 10) formats
+ * entries to stdout and prints counter totals every COUNTER_REPORT_S
+ * seconds when they changed, and once more at exit.
+ *
+ * The ring is a bounded multi-producer queue (per-cell sequence numbers),
+ * since both the producer thread and the SDK worker log. When it is full
+ * the entry is dropped and counted; the drain thread reports drops.
+ *
+ * Placeholders: {} for any argument, {.N} for a double with N decimals.
+ * String arguments must outlive the drain (literals, static tables).
+ */
+
+#ifndef SQUEEZE2DIRETTA_LOG_RING_H
+#define SQUEEZE2DIRETTA_LOG_RING_H
+
+#include "ThreadTuning.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <sys/resource.h>
+#include <thread>
+#include <type_traits>
+
+struct LogArg {
+    enum Type : uint8_t { Int, Uint, Float, Str };
+    union {
+        int64_t i;
+        uint64_t u;
+        double d;
+        const char* s;
+    };
+};
+
+struct LogEntry {
+    static constexpr size_t MAX_ARGS = 6;
+
+    enum Kind : uint8_t { Message, Counter };
+
+    uint64_t timestamp_ns;      // steady_clock
+    const char* format;         // Message: format string; Counter: counter name
+    Kind kind;
+    uint8_t argc;
+    LogArg::Type types[MAX_ARGS];
+    LogArg args[MAX_ARGS];      // Counter: args[0].i is the delta
+};
+
+class LogRing {
+public:
+    static constexpr size_t CAPACITY = 1024;  // Must be power of 2
+    static constexpr size_t MASK = CAPACITY - 1;
+    static constexpr size_t MAX_COUNTERS = 32;
+    static constexpr int DRAIN_INTERVAL_MS = 50;
+    static constexpr int COUNTER_REPORT_S = 10;
+
+    /**
+     * @param drain Start the drain thread (false: call drain() yourself)
+     */
+    explicit LogRing(bool drain = true)
+        : m_start(std::chrono::steady_clock::now()) {
+        for (size_t i = 0; i < CAPACITY; i++) {
+            m_cells[i].seq.store(i, std::memory_order_relaxed);
+        }
+        if (drain) {
+            m_drainThread = std::thread(&LogRing::drainLoop, this);
+        }
+    }
+
+    ~LogRing() {
+        if (m_drainThread.joinable()) {
+            m_stop.store(true, std::memory_order_release);
+            m_drainThread.join();
+        }
+        drain();
+        reportCounters(true);
+    }
+
+    LogRing(const LogRing&) = delete;
+    LogRing& operator=(const LogRing&) = delete;
+
+    // Lock-free push (returns false if full - message dropped)
+    template<typename... Args>
+    bool log(const char* format, const Args&... args) {
+        static_assert(sizeof...(Args) <= LogEntry::MAX_ARGS, "too many log arguments");
+        size_t pos;
+        Cell* c = claim(pos);
+        if (!c) return false;
+        c->entry.kind = LogEntry::Message;
+        c->entry.format = format;
+        c->entry.argc = 0;
+        (encode(c->entry, args), ...);
+        c->seq.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool count(const char* name, int64_t delta = 1) {
+        size_t pos;
+        Cell* c = claim(pos);
+        if (!c) return false;
+        c->entry.kind = LogEntry::Counter;
+        c->entry.format = name;
+        c->entry.argc = 0;
+        encode(c->entry, delta);
+        c->seq.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Format and print everything queued (drain thread, or the owner when
+     * constructed without one). Single consumer.
+     * @return Entries drained
+     */
+    size_t drain() {
+        size_t n = 0;
+        std::string line;
+        while (true) {
+            Cell& c = m_cells[m_readPos & MASK];
+            if (c.seq.load(std::memory_order_acquire) != m_readPos + 1) break;
+            const LogEntry& e = c.entry;
+            if (e.kind == LogEntry::Counter) {
+                addCounter(e.format, e.args[0].i);
+            } else {
+                formatEntry(e, line);
+                std::cout << line << std::flush;
+            }
+            c.seq.store(m_readPos + CAPACITY, std::memory_order_release);
+            m_readPos++;
+            n++;
+        }
+
+        uint64_t dropped = m_dropped.load(std::memory_order_relaxed);
+        if (dropped != m_droppedReported) {
+            std::cout << "[DirettaSync] (" << dropped - m_droppedReported
+                      << " async log messages dropped)" << std::endl;
+            m_droppedReported = dropped;
+        }
+        return n;
+    }
+
+    uint64_t dropped() const { return m_dropped.load(std::memory_order_relaxed); }
+
+private:
+    struct Cell {
+        std::atomic<size_t> seq;
+        LogEntry entry;
+    };
+
+    // Reserve the next cell; seq = pos + 1 publishes it to the drain
+    Cell* claim(size_t& pos) {
+        pos = m_writePos.load(std::memory_order_relaxed);
+        while (true) {
+            Cell& c = m_cells[pos & MASK];
+            size_t seq = c.seq.load(std::memory_order_acquire);
+            intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (m_writePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    c.entry.timestamp_ns = static_cast<uint64_t>(
+                        std::chrono::duration_cast<std::chrono::nanoseconds>(
+                            std::chrono::steady_clock::now().time_since_epoch()).count());
+                    return &c;
+                }
+            } else if (diff < 0) {
+                m_dropped.fetch_add(1, std::memory_order_relaxed);
+                return nullptr;  // Full, drop
+            } else {
+                pos = m_writePos.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    template<typename T>
+    static void encode(LogEntry& e, const T& value) {
+        LogArg& a = e.args[e.argc];
+        if constexpr (std::is_same_v<T, bool>) {
+            e.types[e.argc] = LogArg::Str;
+            a.s = value ? "true" : "false";
+        } else if constexpr (std::is_enum_v<T>) {
+            e.types[e.argc] = LogArg::Int;
+            a.i = static_cast<int64_t>(value);
+        } else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+            e.types[e.argc] = LogArg::Int;
+            a.i = static_cast<int64_t>(value);
+        } else if constexpr (std::is_integral_v<T>) {
+            e.types[e.argc] = LogArg::Uint;
+            a.u = static_cast<uint64_t>(value);
+        } else if constexpr (std::is_floating_point_v<T>) {
+            e.types[e.argc] = LogArg::Float;
+            a.d = static_cast<double>(value);
+        } else {
+            static_assert(std::is_convertible_v<T, const char*>,
+                          "async log arguments: integers, floats, or static strings");
+            e.types[e.argc] = LogArg::Str;
+            a.s = value;
+        }
+        e.argc++;
+    }
+
+    void formatEntry(const LogEntry& e, std::string& out) const {
+        char num[64];
+        double t = static_cast<double>(e.timestamp_ns - startNs()) / 1e9;
+        std::snprintf(num, sizeof(num), "[DirettaSync] [%.6f] ", t);
+        out = num;
+
+        size_t next = 0;
+        for (const char* p = e.format; *p; p++) {
+            if (*p != '{') {
+                out += *p;
+                continue;
+            }
+            const char* close = p + 1;
+            while (*close && *close != '}') close++;
+            if (!*close) {
+                out += p;
+                break;
+            }
+
+            int precision = -1;
+            if (p[1] == '.') precision = std::atoi(p + 2);
+            if (next < e.argc) {
+                const LogArg& a = e.args[next];
+                switch (e.types[next]) {
+                    case LogArg::Int: std::snprintf(num, sizeof(num), "%lld", static_cast<long long>(a.i)); break;
+                    case LogArg::Uint: std::snprintf(num, sizeof(num), "%llu", static_cast<unsigned long long>(a.u)); break;
+                    case LogArg::Float: std::snprintf(num, sizeof(num), "%.*f", precision >= 0 ? precision : 3, a.d); break;
+                    case LogArg::Str: num[0] = '\0'; out += a.s ? a.s : "(null)"; break;
+                }
+                out += num;
+                next++;
+            }
+            p = close;
+        }
+        out += '\n';
+    }
+
+    void addCounter(const char* name, int64_t delta) {
+        for (size_t i = 0; i < m_counterCount; i++) {
+            // Same literal from different translation units need not
+            // share an address
+            if (std::strcmp(m_counters[i].name, name) == 0) {
+                m_counters[i].total += delta;
+                m_countersChanged = true;
+                return;
+            }
+        }
+        if (m_counterCount < MAX_COUNTERS) {
+            m_counters[m_counterCount++] = { name, delta };
+            m_countersChanged = true;
+        }
+    }
+
+    void reportCounters(bool final) {
+        if (!m_countersChanged || m_counterCount == 0) return;
+        std::string line = final ? "[DirettaSync] Counters (final):" : "[DirettaSync] Counters:";
+        for (size_t i = 0; i < m_counterCount; i++) {
+            line += ' ';
+            line += m_counters[i].name;
+            line += '=';
+            line += std::to_string(m_counters[i].total);
+        }
+        std::cout << line << std::endl;
+        m_countersChanged = false;
+    }
+
+    uint64_t startNs() const {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            m_start.time_since_epoch()).count());
+    }
+
+    void drainLoop() {
+        ThreadTuning tuning;
+        tuning.policy = SchedPolicy::Other;
+        tuning.priority = 0;
+        applyThreadTuning("sq2d-log", "Log drain", tuning);
+        setpriority(PRIO_PROCESS, 0, 10);  // Linux: the calling thread
+
+        auto lastReport = std::chrono::steady_clock::now();
+        while (!m_stop.load(std::memory_order_acquire)) {
+            drain();
+            auto now = std::chrono::steady_clock::now();
+            if (now - lastReport >= std::chrono::seconds(COUNTER_REPORT_S)) {
+                reportCounters(false);
+                lastReport = now;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(DRAIN_INTERVAL_MS));
+        }
+    }
+
+    struct CounterTotal {
+        const char* name;
+        int64_t total;
+    };
+
+    Cell m_cells[CAPACITY];
+    alignas(64) std::atomic<size_t> m_writePos{0};
+    alignas(64) size_t m_readPos = 0;    // Drain only
+    std::atomic<uint64_t> m_dropped{0};
+    uint64_t m_droppedReported = 0;
+    CounterTotal m_counters[MAX_COUNTERS] = {};
+    size_t m_counterCount = 0;
+    bool m_countersChanged = false;
+    std::chrono::steady_clock::time_point m_start;
+    std::atomic<bool> m_stop{false};
+    std::thread m_drainThread;
+};
+
+#endif // SQUEEZE2DIRETTA_LOG_RING_H
@@ -0,0 +1,48 @@
+/**
+ * @file RealtimeMemory.h
+ * @brief Process-wide memory locking for the realtime mode (--rt-memory)
+ *
+ * lockProcessMemory() is called once at startup, before DirettaSync and
+ * its threads exist:
+ * - mlockall(MCL_CURRENT | MCL_FUTURE): everything mapped now or later
+ *   (ring storage, thread stacks, SDK allocations) is resident and stays
+ *   resident, so the first cycle after a format change cannot page fault
+ * - malloc never trims the heap back to the kernel or serves large blocks
+ *   from mmap, so a later free()/malloc() pair doesn't fault either
+ *
+ * Needs a large enough RLIMIT_MEMLOCK (LimitMEMLOCK=infinity in the
+ * systemd unit) or CAP_IPC_LOCK.
+ */
+
+#ifndef SQUEEZE2DIRETTA_REALTIME_MEMORY_H
+#define SQUEEZE2DIRETTA_REALTIME_MEMORY_H
+
+#include <alloca.h>
+#include <cerrno>
+#include <cstddef>
+#include <malloc.h>
+#include <sys/mman.h>
+
+/**
+ * @return 0 on success, else the mlockall() errno (malloc tuning still applies)
+ */
+inline int lockProcessMemory() {
+    mallopt(M_TRIM_THRESHOLD, -1);
+    mallopt(M_MMAP_MAX, 0);
+    return mlockall(MCL_CURRENT | MCL_FUTURE) == 0 ? 0 : errno;
+}
+
+/**
+ * @brief Fault in the calling thread's stack below this frame
+ *
+ * MCL_FUTURE populates stacks of threads created later; the main thread's
+ * stack grows on demand and needs touching once.
+ */
+__attribute__((noinline)) inline void prefaultStack(size_t bytes = 256 * 1024) {
+    volatile unsigned char* stack = static_cast<volatile unsigned char*>(alloca(bytes));
+    for (size_t i = 0; i < bytes; i += 4096) {
+        stack[i] = 0;
+    }
+}
+
+#endif // SQUEEZE2DIRETTA_REALTIME_MEMORY_H
@@ -0,0 +1,121 @@
+/**
+ * @file TargetCache.h
+ * @brief Per-target memory of negotiated sink formats, optionally on disk
+ *
+ * configureSinkPCM()/configureSinkDSD() walk a preference list of sink
+ * formats (32 -> 24 -> 16 bit, four DSD bit orders/endiannesses) with
+ * checkSinkSupport() until the target accepts one. The answer only depends
+ * on the target and its firmware, so it is remembered here and the next
+ * open() of the same stream format goes straight to setSinkConfigure().
+ *
+ * Keys are opaque strings:
+ * - target: identity + firmware from discovery (see DirettaSync::discoverTarget())
+ * - format: stream family, rate and channels ("pcm:44100:2")
+ * The value is the index of the accepted entry in the caller's preference
+ * list (PCM: bit depth).
+ *
+ * With a path set, entries are loaded once and rewritten (tmp + rename) on
+ * every new entry, so a restart skips the probes too. One line per entry:
+ *   <target>\t<format>\t<choice>
+ */
+
+#ifndef SQUEEZE2DIRETTA_TARGET_CACHE_H
+#define SQUEEZE2DIRETTA_TARGET_CACHE_H
+
+#include <cstdio>
+#include <exception>
+#include <fstream>
+#include <initializer_list>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+
+class TargetCache {
+public:
+    /**
+     * @brief Use a backing file (empty = memory only) and load it
+     * @return Entries loaded
+     */
+    size_t open(const std::string& path) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_path = path;
+        m_entries.clear();
+        if (m_path.empty()) return 0;
+
+        std::ifstream in(m_path);
+        std::string line;
+        while (std::getline(in, line)) {
+            size_t t1 = line.find('\t');
+            size_t t2 = t1 == std::string::npos ? t1 : line.find('\t', t1 + 1);
+            if (t2 == std::string::npos) continue;
+            try {
+                int choice = std::stoi(line.substr(t2 + 1));
+                m_entries[{line.substr(0, t1), line.substr(t1 + 1, t2 - t1 - 1)}] = choice;
+            } catch (const std::exception&) {
+                // Skip malformed lines; the entry is re-learned by probing
+            }
+        }
+        return m_entries.size();
+    }
+
+    bool lookup(const std::string& target, const std::string& format, int& choice) const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto it = m_entries.find(key(target, format));
+        if (it == m_entries.end()) return false;
+        choice = it->second;
+        return true;
+    }
+
+    /**
+     * @brief Remember an accepted format
+     * @return false if the backing file could not be written
+     */
+    bool store(const std::string& target, const std::string& format, int choice) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto result = m_entries.emplace(key(target, format), choice);
+        if (!result.second) {
+            if (result.first->second == choice) return true;
+            result.first->second = choice;
+        }
+        return save();
+    }
+
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_entries.size();
+    }
+
+private:
+    using Key = std::pair<std::string, std::string>;
+
+    // Keys must survive the one-line-per-entry file format
+    static Key key(std::string target, std::string format) {
+        for (std::string* s : {&target, &format}) {
+            for (char& c : *s) {
+                if (c == '\t' || c == '\n' || c == '\r') c = ' ';
+            }
+        }
+        return {std::move(target), std::move(format)};
+    }
+
+    bool save() const {
+        if (m_path.empty()) return true;
+        std::string tmp = m_path + ".tmp";
+        {
+            std::ofstream out(tmp, std::ios::trunc);
+            if (!out) return false;
+            for (const auto& e : m_entries) {
+                out << e.first.first << '\t' << e.first.second << '\t' << e.second << '\n';
+            }
+            if (!out.flush()) return false;
+        }
+        return std::rename(tmp.c_str(), m_path.c_str()) == 0;
+    }
+
+    mutable std::mutex m_mutex;
+    std::string m_path;
+    std::map<Key, int> m_entries;
+};
+
+#endif // SQUEEZE2DIRETTA_TARGET_CACHE_H
@@ -0,0 +1,185 @@
+/**
+ * @file ThreadTuning.h
+ * @brief Name, CPU pinning and scheduling policy for our own threads
+ *
+ * Applied by each thread to itself when it starts (SDK worker in
+ * DirettaSync::startSyncWorker(), producer in the wrapper's main loop), so
+ * threads created after startup are covered too - unlike pinning by TID
+ * from squeeze2diretta-tuner.sh.
+ *
+ * SCHED_DEADLINE needs a period (the worker uses the cycle time in effect
+ * and follows it across format changes, see updateDeadlinePeriod()) and, on
+ * most kernels, an affinity covering the whole root domain; if the kernel
+ * refuses it the thread falls back to SCHED_FIFO.
+ */
+
+#ifndef SQUEEZE2DIRETTA_THREAD_TUNING_H
+#define SQUEEZE2DIRETTA_THREAD_TUNING_H
+
+#include "LogLevel.h"
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <pthread.h>
+#include <sched.h>
+#include <string>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#ifndef SCHED_DEADLINE
+#define SCHED_DEADLINE 6
+#endif
+
+enum class SchedPolicy { Other, FIFO, RR, Deadline };
+
+struct ThreadTuning {
+    int cpu = -1;                        // -1 = leave affinity alone
+    SchedPolicy policy = SchedPolicy::FIFO;
+    int priority = 50;                   // FIFO/RR; 0 = leave the policy alone
+    unsigned int deadlinePeriodUs = 0;   // Deadline: period (runtime = half of it)
+    bool warnOnFailure = false;          // Set when the user asked for these settings
+};
+
+inline bool parseSchedPolicy(const std::string& name, SchedPolicy& policy) {
+    if (name == "fifo") policy = SchedPolicy::FIFO;
+    else if (name == "rr") policy = SchedPolicy::RR;
+    else if (name == "deadline") policy = SchedPolicy::Deadline;
+    else if (name == "other") policy = SchedPolicy::Other;
+    else return false;
+    return true;
+}
+
+inline const char* schedPolicyName(SchedPolicy policy) {
+    switch (policy) {
+        case SchedPolicy::FIFO: return "SCHED_FIFO";
+        case SchedPolicy::RR: return "SCHED_RR";
+        case SchedPolicy::Deadline: return "SCHED_DEADLINE";
+        default: return "SCHED_OTHER";
+    }
+}
+
+namespace thread_tuning_detail {
+
+// struct sched_attr from the kernel UAPI (not in every libc)
+struct SchedAttr {
+    uint32_t size;
+    uint32_t sched_policy;
+    uint64_t sched_flags;
+    int32_t sched_nice;
+    uint32_t sched_priority;
+    uint64_t sched_runtime;    // ns
+    uint64_t sched_deadline;
+    uint64_t sched_period;
+};
+
+inline int setDeadline(unsigned int periodUs) {
+    SchedAttr attr{};
+    attr.size = sizeof(attr);
+    attr.sched_policy = SCHED_DEADLINE;
+    attr.sched_period = static_cast<uint64_t>(periodUs) * 1000;
+    attr.sched_deadline = attr.sched_period;
+    attr.sched_runtime = attr.sched_period / 2;
+    return syscall(SYS_sched_setattr, 0, &attr, 0) == 0 ? 0 : errno;
+}
+
+inline int setPolicy(int policy, int priority) {
+    struct sched_param param;
+    param.sched_priority = priority;
+    return pthread_setschedparam(pthread_self(), policy, &param);
+}
+
+} // namespace thread_tuning_detail
+
+/**
+ * @brief Apply name, affinity and policy to the calling thread
+ * @param name Thread name for ps/top (truncated to 15 characters), or
+ *             nullptr to keep it - renaming the main thread renames the
+ *             process for ps, pgrep and systemd
+ * @param label Prefix for log messages
+ * @return false if any requested setting failed (the thread keeps running)
+ */
+inline bool applyThreadTuning(const char* name, const char* label, const ThreadTuning& t) {
+    using namespace thread_tuning_detail;
+
+    if (name) {
+        char shortName[16];
+        std::strncpy(shortName, name, sizeof(shortName) - 1);
+        shortName[sizeof(shortName) - 1] = '\0';
+        pthread_setname_np(pthread_self(), shortName);
+    }
+
+    // Not fatal - may not have CAP_SYS_NICE, or the CPU may not exist
+    bool ok = true;
+    auto fail = [&](const std::string& what, int err) {
+        ok = false;
+        if (t.warnOnFailure || g_logLevel >= LogLevel::DEBUG) {
+            LOG_WARN("[" << label << "] Could not set " << what << " (" << std::strerror(err) << ")");
+        }
+    };
+
+    if (t.cpu >= 0) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(t.cpu, &set);
+        int ret = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+        if (ret != 0) {
+            fail("CPU " + std::to_string(t.cpu), ret);
+        } else {
+            LOG_DEBUG("[" << label << "] Pinned to CPU " << t.cpu);
+        }
+    }
+
+    if (t.priority <= 0 && t.policy != SchedPolicy::Deadline && t.policy != SchedPolicy::Other) {
+        return ok;
+    }
+
+    SchedPolicy applied = t.policy;
+    int ret = 0;
+    switch (t.policy) {
+        case SchedPolicy::Deadline:
+            ret = t.deadlinePeriodUs > 0 ? setDeadline(t.deadlinePeriodUs) : EINVAL;
+            if (ret == 0) break;
+            fail("SCHED_DEADLINE", ret);
+            applied = SchedPolicy::FIFO;
+            ret = setPolicy(SCHED_FIFO, t.priority > 0 ? t.priority : 50);
+            break;
+        case SchedPolicy::RR:
+            ret = setPolicy(SCHED_RR, t.priority);
+            break;
+        case SchedPolicy::Other:
+            ret = setPolicy(SCHED_OTHER, 0);
+            break;
+        default:
+            ret = setPolicy(SCHED_FIFO, t.priority);
+            break;
+    }
+
+    if (ret != 0) {
+        fail(std::string(schedPolicyName(applied)) + " priority " + std::to_string(t.priority), ret);
+    } else if (applied == SchedPolicy::Deadline) {
+        LOG_DEBUG("[" << label << "] SCHED_DEADLINE period " << t.deadlinePeriodUs << "us");
+    } else {
+        LOG_DEBUG("[" << label << "] " << schedPolicyName(applied) << " priority " << t.priority);
+    }
+    return ok;
+}
+
+/**
+ * @brief Change the period of the calling thread if it runs SCHED_DEADLINE
+ * @return false if it doesn't (never requested, or fell back to SCHED_FIFO)
+ *         or the kernel refused the new period
+ */
+inline bool updateDeadlinePeriod(const char* label, unsigned int periodUs) {
+    if (sched_getscheduler(0) != SCHED_DEADLINE) return false;
+    int ret = thread_tuning_detail::setDeadline(periodUs);
+    if (ret != 0) {
+        LOG_WARN("[" << label << "] Could not set SCHED_DEADLINE period " << periodUs << "us ("
+                 << std::strerror(ret) << ")");
+        return false;
+    }
+    LOG_DEBUG("[" << label << "] SCHED_DEADLINE period " << periodUs << "us");
+    return true;
+}
+
+#endif // SQUEEZE2DIRETTA_THREAD_TUNING_H
@@ -0,0 +1,29 @@
+/**
+ * @file Clock.hpp
+ * @brief Replay mock of ACQUA::Clock (cycle time carrier)
+ */
+
+#ifndef SQUEEZE2DIRETTA_MOCK_ACQUA_CLOCK_HPP
+#define SQUEEZE2DIRETTA_MOCK_ACQUA_CLOCK_HPP
+
+#include <cstdint>
+
+namespace ACQUA {
+
+class Clock {
+public:
+    static Clock MicroSeconds(int64_t us) {
+        Clock c;
+        c.m_us = us;
+        return c;
+    }
+
+    int64_t microSeconds() const { return m_us; }
+
+private:
+    int64_t m_us = 0;
+};
+
+} // namespace ACQUA
+
+#endif // SQUEEZE2DIRETTA_MOCK_ACQUA_CLOCK_HPP
@@ -0,0 +1,32 @@
+/**
+ * @file IPAddress.hpp
+ * @brief Replay mock of ACQUA::IPAddress (opaque target key)
+ *
+ * Fixed-size and trivially copyable like a socket address, so the
+ * discovery cache can persist it.
+ */
+
+#ifndef SQUEEZE2DIRETTA_MOCK_ACQUA_IPADDRESS_HPP
+#define SQUEEZE2DIRETTA_MOCK_ACQUA_IPADDRESS_HPP
+
+#include <cstring>
+
+namespace ACQUA {
+
+class IPAddress {
+public:
+    IPAddress() = default;
+    explicit IPAddress(const char* addr) {
+        std::strncpy(m_addr, addr, sizeof(m_addr) - 1);
+    }
+
+    bool operator<(const IPAddress& other) const { return std::strcmp(m_addr, other.m_addr) < 0; }
+    bool operator==(const IPAddress& other) const { return std::strcmp(m_addr, other.m_addr) == 0; }
+
+private:
+    char m_addr[28] = {};
+};
+
+} // namespace ACQUA
+
+#endif // SQUEEZE2DIRETTA_MOCK_ACQUA_IPADDRESS_HPP
@@ -0,0 +1,59 @@
+/**
+ * @file Find.hpp
+ * @brief Replay mock of DIRETTA::Find: one simulated target, fixed MTU
+ */
+
+#ifndef SQUEEZE2DIRETTA_MOCK_FIND_HPP
+#define SQUEEZE2DIRETTA_MOCK_FIND_HPP
+
+#include "Sync.hpp"
+
+#include <cstdint>
+#include <map>
+#include <string>
+
+namespace DIRETTA {
+
+class Find {
+public:
+    struct Setting {
+        bool Loopback = false;
+        uint32_t ProductID = 0;
+        std::string Name;
+        uint32_t MyID = 0;
+    };
+
+    struct Info {
+        std::string targetName;
+        std::string outputName;
+        std::string config;
+        std::string version;
+        int PI = 0;
+        int PO = 0;
+        bool multiport = false;
+        uint32_t productID = 0;
+    };
+
+    using PortResalts = std::map<ACQUA::IPAddress, Info>;
+
+    explicit Find(const Setting&) {}
+
+    bool open() { return true; }
+    void close() {}
+
+    bool findOutput(PortResalts& results) {
+        Info& info = results[mockTargetAddress()];
+        info.targetName = "Replay mock sink";
+        info.version = "mock";
+        return true;
+    }
+
+    bool measSendMTU(const ACQUA::IPAddress&, uint32_t& mtu) {
+        mtu = mockSinkConfig().mtu;
+        return true;
+    }
+};
+
+} // namespace DIRETTA
+
+#endif // SQUEEZE2DIRETTA_MOCK_FIND_HPP
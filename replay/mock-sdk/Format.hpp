@@ -0,0 +1,43 @@
+/**
+ * @file Format.hpp
+ * @brief Replay mock of the Diretta SDK format descriptors
+ */
+
+#ifndef SQUEEZE2DIRETTA_MOCK_FORMAT_HPP
+#define SQUEEZE2DIRETTA_MOCK_FORMAT_HPP
+
+#include <cstdint>
+
+namespace DIRETTA {
+
+namespace FormatID {
+    constexpr uint32_t FMT_PCM_SIGNED_16 = 1u << 0;
+    constexpr uint32_t FMT_PCM_SIGNED_24 = 1u << 1;
+    constexpr uint32_t FMT_PCM_SIGNED_32 = 1u << 2;
+    constexpr uint32_t FMT_DSD1          = 1u << 8;
+    constexpr uint32_t FMT_DSD_SIZ_32    = 1u << 9;
+    constexpr uint32_t FMT_DSD_LSB       = 1u << 10;
+    constexpr uint32_t FMT_DSD_MSB       = 1u << 11;
+    constexpr uint32_t FMT_DSD_BIG       = 1u << 12;
+    constexpr uint32_t FMT_DSD_LITTLE    = 1u << 13;
+}
+
+class FormatConfigure {
+public:
+    void setSpeed(uint32_t speed) { m_speed = speed; }
+    void setChannel(int channels) { m_channels = channels; }
+    void setFormat(uint32_t format) { m_format = format; }
+
+    uint32_t speed() const { return m_speed; }
+    int channels() const { return m_channels; }
+    uint32_t format() const { return m_format; }
+
+private:
+    uint32_t m_speed = 0;
+    int m_channels = 0;
+    uint32_t m_format = 0;
+};
+
+} // namespace DIRETTA
+
+#endif // SQUEEZE2DIRETTA_MOCK_FORMAT_HPP
@@ -0,0 +1,9 @@
+/**
+ * @file Profile.hpp
+ * @brief Replay mock: DirettaSync includes this but uses nothing from it
+ */
+
+#ifndef SQUEEZE2DIRETTA_MOCK_PROFILE_HPP
+#define SQUEEZE2DIRETTA_MOCK_PROFILE_HPP
+
+#endif // SQUEEZE2DIRETTA_MOCK_PROFILE_HPP
@@ -0,0 +1,21 @@
+/**
+ * @file Stream.hpp
+ * @brief Replay mock of the Diretta SDK stream descriptor
+ *
+ * Only what DirettaSync touches: getNewStream() points Data.P at its own
+ * buffer and sets Size.
+ */
+
+#ifndef SQUEEZE2DIRETTA_MOCK_STREAM_HPP
+#define SQUEEZE2DIRETTA_MOCK_STREAM_HPP
+
+#include <cstddef>
+
+struct diretta_stream {
+    union {
+        void* P;
+    } Data;
+    size_t Size;
+};
+
+#endif // SQUEEZE2DIRETTA_MOCK_STREAM_HPP
@@ -0,0 +1,219 @@
+/**
+ * @file Sync.hpp
+ * @brief Replay mock of DIRETTA::Sync, clocked like a real target
+ *
+ * Implements the subset of the SDK that DirettaSync uses, with no network:
+ * syncWorker() pulls buffers through getNewStream() at the sink's sample
+ * clock - each buffer is due once the previous one has played out at the
+ * configured PCM/DSD rate - as the SDK worker does for a real target.
+ * Until a sink format is configured, the cycle time is used instead.
+ * Sink capabilities come from mockSinkConfig().
+ *
+ * Used by squeeze2diretta-replay only; never linked into squeeze2diretta.
+ */
+
+#ifndef SQUEEZE2DIRETTA_MOCK_SYNC_HPP
+#define SQUEEZE2DIRETTA_MOCK_SYNC_HPP
+
+#include "Stream.hpp"
+#include "Format.hpp"
+#include "ACQUA/IPAddress.hpp"
+#include "ACQUA/Clock.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+namespace DIRETTA {
+
+// Simulated target capabilities, set by the replay tool before enable()
+struct MockSinkConfig {
+    uint32_t mtu = 1500;
+    int maxPcmBits = 32;    // Widest PCM sample accepted (32, 24 or 16)
+    uint32_t dsdFormat = FormatID::FMT_DSD1 | FormatID::FMT_DSD_SIZ_32 |
+                         FormatID::FMT_DSD_LSB | FormatID::FMT_DSD_BIG;  // 0 = PCM only
+};
+
+inline MockSinkConfig& mockSinkConfig() {
+    static MockSinkConfig config;
+    return config;
+}
+
+// The one target Find reports
+inline const ACQUA::IPAddress& mockTargetAddress() {
+    static const ACQUA::IPAddress address("replay");
+    return address;
+}
+
+class SinkInfo {
+public:
+    bool checkSinkSupportPCM() const { return true; }
+    bool checkSinkSupportDSD() const { return mockSinkConfig().dsdFormat != 0; }
+    bool checkSinkSupportDSDlsb() const { return mockSinkConfig().dsdFormat & FormatID::FMT_DSD_LSB; }
+    bool checkSinkSupportDSDmsb() const { return mockSinkConfig().dsdFormat & FormatID::FMT_DSD_MSB; }
+
+    uint16_t supportMSmode = 0x04;  // MS3
+};
+
+class Sync {
+public:
+    enum THRED_MODE { THRED_MODE_DEFAULT = 1 };
+    enum MSMODE { MSMODE_MS1 = 1, MSMODE_MS3 = 4 };
+
+    virtual ~Sync() = default;
+
+    // Cycles the worker started more than one cycle late, buffers pulled,
+    // and checkSinkSupport() round trips
+    struct MockStats {
+        uint64_t cycles;
+        uint64_t lateCycles;
+        uint64_t bytes;
+        uint64_t sinkProbes;
+    };
+
+    MockStats mockStats() const {
+        return { m_cycles.load(std::memory_order_relaxed),
+                 m_lateCycles.load(std::memory_order_relaxed),
+                 m_bytes.load(std::memory_order_relaxed),
+                 m_sinkProbes.load(std::memory_order_relaxed) };
+    }
+
+protected:
+    bool open(THRED_MODE, ACQUA::Clock cycleTime, int, const char*, uint32_t,
+              int, int, int, MSMODE) {
+        setCycle(cycleTime);
+        return startSyncWorker();
+    }
+
+    void close() {
+        m_playing.store(false, std::memory_order_release);
+        m_connected = false;
+    }
+
+    // Only the simulated target answers (a stale cached address doesn't)
+    bool setSink(const ACQUA::IPAddress& address, ACQUA::Clock cycleTime, bool, uint32_t) {
+        if (!(address == mockTargetAddress())) return false;
+        setCycle(cycleTime);
+        return true;
+    }
+
+    void inquirySupportFormat(const ACQUA::IPAddress&) {}
+    const SinkInfo& getSinkInfo() const { return m_sinkInfo; }
+
+    bool checkSinkSupport(const FormatConfigure& fmt) const {
+        m_sinkProbes.fetch_add(1, std::memory_order_relaxed);
+        const MockSinkConfig& sink = mockSinkConfig();
+        switch (fmt.format()) {
+            case FormatID::FMT_PCM_SIGNED_32: return sink.maxPcmBits >= 32;
+            case FormatID::FMT_PCM_SIGNED_24: return sink.maxPcmBits >= 24;
+            case FormatID::FMT_PCM_SIGNED_16: return true;
+            default: return sink.dsdFormat != 0 && fmt.format() == sink.dsdFormat;
+        }
+    }
+
+    void setSinkConfigure(const FormatConfigure& fmt) {
+        uint64_t bytesPerSecond = 0;
+        switch (fmt.format()) {
+            case FormatID::FMT_PCM_SIGNED_32: bytesPerSecond = uint64_t(fmt.speed()) * fmt.channels() * 4; break;
+            case FormatID::FMT_PCM_SIGNED_24: bytesPerSecond = uint64_t(fmt.speed()) * fmt.channels() * 3; break;
+            case FormatID::FMT_PCM_SIGNED_16: bytesPerSecond = uint64_t(fmt.speed()) * fmt.channels() * 2; break;
+            default: bytesPerSecond = uint64_t(fmt.speed()) * fmt.channels() / 8; break;  // DSD bit rate
+        }
+        m_bytesPerSecond.store(bytesPerSecond, std::memory_order_relaxed);
+    }
+
+    bool connectPrepare() { return true; }
+    bool connect(int) { return true; }
+    bool connectWait() {
+        m_connected = true;
+        return true;
+    }
+
+    void disconnect(bool = false) {
+        m_playing.store(false, std::memory_order_release);
+        m_connected = false;
+    }
+
+    void play() { m_playing.store(true, std::memory_order_release); }
+
+    void stop() { m_playing.store(false, std::memory_order_release); }
+
+    bool is_online() { return m_playing.load(std::memory_order_acquire); }
+
+    void configTransferVarAuto(ACQUA::Clock cycleTime) { setCycle(cycleTime); }
+    void configTransferVarMax(ACQUA::Clock cycleTime) { setCycle(cycleTime); }
+    void configTransferFixAuto(ACQUA::Clock cycleTime) { setCycle(cycleTime); }
+
+    /**
+     * One worker iteration: wait until the next buffer is due, then pull
+     * it. A worker that falls more than a cycle behind is counted late and
+     * resynchronised rather than bursting to catch up.
+     */
+    bool syncWorker() {
+        auto cycle = std::chrono::microseconds(m_cycleUs.load(std::memory_order_relaxed));
+        if (!m_playing.load(std::memory_order_acquire)) {
+            m_wasPlaying = false;
+            std::this_thread::sleep_for(cycle);
+            return true;
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        if (!m_wasPlaying) {
+            m_wasPlaying = true;
+            m_nextCycle = now;
+        }
+        if (now < m_nextCycle) {
+            std::this_thread::sleep_until(m_nextCycle);
+        } else if (now - m_nextCycle > cycle) {
+            m_lateCycles.fetch_add(1, std::memory_order_relaxed);
+            m_nextCycle = now;
+        }
+
+        diretta_stream stream;
+        stream.Data.P = nullptr;
+        stream.Size = 0;
+        if (!getNewStream(stream)) {
+            m_nextCycle += cycle;
+            return false;
+        }
+
+        uint64_t bytesPerSecond = m_bytesPerSecond.load(std::memory_order_relaxed);
+        if (bytesPerSecond > 0 && stream.Size > 0) {
+            m_nextCycle += std::chrono::nanoseconds(stream.Size * 1000000000ULL / bytesPerSecond);
+        } else {
+            m_nextCycle += cycle;
+        }
+
+        m_cycles.fetch_add(1, std::memory_order_relaxed);
+        m_bytes.fetch_add(stream.Size, std::memory_order_relaxed);
+        return true;
+    }
+
+    virtual bool getNewStream(diretta_stream& stream) = 0;
+    virtual bool getNewStreamCmp() { return true; }
+    virtual bool startSyncWorker() { return true; }
+    virtual void statusUpdate() {}
+
+private:
+    void setCycle(ACQUA::Clock cycleTime) {
+        int64_t us = cycleTime.microSeconds();
+        if (us > 0) m_cycleUs.store(us, std::memory_order_relaxed);
+    }
+
+    SinkInfo m_sinkInfo;
+    bool m_connected = false;
+    std::atomic<uint64_t> m_bytesPerSecond{0};
+    std::atomic<bool> m_playing{false};
+    std::atomic<int64_t> m_cycleUs{1000};
+    std::chrono::steady_clock::time_point m_nextCycle{};  // Worker thread only
+    bool m_wasPlaying = false;                            // Worker thread only
+    std::atomic<uint64_t> m_cycles{0};
+    std::atomic<uint64_t> m_lateCycles{0};
+    std::atomic<uint64_t> m_bytes{0};
+    mutable std::atomic<uint64_t> m_sinkProbes{0};
+};
+
+} // namespace DIRETTA
+
+#endif // SQUEEZE2DIRETTA_MOCK_SYNC_HPP
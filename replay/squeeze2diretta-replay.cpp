@@ -0,0 +1,500 @@
+/**
+ * @file squeeze2diretta-replay.cpp
+ * @brief Offline replay of a recorded squeezelite stream through DirettaSync
+ *
+ * Feeds a capture made with `squeeze2diretta --record <file>` through the
+ * same StreamPipeline as the wrapper (PipeReader -> conversion ->
+ * DirettaSync::sendAudio*() -> getNewStream()), against a mock
+ * DIRETTA::Sync (replay/mock-sdk) that pulls one buffer per cycle at the
+ * cycle time DirettaSync computes. No LMS, network or DAC involved, so
+ * format transitions (PCM<->DSD, 44.1k<->48k families) can be reproduced
+ * on the bench.
+ *
+ * With --push the capture is instead handed to the pipeline's push-model
+ * entry points (onFormat() / onAudio()) in fixed-size blocks, the way an
+ * in-process decoder's output callback would.
+ *
+ * With --fanout the stream plays on several mock targets at once, as the
+ * wrapper's --target 1,2,... does.
+ *
+ * Several captures are replayed as successive squeezelite processes: the
+ * pipeline is supervised and reattached to the next one at each end of
+ * stream, as the wrapper does when it restarts a crashed squeezelite.
+ *
+ * Runs in real time and reports underruns, late worker cycles, format
+ * switch times, ring fill, and CPU time per second of audio.
+ *
+ *   cmake --build build --target squeeze2diretta-replay
+ *   ./build/squeeze2diretta-replay --fill-csv fill.csv capture.sqfh
+ */
+
+#include "DirettaSync.h"
+#include "globals.h"
+#include "PipeReader.h"
+#include "RealtimeMemory.h"
+#include "StreamPipeline.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <signal.h>
+#include <string>
+#include <sys/resource.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+// ================================================================
+// Configuration
+// ================================================================
+struct ReplayConfig {
+    std::vector<std::string> input_paths;  // One per squeezelite process
+    std::string fill_csv;                // Ring fill samples, one per interval
+    int sample_format = 32;              // -a, for headers without a PCM bit_depth
+    unsigned int mtu = 1500;
+    unsigned int cycle_time = 0;         // 0 = auto, as the wrapper
+    int low_water = 70;
+    int high_water = 75;
+    bool zero_copy = true;
+    bool adaptive_buffer = true;
+    int sink_pcm_bits = 32;
+    std::string sink_dsd = "lsb-big";
+    std::string sink_cache;              // --sink-cache, as the wrapper
+    std::string discovery_cache;         // --discovery-cache, as the wrapper
+    bool rt_memory = false;
+    bool huge_pages = false;
+    int read_ahead_kb = 0;               // --read-ahead, as the wrapper
+    int push_bytes = 0;                  // --push: callback block size, 0 = pipe model
+    double idle_timeout = 0.0;           // --idle-timeout, as the wrapper
+    int fanout = 1;                      // Mock targets fed from the stream
+    bool json = false;
+    bool verbose = false;
+    bool quiet = false;
+};
+
+static std::atomic<bool> running{true};
+
+static void signal_handler(int /*sig*/) {
+    running = false;
+}
+
+static void print_usage(const char* prog) {
+    std::cout << "Usage: " << prog << " [options] <recording> [<recording>...]" << std::endl;
+    std::cout << std::endl;
+    std::cout << "Replays a stream captured with squeeze2diretta --record against a" << std::endl;
+    std::cout << "simulated Diretta target clocked at the real cycle time. Further" << std::endl;
+    std::cout << "recordings follow as restarted squeezelite processes (supervised)." << std::endl;
+    std::cout << std::endl;
+    std::cout << "Options:" << std::endl;
+    std::cout << "  -a <format>           Sample format used for the recording (default: 32)" << std::endl;
+    std::cout << "  --mtu <bytes>         Simulated MTU (default: 1500)" << std::endl;
+    std::cout << "  --cycle-time <us>     Fixed cycle time (default: auto)" << std::endl;
+    std::cout << "  --high-water <pct>    Flow control high mark (default: 75)" << std::endl;
+    std::cout << "  --low-water <pct>     Flow control low mark (default: 70)" << std::endl;
+    std::cout << "  --no-zero-copy        Copy buffers out of the ring (as the wrapper option)" << std::endl;
+    std::cout << "  --fixed-buffer        Default ring/prefill sizes, no adaptive sizing" << std::endl;
+    std::cout << "  --sink-pcm <bits>     Widest PCM sample the sink accepts: 32, 24, 16" << std::endl;
+    std::cout << "  --sink-dsd <layout>   lsb-big (default), msb-big, lsb-little," << std::endl;
+    std::cout << "                        msb-little, or none" << std::endl;
+    std::cout << "  --sink-cache <file>   Persist negotiated sink formats (as the wrapper)" << std::endl;
+    std::cout << "  --discovery-cache <file>  Persist target address and MTU (as the wrapper)" << std::endl;
+    std::cout << "  --rt-memory           Lock and pre-fault memory (as the wrapper)" << std::endl;
+    std::cout << "  --huge-pages          Huge pages for large rings (as the wrapper)" << std::endl;
+    std::cout << "  --read-ahead <KB>     Reader thread + chunk pool (as the wrapper)" << std::endl;
+    std::cout << "  --idle-timeout <s>    Release the target after this much silence (as the wrapper)" << std::endl;
+    std::cout << "  --push <bytes>        Feed onFormat()/onAudio() in blocks of <bytes>, as" << std::endl;
+    std::cout << "                        an in-process decoder would (no pipe reads)" << std::endl;
+    std::cout << "  --fanout <n>          Play on n mock targets at once (as --target 1,2,...)" << std::endl;
+    std::cout << "  --fill-csv <file>     Write ring fill every 10 ms (ms,fill_pct)" << std::endl;
+    std::cout << "  --json                Print the final stats as JSON" << std::endl;
+    std::cout << "  -v                    Verbose output (debug level)" << std::endl;
+    std::cout << "  -q, --quiet           Only the summary" << std::endl;
+    std::cout << "  -h, --help            Show this help" << std::endl;
+    std::cout << std::endl;
+    std::cout << "Exit status is 2 if any underrun occurred, 1 on errors." << std::endl;
+}
+
+static bool parse_args(int argc, char* argv[], ReplayConfig& config) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+
+        if (arg == "-h" || arg == "--help") {
+            print_usage(argv[0]);
+            exit(0);
+        }
+        else if (arg == "-v") config.verbose = true;
+        else if (arg == "-q" || arg == "--quiet") config.quiet = true;
+        else if (arg == "--json") config.json = true;
+        else if (arg == "-a" && i + 1 < argc) config.sample_format = std::stoi(argv[++i]);
+        else if (arg == "--mtu" && i + 1 < argc) config.mtu = static_cast<unsigned int>(std::stoi(argv[++i]));
+        else if (arg == "--cycle-time" && i + 1 < argc) config.cycle_time = static_cast<unsigned int>(std::stoi(argv[++i]));
+        else if (arg == "--high-water" && i + 1 < argc) config.high_water = std::stoi(argv[++i]);
+        else if (arg == "--low-water" && i + 1 < argc) config.low_water = std::stoi(argv[++i]);
+        else if (arg == "--no-zero-copy") config.zero_copy = false;
+        else if (arg == "--fixed-buffer") config.adaptive_buffer = false;
+        else if (arg == "--sink-pcm" && i + 1 < argc) config.sink_pcm_bits = std::stoi(argv[++i]);
+        else if (arg == "--sink-dsd" && i + 1 < argc) config.sink_dsd = argv[++i];
+        else if (arg == "--sink-cache" && i + 1 < argc) config.sink_cache = argv[++i];
+        else if (arg == "--discovery-cache" && i + 1 < argc) config.discovery_cache = argv[++i];
+        else if (arg == "--rt-memory") config.rt_memory = true;
+        else if (arg == "--huge-pages") config.huge_pages = true;
+        else if (arg == "--read-ahead" && i + 1 < argc) config.read_ahead_kb = std::stoi(argv[++i]);
+        else if (arg == "--idle-timeout" && i + 1 < argc) config.idle_timeout = std::stod(argv[++i]);
+        else if (arg == "--push" && i + 1 < argc) config.push_bytes = std::stoi(argv[++i]);
+        else if (arg == "--fanout" && i + 1 < argc) config.fanout = std::stoi(argv[++i]);
+        else if (arg == "--fill-csv" && i + 1 < argc) config.fill_csv = argv[++i];
+        else if (arg[0] != '-') config.input_paths.push_back(arg);
+        else {
+            std::cerr << "Unknown option: " << arg << std::endl;
+            return false;
+        }
+    }
+    return !config.input_paths.empty();
+}
+
+// Decoder output callback stand-in: one header per format, then audio in
+// fixed blocks that need not be frame aligned
+static void push_stream(PipeReader& reader, StreamPipeline& pipeline, size_t blockBytes) {
+    std::vector<uint8_t> block(blockBytes);
+    SqFormatHeader hdr;
+    while (running && reader.readHeader(hdr)) {
+        if (!pipeline.onFormat(hdr)) return;
+        while (running) {
+            size_t got = 0;
+            PipeReader::ReadResult r = reader.readAudio(block.data(), block.size(), 1, got);
+            if (r != PipeReader::ReadResult::Audio) {
+                if (r == PipeReader::ReadResult::Header) break;
+                return;
+            }
+            pipeline.onAudio(block.data(), got);
+        }
+    }
+}
+
+static bool configure_sink(const ReplayConfig& config) {
+    using namespace DIRETTA::FormatID;
+    DIRETTA::MockSinkConfig& sink = DIRETTA::mockSinkConfig();
+
+    if (config.sink_pcm_bits != 16 && config.sink_pcm_bits != 24 && config.sink_pcm_bits != 32) {
+        std::cerr << "Invalid --sink-pcm: " << config.sink_pcm_bits << std::endl;
+        return false;
+    }
+    sink.maxPcmBits = config.sink_pcm_bits;
+    sink.mtu = config.mtu;
+
+    const uint32_t dsd32 = FMT_DSD1 | FMT_DSD_SIZ_32;
+    if (config.sink_dsd == "lsb-big") sink.dsdFormat = dsd32 | FMT_DSD_LSB | FMT_DSD_BIG;
+    else if (config.sink_dsd == "msb-big") sink.dsdFormat = dsd32 | FMT_DSD_MSB | FMT_DSD_BIG;
+    else if (config.sink_dsd == "lsb-little") sink.dsdFormat = dsd32 | FMT_DSD_LSB | FMT_DSD_LITTLE;
+    else if (config.sink_dsd == "msb-little") sink.dsdFormat = dsd32 | FMT_DSD_MSB | FMT_DSD_LITTLE;
+    else if (config.sink_dsd == "none") sink.dsdFormat = 0;
+    else {
+        std::cerr << "Invalid --sink-dsd: " << config.sink_dsd << std::endl;
+        return false;
+    }
+    return true;
+}
+
+static double process_cpu_seconds() {
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+    return static_cast<double>(ru.ru_utime.tv_sec + ru.ru_stime.tv_sec) +
+           static_cast<double>(ru.ru_utime.tv_usec + ru.ru_stime.tv_usec) / 1e6;
+}
+
+static long process_minor_faults() {
+    struct rusage ru;
+    getrusage(RUSAGE_SELF, &ru);
+    return ru.ru_minflt;
+}
+
+// ================================================================
+// Fill sampler: ring level curve while the pipeline runs
+// ================================================================
+struct FillStats {
+    uint64_t samples = 0;
+    double sum = 0.0;
+    float min = 1.0f;
+    float max = 0.0f;
+};
+
+static void fill_sampler(const DirettaSync& sync, std::atomic<bool>& stop,
+                         std::ofstream* csv, FillStats& stats) {
+    const auto interval = std::chrono::milliseconds(10);
+    auto start = std::chrono::steady_clock::now();
+    auto next = start;
+
+    while (!stop.load(std::memory_order_acquire)) {
+        next += interval;
+        std::this_thread::sleep_until(next);
+
+        float level = sync.getBufferLevel();
+        if (csv) {
+            auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::steady_clock::now() - start).count();
+            *csv << ms << "," << std::fixed << std::setprecision(1) << level * 100.0f << "\n";
+        }
+        // Curve statistics only once playback is running
+        if (sync.isPlaying() && sync.isPrefillComplete()) {
+            stats.samples++;
+            stats.sum += level;
+            if (level < stats.min) stats.min = level;
+            if (level > stats.max) stats.max = level;
+        }
+    }
+}
+
+static std::vector<DirettaSync*> all_targets(DirettaSync& sync,
+                                            const std::vector<std::unique_ptr<DirettaSync>>& fanout) {
+    std::vector<DirettaSync*> targets = { &sync };
+    for (const auto& target : fanout) targets.push_back(target.get());
+    return targets;
+}
+
+// ================================================================
+// Main
+// ================================================================
+int main(int argc, char* argv[]) {
+    ReplayConfig config;
+    if (!parse_args(argc, argv, config)) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    if (config.sample_format != 16 && config.sample_format != 24 && config.sample_format != 32) {
+        std::cerr << "Invalid sample format: " << config.sample_format << std::endl;
+        return 1;
+    }
+    if (config.push_bytes < 0 || (config.push_bytes > 0 &&
+                                  (config.read_ahead_kb > 0 || config.input_paths.size() > 1))) {
+        std::cerr << "Invalid --push (block size in bytes, not with --read-ahead or several recordings)" << std::endl;
+        return 1;
+    }
+    if (config.low_water <= 0 || config.low_water > config.high_water || config.high_water >= 100) {
+        std::cerr << "Invalid watermarks (need 0 < low <= high < 100)" << std::endl;
+        return 1;
+    }
+    if (config.fanout < 1) {
+        std::cerr << "Invalid --fanout: " << config.fanout << std::endl;
+        return 1;
+    }
+    if (!configure_sink(config)) return 1;
+
+    g_verbose = config.verbose;
+    if (config.verbose) {
+        g_logLevel = LogLevel::DEBUG;
+        g_logRing = new LogRing();
+    } else if (config.quiet) {
+        g_logLevel = LogLevel::WARN;
+    }
+
+    if (config.rt_memory) {
+        int err = lockProcessMemory();
+        if (err != 0) {
+            std::cerr << "mlockall failed: " << strerror(err) << " (continuing unlocked)" << std::endl;
+        }
+        prefaultStack();
+    }
+
+    std::vector<int> fds;
+    for (const std::string& path : config.input_paths) {
+        int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            std::cerr << "Cannot open " << path << ": " << strerror(errno) << std::endl;
+            for (int f : fds) close(f);
+            return 1;
+        }
+        fds.push_back(fd);
+    }
+
+    signal(SIGINT, signal_handler);
+    signal(SIGTERM, signal_handler);
+
+    DirettaSync sync;
+    DirettaConfig direttaConfig;
+    direttaConfig.mtu = config.mtu;
+    direttaConfig.cycleTime = config.cycle_time > 0 ? config.cycle_time : direttaConfig.cycleTime;
+    direttaConfig.cycleTimeAuto = config.cycle_time == 0;
+    direttaConfig.flowLowWater = config.low_water / 100.0f;
+    direttaConfig.flowHighWater = config.high_water / 100.0f;
+    direttaConfig.zeroCopyStream = config.zero_copy;
+    direttaConfig.adaptiveBuffer = config.adaptive_buffer;
+    direttaConfig.sinkCachePath = config.sink_cache;
+    direttaConfig.discoveryCachePath = config.discovery_cache;
+    direttaConfig.realtimeMemory = config.rt_memory;
+    direttaConfig.hugePages = config.huge_pages;
+
+    if (!sync.enable(direttaConfig)) {
+        std::cerr << "Mock target did not enable" << std::endl;
+        for (int fd : fds) close(fd);
+        return 1;
+    }
+    std::vector<std::unique_ptr<DirettaSync>> fanout;
+    for (int i = 1; i < config.fanout; i++) {
+        fanout.push_back(std::make_unique<DirettaSync>());
+        if (!fanout.back()->enable(direttaConfig)) {
+            std::cerr << "Mock target " << (i + 1) << " did not enable" << std::endl;
+            fanout.pop_back();
+            break;
+        }
+    }
+
+    std::ofstream csv;
+    if (!config.fill_csv.empty()) {
+        csv.open(config.fill_csv);
+        if (!csv) {
+            std::cerr << "Cannot write " << config.fill_csv << std::endl;
+            sync.disable();
+            for (int fd : fds) close(fd);
+            return 1;
+        }
+        csv << "ms,fill_pct\n";
+    }
+
+    std::vector<std::unique_ptr<PipeReader>> readers;
+    for (int fd : fds) {
+        readers.push_back(std::make_unique<PipeReader>(fd));
+    }
+    PipeReader& reader = *readers[0];
+    StreamPipeline pipeline(sync, reader, running, config.sample_format);
+    pipeline.setSupervised(readers.size() > 1);
+    for (auto& target : fanout) {
+        pipeline.addTarget(*target);
+    }
+    if (config.read_ahead_kb > 0) {
+        ThreadTuning reader_tuning;
+        reader_tuning.priority = 0;
+        pipeline.enableReadAhead(static_cast<size_t>(config.read_ahead_kb) * 1024, reader_tuning);
+    }
+    pipeline.setIdleTimeout(config.idle_timeout);
+
+    std::atomic<bool> stop_sampler{false};
+    FillStats fill;
+    std::thread sampler(fill_sampler, std::cref(sync), std::ref(stop_sampler),
+                        csv.is_open() ? &csv : nullptr, std::ref(fill));
+
+    double cpu_start = process_cpu_seconds();
+    long faults_start = process_minor_faults();
+    auto wall_start = std::chrono::steady_clock::now();
+
+    if (config.push_bytes > 0) {
+        push_stream(reader, pipeline, static_cast<size_t>(config.push_bytes));
+    } else {
+        pipeline.run();
+        for (size_t i = 1; i < readers.size() && running && pipeline.sourceEnded(); i++) {
+            // The last recording plays out its tail like a single one
+            pipeline.setSupervised(i + 1 < readers.size());
+            pipeline.attach(*readers[i], nullptr);
+            pipeline.run();
+        }
+    }
+
+    // Play out what is buffered. The ring running dry after the last
+    // buffer is the end of the stream, not an underrun
+    std::vector<DirettaSync*> targets = all_targets(sync, fanout);
+    std::vector<uint64_t> streamed_underruns;
+    uint64_t underruns = 0;
+    for (DirettaSync* target : targets) {
+        streamed_underruns.push_back(target->getUnderrunTotal());
+        underruns += streamed_underruns.back();
+    }
+    auto drain_start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < targets.size(); i++) {
+        DirettaSync* target = targets[i];
+        while (target->isPlaying() && target->getBufferLevel() > 0.0f &&
+               target->getUnderrunTotal() == streamed_underruns[i] &&
+               std::chrono::steady_clock::now() - drain_start < std::chrono::seconds(10)) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+    DIRETTA::Sync::MockStats mock = {};
+    for (DirettaSync* target : targets) {
+        DIRETTA::Sync::MockStats m = target->mockStats();
+        mock.cycles += m.cycles;
+        mock.lateCycles += m.lateCycles;
+        mock.bytes += m.bytes;
+        mock.sinkProbes += m.sinkProbes;
+    }
+
+    double cpu_seconds = process_cpu_seconds() - cpu_start;
+    long page_faults = process_minor_faults() - faults_start;
+    double wall_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wall_start).count();
+
+    stop_sampler.store(true, std::memory_order_release);
+    sampler.join();
+
+    std::ostringstream json;
+    if (config.json) {
+        json << "{\"pipe\":";
+        pipeline.writeStatsJson(json);
+        json << ",\"diretta\":";
+        sync.writeStatsJson(json);
+        json << "}";
+    }
+
+    if (pipeline.isDirettaOpen()) {
+        sync.close();
+    }
+    for (auto& target : fanout) {
+        if (target->isOpen()) target->close();
+        target->disable();
+    }
+    sync.disable();
+    for (int fd : fds) close(fd);
+
+    double audio_seconds = pipeline.streamedSeconds();
+    const Histogram& switches = pipeline.formatSwitchNs();
+
+    std::cout << std::endl;
+    std::cout << "Replay summary: " << config.input_paths[0];
+    for (size_t i = 1; i < config.input_paths.size(); i++) std::cout << " + " << config.input_paths[i];
+    std::cout << std::endl;
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "  Audio:            " << audio_seconds << " s (" << wall_seconds << " s wall)" << std::endl;
+    std::cout << "  Format changes:   " << pipeline.formatChanges();
+    if (switches.count() > 0) {
+        std::cout << " (switch p50 " << switches.percentile(0.5) / 1000000
+                  << " ms, max " << switches.max() / 1000000 << " ms)";
+    }
+    std::cout << std::endl;
+    if (pipeline.idlePeriods() > 0) {
+        std::cout << "  Idle periods:     " << pipeline.idlePeriods() << std::endl;
+    }
+    if (pipeline.flushes() > 0) {
+        std::cout << "  Flushes:          " << pipeline.flushes() << std::endl;
+    }
+    if (pipeline.targetCount() > 1) {
+        std::cout << "  Fan-out:          " << pipeline.targetCount() << " targets, "
+                  << pipeline.conversionCount() << " conversion(s)" << std::endl;
+    }
+    if (pipeline.sourceRestarts() > 0) {
+        std::cout << "  Source restarts:  " << pipeline.sourceRestarts() << std::endl;
+    }
+    std::cout << "  Underruns:        " << underruns << std::endl;
+    std::cout << "  Worker cycles:    " << mock.cycles << " (" << mock.lateCycles << " late)" << std::endl;
+    std::cout << "  Sink probes:      " << mock.sinkProbes << std::endl;
+    std::cout << "  Page faults:      " << page_faults << " (minor)" << std::endl;
+    if (fill.samples > 0) {
+        std::cout << "  Ring fill:        min " << fill.min * 100.0f << "%, mean "
+                  << fill.sum / fill.samples * 100.0 << "%, max " << fill.max * 100.0f << "%" << std::endl;
+    }
+    if (audio_seconds > 0) {
+        std::cout << "  CPU per audio s:  " << cpu_seconds / audio_seconds * 1000.0 << " ms" << std::endl;
+    }
+    if (config.json) {
+        std::cout << "[Stats JSON] " << json.str() << std::endl;
+    }
+
+    if (g_logRing) {
+        delete g_logRing;
+        g_logRing = nullptr;
+    }
+
+    return underruns > 0 ? 2 : 0;
+}
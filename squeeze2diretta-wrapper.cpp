@@ -10,6 +10,10 @@
  *   LMS -> squeezelite (patched) -> STDOUT [header|audio|header|audio|...]
  *     -> wrapper -> DirettaSync -> Diretta DAC
  *
+ * One process can run several zones (--zone), each a squeezelite player
+ * with its own pipeline, and play a zone on several targets (fan-out,
+ * --target 1,2).
+ *
  * Uses DirettaSync from DirettaRendererUPnP v2.0 for low-latency streaming:
  * - Lock-free ring buffer with SIMD optimizations (AVX2/AVX512)
  * - Pull-model via DIRETTA::Sync API
@@ -20,16 +24,25 @@
 
 #include "DirettaSync.h"
 #include "globals.h"
+#include "PipeReader.h"
+#include "RealtimeMemory.h"
+#include "StreamPipeline.h"
+#include <algorithm>
+#include <atomic>
 #include <iostream>
-#include <iomanip>
 #include <string>
 #include <vector>
 #include <cstring>
 #include <cstdlib>
 #include <unistd.h>
+#include <sched.h>
 #include <signal.h>
 #include <sys/wait.h>
 #include <sys/stat.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/eventfd.h>
+#include <poll.h>
 #include <fcntl.h>
 #include <memory>
 #include <thread>
@@ -41,150 +54,109 @@
 #define WRAPPER_VERSION "2.0.1"
 
 // ================================================================
-// In-band format header (must match squeezelite output_stdout.c)
+// Global state
 // ================================================================
-struct __attribute__((packed)) SqFormatHeader {
-    uint8_t  magic[4];       // "SQFH"
-    uint8_t  version;        // Protocol version: 1
-    uint8_t  channels;       // 2 for stereo
-    uint8_t  bit_depth;      // PCM: 16/24/32, DSD: 1, DoP: 24
-    uint8_t  dsd_format;     // 0=PCM, 1=DOP, 2=DSD_U32_LE, 3=DSD_U32_BE
-    uint32_t sample_rate;    // Sample/frame rate in Hz (LE)
-    uint8_t  reserved[4];    // Zero-filled
-};
+static const int MAX_ZONES = 8;
+static std::atomic<pid_t> squeezelite_pids[MAX_ZONES] = {};   // Current child per zone, 0 while restarting
+static std::atomic<bool> running{true};   // Read by every zone and the stats thread
 
-static_assert(sizeof(SqFormatHeader) == 16, "SqFormatHeader must be 16 bytes");
+struct Zone;
+static std::vector<std::unique_ptr<Zone>> g_zones;   // Fixed once the zones are set up
 
-static constexpr uint8_t SQFH_MAGIC[4] = {'S', 'Q', 'F', 'H'};
+static std::string stats_json();
+static void dump_stats();
 
-// DSD format types (from header dsd_format field)
-enum class DSDFormatType : uint8_t {
-    NONE   = 0,  // PCM
-    DOP    = 1,  // DSD over PCM
-    U32_LE = 2,  // Native DSD Little Endian
-    U32_BE = 3   // Native DSD Big Endian
-};
+// SIGUSR1 only wakes the stats thread, which formats and prints: the
+// handler may interrupt a thread holding the malloc or stdout lock
+static int g_stats_event_fd = -1;
 
-// ================================================================
-// Buffered pipe reader with peek support
-// ================================================================
-class PipeReader {
-public:
-    explicit PipeReader(int fd) : m_fd(fd), m_pos(0), m_len(0) {}
-
-    // Read exactly n bytes (blocking). Returns false on EOF/error.
-    bool readExact(void* dst, size_t n) {
-        uint8_t* out = static_cast<uint8_t*>(dst);
-        size_t remaining = n;
-
-        while (remaining > 0) {
-            // Serve from internal buffer first
-            size_t avail = m_len - m_pos;
-            if (avail > 0) {
-                size_t chunk = std::min(avail, remaining);
-                memcpy(out, m_buf + m_pos, chunk);
-                m_pos += chunk;
-                out += chunk;
-                remaining -= chunk;
-                continue;
-            }
-
-            // Buffer empty — refill from pipe
-            ssize_t n_read = ::read(m_fd, m_buf, sizeof(m_buf));
-            if (n_read <= 0) return false;  // EOF or error
-            m_pos = 0;
-            m_len = static_cast<size_t>(n_read);
+// Stop every zone: their pipes close once squeezelite exits
+static void stop_all_zones() {
+    running = false;
+    for (int i = 0; i < MAX_ZONES; i++) {
+        pid_t pid = squeezelite_pids[i];
+        if (pid > 0) {
+            kill(pid, SIGTERM);
         }
-        return true;
     }
+}
 
-    // Peek at the next n bytes without consuming. Returns false if EOF/error
-    // or fewer than n bytes available after one refill attempt.
-    bool peek(void* dst, size_t n) {
-        // If we have enough buffered data, peek directly
-        size_t avail = m_len - m_pos;
-        if (avail >= n) {
-            memcpy(dst, m_buf + m_pos, n);
-            return true;
-        }
-
-        // Compact buffer and refill
-        if (avail > 0 && m_pos > 0) {
-            memmove(m_buf, m_buf + m_pos, avail);
-        }
-        m_pos = 0;
-        m_len = avail;
-
-        // Read more data
-        while (m_len < n) {
-            ssize_t n_read = ::read(m_fd, m_buf + m_len, sizeof(m_buf) - m_len);
-            if (n_read <= 0) return false;
-            m_len += static_cast<size_t>(n_read);
-        }
+// Signal handler for clean shutdown
+void signal_handler(int sig) {
+    std::cout << "\nSignal " << sig << " received, shutting down..." << std::endl;
+    stop_all_zones();
+}
 
-        memcpy(dst, m_buf, n);
-        return true;
+// ================================================================
+// Stats thread: SIGUSR1 dumps, and each socket connection gets one
+// JSON document, then EOF
+// ================================================================
+// SIGUSR1 handler for runtime stats (async-signal-safe: eventfd write only)
+void stats_signal_handler(int /*sig*/) {
+    int saved = errno;
+    uint64_t one = 1;
+    if (g_stats_event_fd >= 0 && write(g_stats_event_fd, &one, sizeof(one)) < 0) {
+        // Counter full: a dump is pending anyway
     }
+    errno = saved;
+}
 
-    // Read up to n bytes (non-exact). Returns bytes read, or <=0 on EOF/error.
-    // Stops before any embedded SQFH header to prevent consuming it as audio.
-    ssize_t readUpTo(void* dst, size_t n) {
-        // Always go through internal buffer so we can scan for headers
-        size_t avail = m_len - m_pos;
-        if (avail == 0) {
-            // Buffer empty — refill from pipe
-            ssize_t n_read = ::read(m_fd, m_buf, sizeof(m_buf));
-            if (n_read <= 0) return n_read;
-            m_pos = 0;
-            m_len = static_cast<size_t>(n_read);
-            avail = m_len;
-        }
-
-        size_t chunk = std::min(avail, n);
-
-        // Scan for SQFH header embedded in the data.
-        // Start at byte 1 — byte 0 was already verified by peek() to not be 'S'QFH.
-        for (size_t i = 1; i + 3 <= chunk; i++) {
-            if (m_buf[m_pos + i] == 'S' && m_buf[m_pos + i + 1] == 'Q' &&
-                m_buf[m_pos + i + 2] == 'F' && m_buf[m_pos + i + 3] == 'H') {
-                chunk = i;  // Stop before the header
-                break;
-            }
-        }
-
-        memcpy(dst, m_buf + m_pos, chunk);
-        m_pos += chunk;
-        return static_cast<ssize_t>(chunk);
+// e.g. socat - UNIX-CONNECT:/run/squeeze2diretta.sock | jq .
+static int open_stats_socket(const std::string& path) {
+    struct sockaddr_un addr;
+    if (path.size() >= sizeof(addr.sun_path)) {
+        errno = ENAMETOOLONG;
+        return -1;
     }
 
-private:
-    int m_fd;
-    size_t m_pos;
-    size_t m_len;
-    uint8_t m_buf[65536];
-};
-
-// ================================================================
-// Global state
-// ================================================================
-static pid_t squeezelite_pid = 0;
-static bool running = true;
-static std::unique_ptr<DirettaSync> g_diretta;
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
 
-// Signal handler for clean shutdown
-void signal_handler(int sig) {
-    std::cout << "\nSignal " << sig << " received, shutting down..." << std::endl;
-    running = false;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    memcpy(addr.sun_path, path.c_str(), path.size());
+    unlink(path.c_str());  // Stale socket from a previous run
 
-    if (squeezelite_pid > 0) {
-        kill(squeezelite_pid, SIGTERM);
+    if (bind(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        listen(fd, 4) != 0) {
+        int saved = errno;
+        close(fd);
+        errno = saved;
+        return -1;
     }
+    return fd;
 }
 
-// SIGUSR1 handler for runtime stats
-void stats_signal_handler(int /*sig*/) {
-    if (g_diretta) {
-        g_diretta->dumpStats();
+// listen_fd: -1 without --stats-socket. Woken through g_stats_event_fd
+// (SIGUSR1, and once running is cleared, at exit).
+static void stats_thread_loop(int listen_fd) {
+    pthread_setname_np(pthread_self(), "sq2d-stats");
+    while (running) {
+        struct pollfd fds[2] = {{g_stats_event_fd, POLLIN, 0}, {listen_fd, POLLIN, 0}};
+        if (poll(fds, listen_fd >= 0 ? 2 : 1, -1) < 0) {
+            if (errno == EINTR) continue;
+            break;
+        }
+        if (fds[0].revents & POLLIN) {
+            uint64_t count;
+            if (read(g_stats_event_fd, &count, sizeof(count)) == sizeof(count) && running) {
+                dump_stats();
+            }
+        }
+        if (listen_fd < 0 || !(fds[1].revents & POLLIN)) continue;
+
+        int client = accept4(listen_fd, nullptr, nullptr, SOCK_CLOEXEC);
+        if (client < 0) continue;
+        std::string json = stats_json() + "\n";
+        const char* p = json.data();
+        size_t left = json.size();
+        while (left > 0) {
+            ssize_t n = send(client, p, left, MSG_NOSIGNAL);
+            if (n <= 0) break;
+            p += n;
+            left -= static_cast<size_t>(n);
+        }
+        close(client);
     }
 }
 
@@ -199,18 +171,51 @@ struct Config {
     std::string model_name = "SqueezeLite";
     std::string codecs = "";
     std::string rates = "";
-    int sample_format = 32;              // -a (16, 24, or 32)
+    int sample_format = 0;               // -a (16, 24, or 32; 0 = what the target takes)
     std::string dsd_format = ":u32be";   // -D format
     bool wav_header = false;             // -W
 
     // Diretta options
-    int diretta_target = 0;
+    std::string targets = "1";           // -t: 1-based, comma-separated (fan-out)
     int thread_mode = 1;
     unsigned int cycle_time = 2620;
     bool cycle_time_auto = true;
     unsigned int mtu = 0;
+    int low_water = 70;                  // Producer wakeup, % of ring
+    int high_water = 75;                 // Producer sleeps above this, % of ring
+    bool zero_copy = true;               // SDK reads audio in place from the ring
+    bool adaptive_buffer = true;         // Rescale ring/prefill from observed jitter
+    int buffer_min = 25;                 // Adaptive bounds, % of the default sizes
+    int buffer_max = 200;
+    std::string sink_cache = "";         // Persist negotiated sink formats ("" = memory only)
+    std::string discovery_cache = "";    // Persist target address + MTU ("" = discover every start)
+    int idle_timeout = 0;                // Release the target after this much silence, s (0 = never)
+
+    // Thread placement (-1 = unpinned)
+    int worker_cpu = -1;                 // SDK worker (getNewStream)
+    int producer_cpu = -1;               // Main loop: pipe reads, ring pushes
+    int rt_priority = 50;                // Worker, SCHED_FIFO/RR
+    int producer_priority = 0;           // 0 = normal scheduling
+    std::string sched_policy = "fifo";   // Worker: fifo, rr, deadline, other
+    bool rt_memory = false;              // mlockall + pre-faulted buffers
+    bool huge_pages = false;             // hugetlbfs pages for large rings
+
+    // Transport from squeezelite
+    std::string transport = "pipe";      // pipe or shm
+    int pipe_size = 0;                   // Pipe capacity / ring size in bytes (0 = default)
+    int read_ahead_kb = 0;               // Reader thread + chunk pool (0 = read in the main loop)
+    int reader_cpu = -1;                 // Reader thread (with --read-ahead)
+
+    // Supervision
+    int max_restarts = 5;                // Restarts of squeezelite in a row (0 = exit with it)
+
+    // Zones
+    std::vector<std::string> zones;      // --zone <name>:<targets>[:<mac>], beyond the main one
+    std::string cpu_plan = "";           // CPUs for every zone's threads, in order
 
     // Other
+    std::string stats_socket = "";       // Unix socket path for JSON stats
+    std::string record_path = "";        // Tee the squeezelite stream to this file
     bool verbose = false;
     bool quiet = false;
     bool list_targets = false;
@@ -230,7 +235,8 @@ void print_usage(const char* prog) {
     std::cout << "  -M <model>            Model name (default: SqueezeLite)" << std::endl;
     std::cout << "  -c <codec1>,<codec2>  Restrict codecs (flac,pcm,mp3,ogg,aac,dsd...)" << std::endl;
     std::cout << "  -r <rates>            Supported sample rates" << std::endl;
-    std::cout << "  -a <format>           Sample format: 16, 24, or 32 (default)" << std::endl;
+    std::cout << "  -a <format>           Sample format: 16, 24, or 32 (default: the width" << std::endl;
+    std::cout << "                        the target takes, 32 with DoP)" << std::endl;
     std::cout << "  -D [:format]          Enable DSD output:" << std::endl;
     std::cout << "                          -D           = DoP (DSD over PCM)" << std::endl;
     std::cout << "                          -D :u32be    = Native DSD Big Endian (MSB)" << std::endl;
@@ -238,17 +244,72 @@ void print_usage(const char* prog) {
     std::cout << "  -W                    Read WAV/AIFF headers, ignore server parameters" << std::endl;
     std::cout << std::endl;
     std::cout << "Diretta Options:" << std::endl;
-    std::cout << "  -t, --target <number> Diretta target number (default: 1 = first)" << std::endl;
+    std::cout << "  -t, --target <n>[,<n>...]" << std::endl;
+    std::cout << "                        Diretta target number (default: 1 = first); with" << std::endl;
+    std::cout << "                        several, play on all of them (fan-out)" << std::endl;
     std::cout << "  -l, --list-targets    List Diretta targets and exit" << std::endl;
     std::cout << "  --thread-mode <n>     THRED_MODE bitmask (default: 1)" << std::endl;
     std::cout << "  --cycle-time <us>     Transfer cycle time in microseconds (default: auto)" << std::endl;
     std::cout << "  --mtu <bytes>         MTU override (default: auto-detect)" << std::endl;
+    std::cout << "  --high-water <pct>    Stop reading above this ring fill (default: 75)" << std::endl;
+    std::cout << "  --low-water <pct>     Resume reading at this ring fill (default: 70)" << std::endl;
+    std::cout << "  --no-zero-copy        Copy each Diretta buffer out of the ring instead" << std::endl;
+    std::cout << "                        of handing the SDK ring memory" << std::endl;
+    std::cout << "  --buffer-min <pct>    Smallest ring/prefill the adaptive sizing may pick," << std::endl;
+    std::cout << "                        % of the defaults (default: 25)" << std::endl;
+    std::cout << "  --buffer-max <pct>    Largest ring/prefill (default: 200)" << std::endl;
+    std::cout << "  --fixed-buffer        Keep the default ring/prefill sizes" << std::endl;
+    std::cout << "  --sink-cache <file>   Remember the sink formats each target accepted" << std::endl;
+    std::cout << "                        across restarts (default: this run only)" << std::endl;
+    std::cout << "  --discovery-cache <file>" << std::endl;
+    std::cout << "                        Start with the last target address and MTU, and" << std::endl;
+    std::cout << "                        rediscover in the background (default: off)" << std::endl;
+    std::cout << "  --idle-timeout <s>    Release the target after this many seconds of" << std::endl;
+    std::cout << "                        silence (pause, stop); reconnect when audio" << std::endl;
+    std::cout << "                        returns (default: 0 = stay connected)" << std::endl;
+    std::cout << std::endl;
+    std::cout << "Thread Options:" << std::endl;
+    std::cout << "  --worker-cpu <n>      Pin the Diretta SDK worker thread to CPU n" << std::endl;
+    std::cout << "  --producer-cpu <n>    Pin the main loop (pipe reads, ring pushes) to CPU n" << std::endl;
+    std::cout << "  --rt-priority <n>     Worker realtime priority, 1-99 (default: 50)" << std::endl;
+    std::cout << "  --sched-policy <p>    Worker policy: fifo (default), rr, deadline (period =" << std::endl;
+    std::cout << "                        cycle time), or other" << std::endl;
+    std::cout << "  --producer-priority <n> Main loop realtime priority, 1-99 (default: normal)" << std::endl;
+    std::cout << "  --rt-memory           Lock all memory (mlockall) and pre-fault the audio" << std::endl;
+    std::cout << "                        buffers, so streaming never page faults" << std::endl;
+    std::cout << "  --huge-pages          Back rings of 2 MB and up with huge pages" << std::endl;
+    std::cout << "                        (needs vm.nr_hugepages; falls back to normal pages)" << std::endl;
+    std::cout << std::endl;
+    std::cout << "Transport Options:" << std::endl;
+    std::cout << "  --transport <type>    pipe (default) or shm (shared-memory ring, needs" << std::endl;
+    std::cout << "                        the current squeezelite patch)" << std::endl;
+    std::cout << "  --pipe-size <bytes>   Kernel pipe capacity (F_SETPIPE_SZ), or ring size" << std::endl;
+    std::cout << "                        with --transport shm (ring default: 1 MB)" << std::endl;
+    std::cout << "  --read-ahead <KB>     Read squeezelite on a separate thread into a pool" << std::endl;
+    std::cout << "                        of this size (e.g. 2048; default: off)" << std::endl;
+    std::cout << "  --reader-cpu <n>      Pin the --read-ahead reader thread to CPU n" << std::endl;
+    std::cout << "  --max-restarts <n>    Restart squeezelite when it exits, keeping the" << std::endl;
+    std::cout << "                        Diretta session open; give up after n quick" << std::endl;
+    std::cout << "                        exits in a row (default: 5; 0 = exit with it)" << std::endl;
+    std::cout << std::endl;
+    std::cout << "Zone Options:" << std::endl;
+    std::cout << "  --zone <name>:<targets>[:<mac>]" << std::endl;
+    std::cout << "                        Run another player in this process, on these" << std::endl;
+    std::cout << "                        targets (e.g. kitchen:2 or office:3,4); repeatable." << std::endl;
+    std::cout << "                        Default MAC: derived from the name" << std::endl;
+    std::cout << "  --cpu-plan <cpus>     CPUs for the threads of every zone, handed out in" << std::endl;
+    std::cout << "                        order: each target's worker, the producer, the" << std::endl;
+    std::cout << "                        reader (with --read-ahead); e.g. 2-7. Overrides" << std::endl;
+    std::cout << "                        --worker-cpu, --producer-cpu and --reader-cpu" << std::endl;
     std::cout << std::endl;
     std::cout << "Other:" << std::endl;
     std::cout << "  -v                    Verbose output (debug level)" << std::endl;
     std::cout << "  -q, --quiet           Quiet mode (warnings and errors only)" << std::endl;
     std::cout << "  -h, --help            Show this help" << std::endl;
     std::cout << "  --squeezelite <path>  Path to squeezelite binary" << std::endl;
+    std::cout << "  --stats-socket <path> Serve JSON stats on a Unix socket (also on SIGUSR1)" << std::endl;
+    std::cout << "  --record <file>       Save the raw squeezelite stream (headers + audio)" << std::endl;
+    std::cout << "                        for squeeze2diretta-replay (main zone only)" << std::endl;
     std::cout << std::endl;
     std::cout << "NOTE: Requires patched squeezelite with in-band format headers." << std::endl;
     std::cout << "      Run setup-squeezelite.sh to build the patched version." << std::endl;
@@ -296,7 +357,7 @@ Config parse_args(int argc, char* argv[]) {
             else if (arg == "-c") config.codecs = value;
             else if (arg == "-r") config.rates = value;
             else if (arg == "-a") config.sample_format = std::stoi(value);
-            else if (arg == "-t" || arg == "--target") config.diretta_target = std::stoi(value) - 1;
+            else if (arg == "-t" || arg == "--target") config.targets = value;
         }
         else if (arg == "--thread-mode" && i + 1 < argc) {
             config.thread_mode = std::stoi(argv[++i]);
@@ -308,9 +369,84 @@ Config parse_args(int argc, char* argv[]) {
         else if (arg == "--mtu" && i + 1 < argc) {
             config.mtu = static_cast<unsigned int>(std::stoi(argv[++i]));
         }
+        else if (arg == "--high-water" && i + 1 < argc) {
+            config.high_water = std::stoi(argv[++i]);
+        }
+        else if (arg == "--low-water" && i + 1 < argc) {
+            config.low_water = std::stoi(argv[++i]);
+        }
+        else if (arg == "--no-zero-copy") {
+            config.zero_copy = false;
+        }
+        else if (arg == "--buffer-min" && i + 1 < argc) {
+            config.buffer_min = std::stoi(argv[++i]);
+        }
+        else if (arg == "--buffer-max" && i + 1 < argc) {
+            config.buffer_max = std::stoi(argv[++i]);
+        }
+        else if (arg == "--fixed-buffer") {
+            config.adaptive_buffer = false;
+        }
+        else if (arg == "--sink-cache" && i + 1 < argc) {
+            config.sink_cache = argv[++i];
+        }
+        else if (arg == "--discovery-cache" && i + 1 < argc) {
+            config.discovery_cache = argv[++i];
+        }
+        else if (arg == "--idle-timeout" && i + 1 < argc) {
+            config.idle_timeout = std::stoi(argv[++i]);
+        }
+        else if (arg == "--worker-cpu" && i + 1 < argc) {
+            config.worker_cpu = std::stoi(argv[++i]);
+        }
+        else if (arg == "--producer-cpu" && i + 1 < argc) {
+            config.producer_cpu = std::stoi(argv[++i]);
+        }
+        else if (arg == "--rt-priority" && i + 1 < argc) {
+            config.rt_priority = std::stoi(argv[++i]);
+        }
+        else if (arg == "--producer-priority" && i + 1 < argc) {
+            config.producer_priority = std::stoi(argv[++i]);
+        }
+        else if (arg == "--sched-policy" && i + 1 < argc) {
+            config.sched_policy = argv[++i];
+        }
+        else if (arg == "--rt-memory") {
+            config.rt_memory = true;
+        }
+        else if (arg == "--huge-pages") {
+            config.huge_pages = true;
+        }
         else if (arg == "--squeezelite" && i + 1 < argc) {
             config.squeezelite_path = argv[++i];
         }
+        else if (arg == "--stats-socket" && i + 1 < argc) {
+            config.stats_socket = argv[++i];
+        }
+        else if (arg == "--record" && i + 1 < argc) {
+            config.record_path = argv[++i];
+        }
+        else if (arg == "--transport" && i + 1 < argc) {
+            config.transport = argv[++i];
+        }
+        else if (arg == "--pipe-size" && i + 1 < argc) {
+            config.pipe_size = std::stoi(argv[++i]);
+        }
+        else if (arg == "--read-ahead" && i + 1 < argc) {
+            config.read_ahead_kb = std::stoi(argv[++i]);
+        }
+        else if (arg == "--reader-cpu" && i + 1 < argc) {
+            config.reader_cpu = std::stoi(argv[++i]);
+        }
+        else if (arg == "--max-restarts" && i + 1 < argc) {
+            config.max_restarts = std::stoi(argv[++i]);
+        }
+        else if (arg == "--zone" && i + 1 < argc) {
+            config.zones.push_back(argv[++i]);
+        }
+        else if (arg == "--cpu-plan" && i + 1 < argc) {
+            config.cpu_plan = argv[++i];
+        }
     }
 
     return config;
@@ -329,6 +465,10 @@ std::vector<std::string> build_squeezelite_args(const Config& config, const std:
     args.push_back("-o");
     args.push_back(output_path);
 
+    // PCM sample format on the pipe (resolved in main(), never 0 here)
+    args.push_back("-a");
+    args.push_back(std::to_string(config.sample_format));
+
     // Sample rates
     args.push_back("-r");
     if (!config.rates.empty()) {
@@ -378,171 +518,71 @@ std::vector<std::string> build_squeezelite_args(const Config& config, const std:
 }
 
 // ================================================================
-// DSD de-interleave: interleaved S32_LE → planar with byte-swap
-//
-// Squeezelite packs DSD bytes MSB-first into uint32_t (dsd.c),
-// then outputs S32_LE (little-endian) via output_stdout.c.
-// On the pipe: byte[0]=last DSD byte, byte[3]=first DSD byte.
-// We byte-swap to restore correct temporal order.
-// ================================================================
-static void deinterleave_dsd_native(const uint8_t* src, uint8_t* dst,
-                                     size_t num_frames, size_t bytes_per_frame,
-                                     size_t channels) {
-    size_t bytes_per_channel = num_frames * 4;
-
-    for (size_t frame = 0; frame < num_frames; frame++) {
-        size_t src_offset = frame * bytes_per_frame;
-        size_t dst_offset_L = frame * 4;
-        size_t dst_offset_R = bytes_per_channel + frame * 4;
-
-        // L channel: byte-swap from LE pipe order to correct temporal order
-        dst[dst_offset_L + 0] = src[src_offset + 3];
-        dst[dst_offset_L + 1] = src[src_offset + 2];
-        dst[dst_offset_L + 2] = src[src_offset + 1];
-        dst[dst_offset_L + 3] = src[src_offset + 0];
-
-        // R channel: byte-swap
-        dst[dst_offset_R + 0] = src[src_offset + 7];
-        dst[dst_offset_R + 1] = src[src_offset + 6];
-        dst[dst_offset_R + 2] = src[src_offset + 5];
-        dst[dst_offset_R + 3] = src[src_offset + 4];
-    }
-}
-
-// ================================================================
-// DoP → Native DSD conversion: extract DSD bits from DoP S32_LE
-//
-// DoP format (S32_LE): [padding][DSD_LSB][DSD_MSB][marker]
-// Each 32-bit sample contains 16 bits of DSD data.
-// Output: planar native DSD [L L L...][R R R...]
-// ================================================================
-static void convert_dop_to_native_dsd(const uint8_t* src, uint8_t* dst,
-                                       size_t num_frames, size_t bytes_per_frame,
-                                       size_t channels) {
-    size_t dsd_bytes_per_frame = 2 * channels;
-    size_t output_size = num_frames * dsd_bytes_per_frame;
-    size_t bytes_per_channel = output_size / channels;
-
-    for (size_t frame = 0; frame < num_frames; frame++) {
-        size_t src_offset = frame * bytes_per_frame;
-        size_t dst_offset_L = frame * 2;
-        size_t dst_offset_R = bytes_per_channel + frame * 2;
-
-        // Extract DSD from L channel (bytes 1-2, MSB first for DFF)
-        dst[dst_offset_L + 0] = src[src_offset + 2];  // DSD MSB
-        dst[dst_offset_L + 1] = src[src_offset + 1];  // DSD LSB
-
-        // Extract DSD from R channel
-        dst[dst_offset_R + 0] = src[src_offset + 6];  // DSD MSB
-        dst[dst_offset_R + 1] = src[src_offset + 5];  // DSD LSB
-    }
-}
-
-// ================================================================
-// Main
+// Squeezelite process
 // ================================================================
-int main(int argc, char* argv[]) {
-
-    std::cout << "================================================================" << std::endl;
-    std::cout << "  squeeze2diretta v" << WRAPPER_VERSION << std::endl;
-    std::cout << "  Squeezelite to Diretta Bridge" << std::endl;
-    std::cout << "  Using DirettaSync from DirettaRendererUPnP v2.0" << std::endl;
-    std::cout << "  In-band format signaling (no stderr parsing)" << std::endl;
-    std::cout << "================================================================" << std::endl;
-    std::cout << std::endl;
-
-    // Parse arguments
-    Config config = parse_args(argc, argv);
-
-    // Validate PCM output bit depth
-    const int output_bit_depth = config.sample_format;
-    if (output_bit_depth != 16 && output_bit_depth != 24 && output_bit_depth != 32) {
-        LOG_ERROR("Invalid sample format: " << output_bit_depth << " (must be 16, 24, or 32)");
-        return 1;
-    }
-
-    g_verbose = config.verbose;
-    if (config.verbose) {
-        g_logLevel = LogLevel::DEBUG;
-    } else if (config.quiet) {
-        g_logLevel = LogLevel::WARN;
-    }
-
-    if (g_verbose) {
-        g_logRing = new LogRing();
-    }
-
-    // List targets if requested
-    if (config.list_targets) {
-        DirettaSync::listTargets();
-        if (g_logRing) delete g_logRing;
-        return 0;
-    }
-
-    // Setup signal handlers
-    signal(SIGINT, signal_handler);
-    signal(SIGTERM, signal_handler);
-    signal(SIGUSR1, stats_signal_handler);
-
-    // Create DirettaSync instance
-    g_diretta = std::make_unique<DirettaSync>();
-
-    DirettaConfig direttaConfig;
-    direttaConfig.threadMode = config.thread_mode;
-    direttaConfig.cycleTime = config.cycle_time;
-    direttaConfig.cycleTimeAuto = config.cycle_time_auto;
-    direttaConfig.mtu = config.mtu;
-
-    if (config.diretta_target >= 0) {
-        g_diretta->setTargetIndex(config.diretta_target);
+// One running squeezelite: its stdout pipe, the optional shared-memory
+// ring, and the reader over them. Every (re)start gets fresh ones.
+struct Squeezelite {
+    pid_t pid = 0;
+    int slot = 0;                        // Zone, in squeezelite_pids
+    int fd = -1;                         // stdout pipe, read end
+    std::unique_ptr<ShmRing> shm;
+    std::unique_ptr<PipeReader> reader;
+    std::chrono::steady_clock::time_point started;
+
+    ~Squeezelite() {
+        reader.reset();
+        shm.reset();
+        if (fd >= 0) close(fd);
     }
-    if (config.mtu > 0) {
-        g_diretta->setMTU(config.mtu);
-    }
-
-    LOG_INFO("Initializing Diretta...");
-
-    if (!g_diretta->enable(direttaConfig)) {
-        LOG_ERROR("Failed to enable Diretta. Check that a Diretta target is available.");
-        LOG_ERROR("Use -l to list available targets.");
-        if (g_logRing) delete g_logRing;
-        return 1;
-    }
-
-    LOG_INFO("Diretta enabled successfully");
+};
 
-    // Create pipe for squeezelite stdout (audio + headers)
+static bool spawn_squeezelite(const Config& config, const std::vector<std::string>& args,
+                              int record_fd, int slot, Squeezelite& child) {
+    // Create pipe for squeezelite stdout (audio + headers). CLOEXEC: a
+    // squeezelite another zone forks meanwhile must not hold our write end,
+    // or we would never see EOF when ours exits. dup2() clears it on stdout.
     int pipefd[2];
-    if (pipe(pipefd) == -1) {
+    if (pipe2(pipefd, O_CLOEXEC) == -1) {
         LOG_ERROR("Failed to create pipe: " << strerror(errno));
-        g_diretta->disable();
-        if (g_logRing) delete g_logRing;
-        return 1;
+        return false;
     }
 
-    // Build squeezelite command
-    std::vector<std::string> squeezelite_args = build_squeezelite_args(config, "-");
-    if (g_logLevel >= LogLevel::DEBUG) {
-        std::cout << "Squeezelite command: ";
-        for (const auto& arg : squeezelite_args) {
-            std::cout << arg << " ";
+    // Optional shared-memory transport; the pipe then only signals exit
+    if (config.transport == "shm") {
+        const size_t SHM_RING_DEFAULT_SIZE = 1024 * 1024;
+        size_t ring_size = config.pipe_size > 0 ? static_cast<size_t>(config.pipe_size)
+                                                : SHM_RING_DEFAULT_SIZE;
+        child.shm = std::make_unique<ShmRing>();
+        if (child.shm->create(ring_size, pipefd[0])) {
+            LOG_INFO("Transport: shared-memory ring (" << child.shm->capacity() / 1024 << " KB)");
+        } else {
+            LOG_WARN("Shared-memory ring unavailable (" << strerror(errno) << "), using pipe");
+            child.shm.reset();
+        }
+    } else if (config.pipe_size > 0) {
+        // A larger pipe absorbs squeezelite's write bursts at high DSD rates
+        int actual = fcntl(pipefd[0], F_SETPIPE_SZ, config.pipe_size);
+        if (actual < 0) {
+            LOG_WARN("Failed to set pipe size to " << config.pipe_size << " bytes: "
+                     << strerror(errno) << " (limit: /proc/sys/fs/pipe-max-size)");
+        } else {
+            LOG_INFO("Pipe size: " << actual << " bytes");
         }
-        std::cout << std::endl;
     }
 
     // Fork and exec squeezelite
-    squeezelite_pid = fork();
+    pid_t pid = fork();
 
-    if (squeezelite_pid == -1) {
+    if (pid == -1) {
         LOG_ERROR("Failed to fork");
         close(pipefd[0]);
         close(pipefd[1]);
-        g_diretta->disable();
-        if (g_logRing) delete g_logRing;
-        return 1;
+        child.shm.reset();
+        return false;
     }
 
-    if (squeezelite_pid == 0) {
+    if (pid == 0) {
         // Child process: redirect stdout to pipe, let stderr pass through
         close(pipefd[0]);  // Close read end
 
@@ -555,9 +595,28 @@ int main(int argc, char* argv[]) {
         // v2.0: stderr is NOT redirected — squeezelite logs pass through
         // to the parent process stderr for debugging (visible with -v)
 
+        // A restart is forked from the producer: drop its pinning and
+        // realtime policy, squeezelite sets up its own
+        cpu_set_t all_cpus;
+        CPU_ZERO(&all_cpus);
+        for (long cpu = 0; cpu < sysconf(_SC_NPROCESSORS_CONF) && cpu < CPU_SETSIZE; cpu++) {
+            CPU_SET(cpu, &all_cpus);
+        }
+        sched_setaffinity(0, sizeof(all_cpus), &all_cpus);
+        struct sched_param normal = {};
+        sched_setscheduler(0, SCHED_OTHER, &normal);
+
+        // Keep the ring fds across exec; tell squeezelite where they are
+        if (child.shm) {
+            child.shm->inheritInChild();
+            setenv("SQ2D_SHM", child.shm->envValue().c_str(), 1);
+        } else {
+            unsetenv("SQ2D_SHM");
+        }
+
         // Convert args to C-style array
         std::vector<char*> c_args;
-        for (auto& arg : squeezelite_args) {
+        for (auto& arg : args) {
             c_args.push_back(const_cast<char*>(arg.c_str()));
         }
         c_args.push_back(nullptr);
@@ -570,311 +629,664 @@ int main(int argc, char* argv[]) {
 
     // Parent process
     close(pipefd[1]);  // Close write end
-    int fifo_fd = pipefd[0];
+    child.pid = pid;
+    child.slot = slot;
+    child.fd = pipefd[0];
+    child.started = std::chrono::steady_clock::now();
+    squeezelite_pids[slot] = pid;
+    if (!running) {
+        kill(pid, SIGTERM);  // Signal arrived while we were forking
+    }
 
-    LOG_INFO("Squeezelite started (PID: " << squeezelite_pid << ")");
-    LOG_INFO("Waiting for first track header...");
-    LOG_INFO("");
+    LOG_INFO("Squeezelite started (PID: " << pid << ")");
 
-    // ================================================================
-    // Main loop: synchronous header-based format detection
-    // ================================================================
-    // The patched squeezelite writes a 16-byte "SQFH" header to stdout
-    // only when the format changes (or for the first track). Same-format
-    // gapless transitions emit no header — audio flows uninterrupted.
-    // No stderr parsing or race conditions.
-    // ================================================================
+    child.reader = child.shm ? std::make_unique<PipeReader>(child.shm.get())
+                             : std::make_unique<PipeReader>(child.fd);
+    if (record_fd >= 0) {
+        child.reader->setTee(record_fd);
+    }
+    return true;
+}
+
+// Wait for squeezelite after its pipe closed (or after SIGTERM) and log how
+// it ended
+static void reap_squeezelite(Squeezelite& child) {
+    if (child.pid <= 0) return;
+    int status = 0;
+    pid_t r;
+    do {
+        r = waitpid(child.pid, &status, 0);
+    } while (r < 0 && errno == EINTR);
+    squeezelite_pids[child.slot] = 0;
+    child.pid = 0;
+
+    if (r < 0 || !running) return;
+    if (WIFSIGNALED(status)) {
+        LOG_WARN("Squeezelite killed by signal " << WTERMSIG(status) << " (" << strsignal(WTERMSIG(status)) << ")");
+    } else if (WIFEXITED(status)) {
+        LOG_WARN("Squeezelite exited with status " << WEXITSTATUS(status));
+    }
+}
 
-    PipeReader reader(fifo_fd);
+// ================================================================
+// Zones
+// ================================================================
+// One squeezelite player and the Diretta targets it plays on: the first
+// target is the primary, the others are fed by fan-out. Zone 0 comes
+// from -n/-m/--target and runs on the main thread, each --zone on a
+// thread of its own.
+struct Zone {
+    Config config;                       // With this zone's player name, MAC, sample format and CPUs
+    std::string label;                   // Log prefix ("" with a single zone)
+    std::vector<int> targets;            // 0-based target indexes
+    std::vector<int> worker_cpus;        // Per target (-1 = unpinned)
+    std::vector<std::unique_ptr<DirettaSync>> syncs;
+    std::vector<std::string> args;       // squeezelite command line
+    std::unique_ptr<Squeezelite> child;
+    std::unique_ptr<StreamPipeline> pipeline;
+    ThreadTuning producer_tuning;
+    int slot = 0;                        // Index in g_zones and squeezelite_pids
+    int record_fd = -1;                  // Zone 0 only
+    int exit_code = 0;
+    std::thread thread;                  // Zones after the first
+};
+
+// "1,3" -> {0, 2}
+static bool parse_target_list(const std::string& list, std::vector<int>& targets) {
+    targets.clear();
+    std::stringstream ss(list);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        char* end = nullptr;
+        long n = std::strtol(item.c_str(), &end, 10);
+        if (item.empty() || *end != '\0' || n < 1 || n > 255) return false;
+        targets.push_back(static_cast<int>(n) - 1);
+    }
+    return !targets.empty();
+}
 
-    // Squeezelite always outputs S32_LE (4 bytes per sample)
-    const size_t SQZ_BYTES_PER_SAMPLE = 4;
-    const size_t PIPE_BUF_SIZE = 16384;
-    const float RING_HIGH_WATER = 0.75f;  // Wait when ring buffer > 75% full
+// "2,3,6-7" -> {2, 3, 6, 7}
+static bool parse_cpu_list(const std::string& list, std::vector<int>& cpus) {
+    cpus.clear();
+    std::stringstream ss(list);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        int first = 0, last = 0;
+        char dash = 0, extra = 0;
+        int fields = std::sscanf(item.c_str(), "%d%c%d%c", &first, &dash, &last, &extra);
+        if (fields == 1) {
+            last = first;
+        } else if (fields != 3 || dash != '-') {
+            return false;
+        }
+        if (first < 0 || last < first) return false;
+        for (int cpu = first; cpu <= last; cpu++) cpus.push_back(cpu);
+    }
+    return !cpus.empty();
+}
 
-    // Current format state
-    AudioFormat current_format;
-    DSDFormatType current_dsd_type = DSDFormatType::NONE;
-    unsigned int current_rate = 0;
-    uint8_t current_depth = 0;
-    bool diretta_open = false;
+// LMS tells players apart by MAC: a zone without -m gets a locally
+// administered one that stays the same across restarts (FNV-1a of the name)
+static std::string zone_mac(const std::string& name) {
+    uint64_t h = 14695981039346656037ULL;
+    for (unsigned char c : name) {
+        h = (h ^ c) * 1099511628211ULL;
+    }
+    char mac[18];
+    std::snprintf(mac, sizeof(mac), "02:%02x:%02x:%02x:%02x:%02x",
+                  static_cast<unsigned>(h >> 32) & 0xff, static_cast<unsigned>(h >> 24) & 0xff,
+                  static_cast<unsigned>(h >> 16) & 0xff, static_cast<unsigned>(h >> 8) & 0xff,
+                  static_cast<unsigned>(h) & 0xff);
+    return mac;
+}
 
-    // Streaming state
-    uint64_t total_bytes = 0;
-    uint64_t total_frames = 0;
+// Each DirettaSync rewrites its cache file whole, so targets don't share one
+static std::string per_target_path(const std::string& path, int target) {
+    if (path.empty()) return path;
+    return path + "-t" + std::to_string(target + 1);
+}
 
-    std::vector<uint8_t> audio_buf(PIPE_BUF_SIZE);
-    std::vector<uint8_t> planar_buf(PIPE_BUF_SIZE);
+static void write_json_string(std::ostream& os, const std::string& s) {
+    os << '"';
+    for (char c : s) {
+        if (c == '"' || c == '\\') os << '\\';
+        if (static_cast<unsigned char>(c) >= 0x20) os << c;
+    }
+    os << '"';
+}
 
-    while (running) {
-        // ============================================================
-        // Phase 1: Read format header (blocking)
-        // ============================================================
-        SqFormatHeader hdr;
-        if (!reader.readExact(&hdr, sizeof(hdr))) {
-            if (running) {
-                LOG_INFO("Squeezelite pipe closed");
+// Machine-readable stats: pipe stage plus DirettaSync of the main zone's
+// first target, and with several targets, every zone and target
+static std::string stats_json() {
+    std::ostringstream os;
+    const Zone* main_zone = g_zones.empty() ? nullptr : g_zones[0].get();
+    os << "{\"pipe\":";
+    if (main_zone && main_zone->pipeline) {
+        main_zone->pipeline->writeStatsJson(os);
+    } else {
+        os << "null";
+    }
+    os << ",\"diretta\":";
+    if (main_zone && !main_zone->syncs.empty()) {
+        main_zone->syncs[0]->writeStatsJson(os);
+    } else {
+        os << "null";
+    }
+    if (g_zones.size() > 1 || (main_zone && main_zone->syncs.size() > 1)) {
+        os << ",\"zones\":[";
+        for (size_t z = 0; z < g_zones.size(); z++) {
+            const Zone& zone = *g_zones[z];
+            os << (z > 0 ? "," : "") << "{\"name\":";
+            write_json_string(os, zone.config.player_name);
+            os << ",\"pipe\":";
+            if (zone.pipeline) {
+                zone.pipeline->writeStatsJson(os);
+            } else {
+                os << "null";
+            }
+            os << ",\"targets\":[";
+            for (size_t t = 0; t < zone.syncs.size(); t++) {
+                os << (t > 0 ? "," : "") << "{\"target\":" << (zone.targets[t] + 1) << ",\"diretta\":";
+                zone.syncs[t]->writeStatsJson(os);
+                os << "}";
             }
+            os << "]}";
+        }
+        os << "]";
+    }
+    os << "}";
+    return os.str();
+}
+
+// SIGUSR1, on the stats thread
+static void dump_stats() {
+    if (g_zones.empty() || g_zones[0]->syncs.empty()) return;
+    for (const auto& zone : g_zones) {
+        for (const auto& sync : zone->syncs) {
+            sync->dumpStats();
+        }
+    }
+    std::cout << "[Stats JSON] " << stats_json() << std::endl;
+}
+
+// A zone's producer: stream until stopped, restarting squeezelite as it
+// exits. Whichever zone stops first stops the others, so a zone that gave
+// up takes the process down for systemd.
+static void run_zone(Zone& zone) {
+    // Zone 0 is the main thread, which keeps its name (the process name)
+    std::string thread_name = "sq2d-zone" + std::to_string(zone.slot);
+    applyThreadTuning(zone.slot > 0 ? thread_name.c_str() : nullptr, "Producer", zone.producer_tuning);
+
+    const Config& config = zone.config;
+    if (config.idle_timeout > 0) {
+        zone.pipeline->setIdleTimeout(config.idle_timeout);
+        LOG_INFO(zone.label << "Idle timeout: " << config.idle_timeout << " s of silence");
+    }
+    if (config.rt_memory) {
+        prefaultStack();
+    }
+
+    LOG_INFO(zone.label << "Waiting for first track header...");
+    LOG_INFO("");
+
+    // Supervision: a squeezelite that exits is restarted on a fresh pipe
+    // while DirettaSync stays enabled and open. The first restart is
+    // immediate; further ones back off, and after max_restarts exits in a
+    // row (each within RESTART_STABLE of its start) the wrapper gives up
+    // and exits for systemd.
+    const auto RESTART_STABLE = std::chrono::seconds(60);
+    int restarts_in_row = 0;
+
+    while (true) {
+        zone.pipeline->run();
+        if (!running || !zone.pipeline->sourceEnded()) break;
+
+        auto uptime = std::chrono::steady_clock::now() - zone.child->started;
+        kill(zone.child->pid, SIGTERM);  // Still alive if only the read failed
+        reap_squeezelite(*zone.child);
+        zone.child.reset();
+
+        if (uptime >= RESTART_STABLE) restarts_in_row = 0;
+        if (++restarts_in_row > config.max_restarts) {
+            LOG_ERROR(zone.label << "Squeezelite exited " << restarts_in_row << " times in a row, giving up");
+            zone.exit_code = 1;
             break;
         }
 
-        // Validate magic
-        if (memcmp(hdr.magic, SQFH_MAGIC, 4) != 0) {
-            LOG_ERROR("Expected SQFH header, got: "
-                      << std::hex << (int)hdr.magic[0] << " " << (int)hdr.magic[1]
-                      << " " << (int)hdr.magic[2] << " " << (int)hdr.magic[3]
-                      << std::dec);
-            LOG_ERROR("Stream desynchronized. Is squeezelite patched for v2.0?");
-            running = false;
+        // 0, 250 ms, 500 ms, 1 s ... capped at 5 s
+        int delay_ms = restarts_in_row == 1 ? 0 : std::min(250 << std::min(restarts_in_row - 2, 5), 5000);
+        auto restart_at = std::chrono::steady_clock::now() + std::chrono::milliseconds(delay_ms);
+        while (running && std::chrono::steady_clock::now() < restart_at) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        }
+        if (!running) break;
+
+        LOG_INFO(zone.label << "[Restart] Restarting squeezelite (" << restarts_in_row << "/" << config.max_restarts
+                 << (delay_ms > 0 ? ", after " + std::to_string(delay_ms) + " ms" : "") << ")");
+        auto child = std::make_unique<Squeezelite>();
+        if (!spawn_squeezelite(config, zone.args, zone.record_fd, zone.slot, *child)) {
+            zone.exit_code = 1;
             break;
         }
+        zone.child = std::move(child);
+        zone.pipeline->attach(*zone.child->reader, zone.child->shm.get());
+    }
 
-        // Parse header
-        DSDFormatType dsd_type = static_cast<DSDFormatType>(hdr.dsd_format);
-        bool is_dsd = (dsd_type != DSDFormatType::NONE);
-
-        LOG_DEBUG("\n[Header] v" << (int)hdr.version
-                  << " ch=" << (int)hdr.channels
-                  << " depth=" << (int)hdr.bit_depth
-                  << " dsd=" << (int)hdr.dsd_format
-                  << " rate=" << hdr.sample_rate << "Hz");
-
-        // ============================================================
-        // Phase 2: Determine if format changed
-        // ============================================================
-        bool format_changed = (hdr.sample_rate != current_rate ||
-                                hdr.dsd_format != static_cast<uint8_t>(current_dsd_type) ||
-                                hdr.bit_depth != current_depth);
-
-        if (format_changed) {
-            // Calculate actual DSD bit rate and Diretta format
-            unsigned int actual_rate = hdr.sample_rate;
-            unsigned int bit_depth = static_cast<unsigned int>(output_bit_depth);
-
-            if (is_dsd) {
-                if (dsd_type == DSDFormatType::U32_BE || dsd_type == DSDFormatType::U32_LE) {
-                    // Native DSD: frame rate × 32 = DSD bit rate
-                    actual_rate = hdr.sample_rate * 32;
-                    bit_depth = 1;
-                } else if (dsd_type == DSDFormatType::DOP) {
-                    // DoP: carrier rate × 16 = DSD bit rate
-                    actual_rate = hdr.sample_rate * 16;
-                    bit_depth = 1;
-                }
-            }
+    stop_all_zones();
+}
 
-            if (dsd_type == DSDFormatType::DOP) {
-                LOG_INFO("\n[Format Change] DoP->DSD at " << actual_rate << "Hz"
-                          << " (DoP rate: " << hdr.sample_rate << "Hz)");
-            } else if (is_dsd) {
-                LOG_INFO("\n[Format Change] DSD at " << actual_rate << "Hz"
-                          << " (frame rate: " << hdr.sample_rate << "Hz)");
-            } else {
-                LOG_INFO("\n[Format Change] PCM at " << actual_rate << "Hz / "
-                          << (int)hdr.bit_depth << "-bit");
-            }
+// ================================================================
+// Main
+// ================================================================
+int main(int argc, char* argv[]) {
 
-            // Don't call close() before open() — let open() handle the transition
-            // internally. close() sets m_open=false which prevents open() from
-            // detecting the format change and doing the critical SDK close/reopen
-            // needed for sample rate changes (e.g., 48kHz → 44.1kHz).
-
-            // Build AudioFormat for DirettaSync
-            AudioFormat format;
-            format.sampleRate = actual_rate;
-            format.bitDepth = bit_depth;
-            format.channels = hdr.channels;
-            format.isDSD = is_dsd;
-            format.isCompressed = false;
-
-            if (is_dsd) {
-                format.dsdFormat = AudioFormat::DSDFormat::DFF;  // MSB (byte-swap in de-interleave)
-                LOG_DEBUG("[DSD Format] "
-                          << (dsd_type == DSDFormatType::DOP ? "DoP->DSD" : "Native DSD")
-                          << " as DFF (MSB)");
-            }
+    std::cout << "================================================================" << std::endl;
+    std::cout << "  squeeze2diretta v" << WRAPPER_VERSION << std::endl;
+    std::cout << "  Squeezelite to Diretta Bridge" << std::endl;
+    std::cout << "  Using DirettaSync from DirettaRendererUPnP v2.0" << std::endl;
+    std::cout << "  In-band format signaling (no stderr parsing)" << std::endl;
+    std::cout << "================================================================" << std::endl;
+    std::cout << std::endl;
 
-            // Open Diretta with new format
-            if (!g_diretta->open(format)) {
-                LOG_ERROR("Failed to open Diretta with new format");
-                running = false;
-                break;
-            }
+    // Parse arguments
+    Config config = parse_args(argc, argv);
 
-            // Squeezelite always outputs MSB-aligned S32_LE
-            if (!is_dsd) {
-                g_diretta->setS24PackModeHint(DirettaRingBuffer::S24PackMode::MsbAligned);
-            }
+    // Validate PCM output bit depth
+    if (config.sample_format != 0 && config.sample_format != 16 &&
+        config.sample_format != 24 && config.sample_format != 32) {
+        LOG_ERROR("Invalid sample format: " << config.sample_format << " (must be 16, 24, or 32)");
+        return 1;
+    }
+    // DoP is unpacked from 32-bit words; S24_3LE/S16 would change its layout
+    if (config.dsd_format == "dop" && config.sample_format != 0 && config.sample_format != 32) {
+        LOG_WARN("Sample format " << config.sample_format << " cannot carry DoP, using 32");
+        config.sample_format = 32;
+    }
 
-            diretta_open = true;
-            current_format = format;
-            current_rate = hdr.sample_rate;
-            current_dsd_type = dsd_type;
-            current_depth = hdr.bit_depth;
-
-            // ========================================================
-            // Burst-fill: fill ring buffer before rate-limited playback
-            // ========================================================
-            LOG_DEBUG("[Burst Fill] Starting prefill...");
-
-            size_t bytes_per_frame = SQZ_BYTES_PER_SAMPLE * hdr.channels;
-            auto burst_start = std::chrono::steady_clock::now();
-            const auto burst_timeout = std::chrono::seconds(5);
-            size_t burst_bytes = 0;
-
-            while (!g_diretta->isPrefillComplete() && running) {
-                auto elapsed = std::chrono::steady_clock::now() - burst_start;
-                if (elapsed > burst_timeout) {
-                    LOG_WARN("[Burst Fill] Timeout after 5s");
-                    break;
-                }
+    if (config.low_water <= 0 || config.low_water > config.high_water || config.high_water >= 100) {
+        LOG_ERROR("Invalid watermarks: low " << config.low_water << "%, high " << config.high_water
+                  << "% (need 0 < low <= high < 100)");
+        return 1;
+    }
 
-                // Peek for next header (new track during burst)
-                uint8_t peek_buf[4];
-                if (reader.peek(peek_buf, 4) && memcmp(peek_buf, SQFH_MAGIC, 4) == 0) {
-                    LOG_DEBUG("[Burst Fill] Next track header during burst");
-                    break;
-                }
+    if (config.buffer_min <= 0 || config.buffer_min > config.buffer_max) {
+        LOG_ERROR("Invalid buffer bounds: min " << config.buffer_min << "%, max " << config.buffer_max
+                  << "% (need 0 < min <= max)");
+        return 1;
+    }
 
-                ssize_t n = reader.readUpTo(audio_buf.data(), PIPE_BUF_SIZE);
-                if (n <= 0) break;
-
-                size_t num_frames = static_cast<size_t>(n) / bytes_per_frame;
-                size_t num_samples;
-
-                if (is_dsd && dsd_type == DSDFormatType::DOP) {
-                    size_t dsd_bytes_per_frame = 2 * hdr.channels;
-                    size_t output_size = num_frames * dsd_bytes_per_frame;
-                    if (planar_buf.size() < output_size) planar_buf.resize(output_size);
-                    convert_dop_to_native_dsd(audio_buf.data(), planar_buf.data(),
-                                               num_frames, bytes_per_frame, hdr.channels);
-                    num_samples = (output_size * 8) / hdr.channels;
-                    g_diretta->sendAudio(planar_buf.data(), num_samples);
-                    burst_bytes += output_size;
-                } else if (is_dsd) {
-                    if (planar_buf.size() < static_cast<size_t>(n)) planar_buf.resize(n);
-                    deinterleave_dsd_native(audio_buf.data(), planar_buf.data(),
-                                             num_frames, bytes_per_frame, hdr.channels);
-                    num_samples = (static_cast<size_t>(n) * 8) / hdr.channels;
-                    g_diretta->sendAudio(planar_buf.data(), num_samples);
-                    burst_bytes += n;
-                } else {
-                    num_samples = num_frames;
-                    g_diretta->sendAudio(audio_buf.data(), num_samples);
-                    burst_bytes += n;
-                }
+    SchedPolicy worker_policy;
+    if (!parseSchedPolicy(config.sched_policy, worker_policy)) {
+        LOG_ERROR("Invalid scheduling policy: " << config.sched_policy << " (must be fifo, rr, deadline or other)");
+        return 1;
+    }
+    if (config.rt_priority < 1 || config.rt_priority > 99 ||
+        config.producer_priority < 0 || config.producer_priority > 99) {
+        LOG_ERROR("Invalid realtime priority (must be 1-99)");
+        return 1;
+    }
+    long num_cpus = sysconf(_SC_NPROCESSORS_CONF);
+    if (config.worker_cpu >= num_cpus || config.producer_cpu >= num_cpus || config.reader_cpu >= num_cpus ||
+        config.worker_cpu < -1 || config.producer_cpu < -1 || config.reader_cpu < -1) {
+        LOG_ERROR("Invalid CPU (this system has CPUs 0-" << (num_cpus - 1) << ")");
+        return 1;
+    }
+
+    if (config.transport != "pipe" && config.transport != "shm") {
+        LOG_ERROR("Invalid transport: " << config.transport << " (must be pipe or shm)");
+        return 1;
+    }
+    if (config.read_ahead_kb < 0) {
+        LOG_ERROR("Invalid read-ahead: " << config.read_ahead_kb << " KB");
+        return 1;
+    }
+    if (config.idle_timeout < 0) {
+        LOG_ERROR("Invalid idle timeout: " << config.idle_timeout << " s");
+        return 1;
+    }
+    if (config.max_restarts < 0) {
+        LOG_ERROR("Invalid max restarts: " << config.max_restarts);
+        return 1;
+    }
+
+    // Zones: the main one from -n/-m/--target, then each --zone
+    g_zones.reserve(MAX_ZONES);
+    auto main_zone = std::make_unique<Zone>();
+    main_zone->config = config;
+    if (!parse_target_list(config.targets, main_zone->targets)) {
+        LOG_ERROR("Invalid target list: " << config.targets << " (e.g. 1 or 1,3)");
+        return 1;
+    }
+    g_zones.push_back(std::move(main_zone));
+    for (const std::string& spec : config.zones) {
+        // <name>:<targets>[:<mac>]; the MAC has colons of its own
+        size_t colon = spec.find(':');
+        size_t mac_colon = colon == std::string::npos ? colon : spec.find(':', colon + 1);
+        auto zone = std::make_unique<Zone>();
+        zone->config = config;
+        zone->config.player_name = spec.substr(0, colon);
+        zone->config.mac_address = mac_colon == std::string::npos ? "" : spec.substr(mac_colon + 1);
+        std::string targets = colon == std::string::npos ? "" : spec.substr(colon + 1, mac_colon - colon - 1);
+        if (zone->config.player_name.empty() || !parse_target_list(targets, zone->targets)) {
+            LOG_ERROR("Invalid zone: " << spec << " (need <name>:<targets>[:<mac>])");
+            return 1;
+        }
+        if (zone->config.mac_address.empty()) {
+            zone->config.mac_address = zone_mac(zone->config.player_name);
+        }
+        g_zones.push_back(std::move(zone));
+        if (g_zones.size() > static_cast<size_t>(MAX_ZONES)) {
+            LOG_ERROR("Too many zones (at most " << MAX_ZONES << ")");
+            return 1;
+        }
+    }
+    size_t sink_count = 0;
+    std::vector<int> used_targets;
+    for (size_t z = 0; z < g_zones.size(); z++) {
+        Zone& zone = *g_zones[z];
+        zone.slot = static_cast<int>(z);
+        if (g_zones.size() > 1) {
+            zone.label = "[Zone " + zone.config.player_name + "] ";
+        }
+        for (int target : zone.targets) {
+            if (std::find(used_targets.begin(), used_targets.end(), target) != used_targets.end()) {
+                LOG_ERROR("Target " << (target + 1) << " is used twice");
+                return 1;
             }
+            used_targets.push_back(target);
+        }
+        sink_count += zone.targets.size();
+        zone.worker_cpus.assign(zone.targets.size(), config.worker_cpu);
+    }
 
-            if (g_logLevel >= LogLevel::DEBUG) {
-                auto burst_elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
-                    std::chrono::steady_clock::now() - burst_start);
-                LOG_DEBUG("[Burst Fill] Complete: " << burst_bytes << " bytes in "
-                          << burst_elapsed.count() << "ms");
+    // CPU plan: handed out in order, per zone each target's worker, then
+    // the producer, then the reader; wraps around when it runs out
+    if (!config.cpu_plan.empty()) {
+        std::vector<int> plan;
+        if (!parse_cpu_list(config.cpu_plan, plan) ||
+            *std::max_element(plan.begin(), plan.end()) >= num_cpus) {
+            LOG_ERROR("Invalid CPU plan: " << config.cpu_plan << " (e.g. 2-7; this system has CPUs 0-"
+                      << (num_cpus - 1) << ")");
+            return 1;
+        }
+        size_t next = 0;
+        auto take = [&]() { return plan[next++ % plan.size()]; };
+        for (auto& zone : g_zones) {
+            std::ostringstream workers;
+            for (size_t t = 0; t < zone->targets.size(); t++) {
+                zone->worker_cpus[t] = take();
+                workers << (t > 0 ? "," : "") << zone->worker_cpus[t];
             }
+            zone->config.producer_cpu = take();
+            zone->config.reader_cpu = config.read_ahead_kb > 0 ? take() : -1;
+            LOG_INFO(zone->label << "CPU plan: worker " << workers.str() << ", producer "
+                     << zone->config.producer_cpu
+                     << (config.read_ahead_kb > 0 ? ", reader " + std::to_string(zone->config.reader_cpu) : ""));
+        }
+        if (next > plan.size()) {
+            LOG_WARN("CPU plan has " << plan.size() << " CPUs for " << next << " threads, some share a CPU");
+        }
+    }
 
-            if (dsd_type == DSDFormatType::DOP) LOG_INFO("[Ready] DoP->DSD at " << actual_rate << "Hz");
-            else if (is_dsd) LOG_INFO("[Ready] DSD at " << actual_rate << "Hz");
-            else LOG_INFO("[Ready] PCM at " << actual_rate << "Hz");
+    g_verbose = config.verbose;
+    if (config.verbose) {
+        g_logLevel = LogLevel::DEBUG;
+    } else if (config.quiet) {
+        g_logLevel = LogLevel::WARN;
+    }
 
+    if (g_verbose) {
+        g_logRing = new LogRing();
+    }
+
+    // List targets if requested
+    if (config.list_targets) {
+        DirettaSync::listTargets();
+        if (g_logRing) delete g_logRing;
+        return 0;
+    }
+
+    // Setup signal handlers
+    g_stats_event_fd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (g_stats_event_fd < 0) {
+        LOG_WARN("eventfd failed: " << strerror(errno) << " - SIGUSR1 stats and the stats socket are off");
+    }
+    signal(SIGINT, signal_handler);
+    signal(SIGTERM, signal_handler);
+    signal(SIGUSR1, stats_signal_handler);
+
+    // Before DirettaSync and its threads exist, so MCL_FUTURE covers them
+    if (config.rt_memory) {
+        int err = lockProcessMemory();
+        if (err == 0) {
+            LOG_INFO("Realtime memory: locked (mlockall), malloc trimming disabled");
         } else {
-            // Same format — gapless transition, no reopen needed
-            LOG_DEBUG("[Gapless] Same format, continuing stream");
+            LOG_WARN("mlockall failed: " << strerror(err)
+                     << " - raise LimitMEMLOCK or grant CAP_IPC_LOCK; continuing unlocked");
         }
+    }
 
-        // ============================================================
-        // Phase 3: Stream audio until next header or EOF
-        // ============================================================
-        size_t bytes_per_frame = SQZ_BYTES_PER_SAMPLE * hdr.channels;
-        unsigned int rate_for_timing = is_dsd ? hdr.sample_rate : current_format.sampleRate;
-
-        while (running) {
-            // Check for next track header
-            uint8_t peek_buf[4];
-            if (reader.peek(peek_buf, 4) && memcmp(peek_buf, SQFH_MAGIC, 4) == 0) {
-                break;  // Next track — back to outer loop for header parsing
+    DirettaConfig direttaConfig;
+    direttaConfig.threadMode = config.thread_mode;
+    direttaConfig.cycleTime = config.cycle_time;
+    direttaConfig.cycleTimeAuto = config.cycle_time_auto;
+    direttaConfig.mtu = config.mtu;
+    direttaConfig.flowLowWater = config.low_water / 100.0f;
+    direttaConfig.flowHighWater = config.high_water / 100.0f;
+    direttaConfig.zeroCopyStream = config.zero_copy;
+    direttaConfig.adaptiveBuffer = config.adaptive_buffer;
+    direttaConfig.bufferScaleMin = config.buffer_min / 100.0f;
+    direttaConfig.bufferScaleMax = config.buffer_max / 100.0f;
+    direttaConfig.sinkCachePath = config.sink_cache;
+    direttaConfig.discoveryCachePath = config.discovery_cache;
+    direttaConfig.realtimeMemory = config.rt_memory;
+    direttaConfig.hugePages = config.huge_pages;
+    direttaConfig.workerThread.policy = worker_policy;
+    direttaConfig.workerThread.priority = config.rt_priority;
+    direttaConfig.workerThread.warnOnFailure = config.worker_cpu >= 0 || !config.cpu_plan.empty() ||
+                                               config.rt_priority != 50 || worker_policy != SchedPolicy::FIFO;
+
+    auto disable_all = [&]() {
+        for (auto& zone : g_zones) {
+            for (auto& sync : zone->syncs) {
+                sync->disable();
             }
+        }
+    };
 
-            ssize_t bytes_read = reader.readUpTo(audio_buf.data(), PIPE_BUF_SIZE);
+    LOG_INFO("Initializing Diretta...");
 
-            if (bytes_read <= 0) {
-                if (bytes_read == 0) {
-                    LOG_INFO("Squeezelite pipe closed");
-                } else if (errno != EINTR) {
-                    LOG_ERROR("Error reading from pipe: " << strerror(errno));
-                }
-                running = false;
-                break;
+    // Create a DirettaSync instance per target
+    for (auto& zone : g_zones) {
+        for (size_t t = 0; t < zone->targets.size(); t++) {
+            int target = zone->targets[t];
+            DirettaConfig targetConfig = direttaConfig;
+            targetConfig.workerThread.cpu = zone->worker_cpus[t];
+            if (sink_count > 1) {
+                targetConfig.sinkCachePath = per_target_path(config.sink_cache, target);
+                targetConfig.discoveryCachePath = per_target_path(config.discovery_cache, target);
             }
 
-            size_t num_frames = static_cast<size_t>(bytes_read) / bytes_per_frame;
-            size_t num_samples;
-
-            // Consumer-driven flow control: wait for space BEFORE pushing
-            // push() is non-blocking and truncates if full — must wait first
-            // to avoid silently dropping audio data
-            if (g_diretta->isPrefillComplete()) {
-                while (running) {
-                    float level = g_diretta->getBufferLevel();
-                    if (level <= RING_HIGH_WATER) break;
-                    std::unique_lock<std::mutex> lock(g_diretta->getFlowMutex());
-                    g_diretta->waitForSpace(lock, std::chrono::milliseconds(50));
-                }
+            auto sync = std::make_unique<DirettaSync>();
+            sync->setTargetIndex(target);
+            if (config.mtu > 0) {
+                sync->setMTU(config.mtu);
             }
+            bool enabled = sync->enable(targetConfig);
+            zone->syncs.push_back(std::move(sync));
+            if (!enabled) {
+                LOG_ERROR("Failed to enable Diretta target " << (target + 1)
+                          << ". Check that a Diretta target is available.");
+                LOG_ERROR("Use -l to list available targets.");
+                disable_all();
+                if (g_logRing) delete g_logRing;
+                return 1;
+            }
+        }
+    }
 
-            // Process and send based on format
-            if (current_format.isDSD && current_dsd_type == DSDFormatType::DOP) {
-                // DoP → Native DSD
-                size_t dsd_bytes_per_frame = 2 * hdr.channels;
-                size_t output_size = num_frames * dsd_bytes_per_frame;
-                if (planar_buf.size() < output_size) planar_buf.resize(output_size);
-                convert_dop_to_native_dsd(audio_buf.data(), planar_buf.data(),
-                                           num_frames, bytes_per_frame, hdr.channels);
-                num_samples = (output_size * 8) / hdr.channels;
-                g_diretta->sendAudio(planar_buf.data(), num_samples);
-
-            } else if (current_format.isDSD) {
-                // Native DSD: interleaved → planar with byte-swap
-                if (planar_buf.size() < static_cast<size_t>(bytes_read)) {
-                    planar_buf.resize(bytes_read);
+    LOG_INFO("Diretta enabled successfully" << (sink_count > 1 ? " (" + std::to_string(sink_count) + " targets)" : ""));
+
+    // Have squeezelite send PCM at the width the target takes (cached per
+    // target), so the ring copies it instead of repacking S32. With
+    // fan-out, the widest any of the zone's targets takes; narrower
+    // targets convert it down in their ring.
+    for (auto& zone : g_zones) {
+        if (zone->config.sample_format != 0) continue;
+        int bits = 0;
+        if (config.dsd_format != "dop") {
+            for (auto& sync : zone->syncs) {
+                int target_bits = sync->preferredPcmBits(44100, 2);
+                if (target_bits == 0) {
+                    bits = 0;
+                    break;
                 }
-                deinterleave_dsd_native(audio_buf.data(), planar_buf.data(),
-                                         num_frames, bytes_per_frame, hdr.channels);
-                num_samples = (static_cast<size_t>(bytes_read) * 8) / hdr.channels;
-                g_diretta->sendAudio(planar_buf.data(), num_samples);
-
-            } else {
-                // PCM: send raw S32_LE — DirettaSync handles 32→24/16 conversion
-                num_samples = num_frames;
-                g_diretta->sendAudio(audio_buf.data(), num_samples);
+                bits = std::max(bits, target_bits);
             }
+        }
+        zone->config.sample_format = (bits == 16 || bits == 24) ? bits : 32;
+        LOG_INFO(zone->label << "PCM sample format: " << zone->config.sample_format << "-bit"
+                 << (bits > 0 ? " (target)" : " (default)"));
+    }
 
-            total_bytes += static_cast<uint64_t>(bytes_read);
-            total_frames += num_frames;
+    // Build squeezelite commands
+    for (auto& zone : g_zones) {
+        zone->args = build_squeezelite_args(zone->config, "-");
+        if (g_logLevel >= LogLevel::DEBUG) {
+            std::cout << zone->label << "Squeezelite command: ";
+            for (const auto& arg : zone->args) {
+                std::cout << arg << " ";
+            }
+            std::cout << std::endl;
+        }
+    }
 
-            // Progress (debug level, every ~10 seconds)
-            if (g_logLevel >= LogLevel::DEBUG && total_frames % (rate_for_timing * 10) < (PIPE_BUF_SIZE / bytes_per_frame)) {
-                double seconds = static_cast<double>(total_frames) / static_cast<double>(rate_for_timing);
-                LOG_DEBUG("Streamed: " << std::fixed << std::setprecision(1)
-                          << seconds << "s (" << (total_bytes / 1024 / 1024) << " MB)");
+    // Optional capture of the raw stream for squeeze2diretta-replay
+    int record_fd = -1;
+    if (!config.record_path.empty()) {
+        record_fd = open(config.record_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+        if (record_fd >= 0) {
+            LOG_INFO("Recording squeezelite stream to " << config.record_path);
+        } else {
+            LOG_WARN("Failed to open " << config.record_path << ": " << strerror(errno));
+        }
+    }
+    g_zones[0]->record_fd = record_fd;
+
+    // Producer: the main thread runs zone 0, further zones get a thread
+    // each, with the same policy
+    ThreadTuning producer_tuning;
+    producer_tuning.policy = worker_policy == SchedPolicy::RR ? SchedPolicy::RR : SchedPolicy::FIFO;
+    producer_tuning.priority = config.producer_priority;
+    producer_tuning.warnOnFailure = true;
+
+    for (auto& zone : g_zones) {
+        auto child = std::make_unique<Squeezelite>();
+        if (!spawn_squeezelite(zone->config, zone->args, zone->record_fd, zone->slot, *child)) {
+            stop_all_zones();
+            for (auto& started : g_zones) {
+                if (started->child) reap_squeezelite(*started->child);
             }
+            disable_all();
+            if (record_fd >= 0) close(record_fd);
+            if (g_logRing) delete g_logRing;
+            return 1;
         }
+        zone->child = std::move(child);
+
+        zone->pipeline = std::make_unique<StreamPipeline>(*zone->syncs[0], *zone->child->reader, running,
+                                                          zone->config.sample_format);
+        for (size_t t = 1; t < zone->syncs.size(); t++) {
+            zone->pipeline->addTarget(*zone->syncs[t]);
+        }
+        if (zone->child->shm) {
+            zone->pipeline->watchShmFallback(zone->child->shm.get());
+        }
+        zone->pipeline->setSupervised(config.max_restarts > 0);
+
+        zone->producer_tuning = producer_tuning;
+        zone->producer_tuning.cpu = zone->config.producer_cpu;
+
+        // Reader: same policy as the producer, its own CPU. Enabled here,
+        // before the stats thread starts reading the pipeline.
+        if (zone->config.read_ahead_kb > 0) {
+            ThreadTuning reader_tuning = zone->producer_tuning;
+            reader_tuning.cpu = zone->config.reader_cpu;
+            zone->pipeline->enableReadAhead(static_cast<size_t>(zone->config.read_ahead_kb) * 1024,
+                                            reader_tuning);
+        }
+    }
+
+    // Stats thread: SIGUSR1 dumps, plus the optional stats socket
+    int stats_fd = -1;
+    if (!config.stats_socket.empty()) {
+        stats_fd = open_stats_socket(config.stats_socket);
+        if (stats_fd >= 0) {
+            LOG_INFO("Stats socket: " << config.stats_socket);
+        } else {
+            LOG_WARN("Failed to open stats socket " << config.stats_socket << ": " << strerror(errno));
+        }
+    }
+    std::thread stats_thread;
+    if (g_stats_event_fd >= 0) {
+        stats_thread = std::thread(stats_thread_loop, stats_fd);
+    }
+
+    // Squeezelite was forked above and the stats and zone threads are
+    // started before the main thread pins itself, so none of them
+    // inherits its pinning (a restarted squeezelite drops it after the
+    // fork)
+    for (size_t z = 1; z < g_zones.size(); z++) {
+        g_zones[z]->thread = std::thread(run_zone, std::ref(*g_zones[z]));
+    }
+    run_zone(*g_zones[0]);
+
+    int exit_code = 0;
+    for (auto& zone : g_zones) {
+        if (zone->thread.joinable()) zone->thread.join();
+        if (exit_code == 0) exit_code = zone->exit_code;
     }
 
     // Cleanup
     LOG_INFO("");
     LOG_INFO("Shutting down...");
 
-    if (diretta_open) {
-        g_diretta->close();
+    if (stats_thread.joinable()) {
+        uint64_t one = 1;
+        if (write(g_stats_event_fd, &one, sizeof(one)) == sizeof(one)) {
+            stats_thread.join();  // Sees running cleared
+        } else {
+            stats_thread.detach();
+        }
+    }
+    if (stats_fd >= 0) {
+        close(stats_fd);
+        unlink(config.stats_socket.c_str());
     }
-    g_diretta->disable();
-    g_diretta.reset();
 
-    close(fifo_fd);
+    std::vector<uint64_t> total_frames, total_bytes;
+    for (auto& zone : g_zones) {
+        total_frames.push_back(zone->pipeline->totalFrames());
+        total_bytes.push_back(zone->pipeline->totalBytes());
+        for (auto& sync : zone->syncs) {
+            if (sync->isOpen()) sync->close();
+        }
 
-    if (squeezelite_pid > 0) {
-        kill(squeezelite_pid, SIGTERM);
-        waitpid(squeezelite_pid, nullptr, 0);
+        // Before the pipeline: a --read-ahead reader may be blocked on the
+        // pipe until squeezelite exits
+        if (zone->child) {
+            kill(zone->child->pid, SIGTERM);
+            reap_squeezelite(*zone->child);
+        }
+        zone->pipeline.reset();
+    }
+    disable_all();
+    for (size_t z = 0; z < g_zones.size(); z++) {
+        g_zones[z]->syncs.clear();
+        g_zones[z]->child.reset();
+    }
+    if (record_fd >= 0) {
+        close(record_fd);
     }
 
     if (g_logRing) {
@@ -883,8 +1295,10 @@ int main(int argc, char* argv[]) {
     }
 
     LOG_INFO("Stopped");
-    LOG_INFO("Total streamed: " << total_frames << " frames ("
-              << (total_bytes / 1024 / 1024) << " MB)");
+    for (size_t z = 0; z < g_zones.size(); z++) {
+        LOG_INFO(g_zones[z]->label << "Total streamed: " << total_frames[z] << " frames ("
+                  << (total_bytes[z] / 1024 / 1024) << " MB)");
+    }
 
-    return 0;
+    return exit_code;
 }
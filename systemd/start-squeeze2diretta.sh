@@ -20,9 +20,15 @@ PLAYER_NAME="${PLAYER_NAME:-squeeze2diretta}"
 MAX_SAMPLE_RATE="${MAX_SAMPLE_RATE:-768000}"
 DSD_FORMAT="${DSD_FORMAT:-u32be}"
 PAUSE_ON_START="${PAUSE_ON_START:-no}"
-SAMPLE_FORMAT="${SAMPLE_FORMAT:-32}"
+SAMPLE_FORMAT="${SAMPLE_FORMAT:-}"
 WAV_HEADER="${WAV_HEADER:-no}"
 VERBOSE="${VERBOSE:-}"
+SINK_CACHE="${SINK_CACHE-$INSTALL_DIR/sink-cache}"
+DISCOVERY_CACHE="${DISCOVERY_CACHE-$INSTALL_DIR/discovery-cache}"
+IDLE_TIMEOUT="${IDLE_TIMEOUT:-0}"
+MAX_RESTARTS="${MAX_RESTARTS:-5}"
+ZONES="${ZONES:-}"
+CPU_PLAN="${CPU_PLAN:-}"
 EXTRA_OPTS="${EXTRA_OPTS:-}"
 SQUEEZE2DIRETTA="$INSTALL_DIR/squeeze2diretta"
 SQUEEZELITE="$INSTALL_DIR/squeezelite"
@@ -44,8 +50,8 @@ elif [ "$DSD_FORMAT" = "u32be" ] || [ "$DSD_FORMAT" = "u32le" ]; then
     CMD="$CMD -D :$DSD_FORMAT"
 fi
 
-# PCM sample format (bit depth)
-if [ "$SAMPLE_FORMAT" != "32" ] && [ -n "$SAMPLE_FORMAT" ]; then
+# PCM sample format (bit depth, empty = what the target takes)
+if [ -n "$SAMPLE_FORMAT" ]; then
     CMD="$CMD -a $SAMPLE_FORMAT"
 fi
 
@@ -54,6 +60,34 @@ if [ "$WAV_HEADER" = "yes" ] || [ "$WAV_HEADER" = "true" ] || [ "$WAV_HEADER" =
     CMD="$CMD -W"
 fi
 
+# Sink format cache (empty = memory only)
+if [ -n "$SINK_CACHE" ]; then
+    CMD="$CMD --sink-cache $SINK_CACHE"
+fi
+
+# Discovery cache (empty = discover on every start)
+if [ -n "$DISCOVERY_CACHE" ]; then
+    CMD="$CMD --discovery-cache $DISCOVERY_CACHE"
+fi
+
+# Release the target after this much silence (0 = stay connected)
+if [ "$IDLE_TIMEOUT" != "0" ]; then
+    CMD="$CMD --idle-timeout $IDLE_TIMEOUT"
+fi
+
+# Restart a crashed squeezelite this many times in a row (0 = exit with it)
+CMD="$CMD --max-restarts $MAX_RESTARTS"
+
+# Further players in this process (<name>:<targets>[:<mac>], space-separated)
+for ZONE in $ZONES; do
+    CMD="$CMD --zone $ZONE"
+done
+
+# CPUs for every zone's threads (empty = unpinned)
+if [ -n "$CPU_PLAN" ]; then
+    CMD="$CMD --cpu-plan $CPU_PLAN"
+fi
+
 # Log verbosity (-v for debug, -q for quiet)
 if [ -n "$VERBOSE" ]; then
     CMD="$CMD $VERBOSE"
@@ -72,10 +106,13 @@ echo ""
 echo "Configuration:"
 echo "  LMS Server:       $LMS_SERVER"
 echo "  Diretta Target:   $TARGET"
+if [ -n "$ZONES" ]; then
+    echo "  Zones:            $ZONES"
+fi
 echo "  Player Name:      $PLAYER_NAME"
 echo "  Max Sample Rate:  $MAX_SAMPLE_RATE"
 echo "  DSD Format:       $DSD_FORMAT"
-echo "  Sample Format:    ${SAMPLE_FORMAT}-bit"
+echo "  Sample Format:    ${SAMPLE_FORMAT:-auto}"
 echo "  WAV Header:       $WAV_HEADER"
 echo "  Pause on Start:   $PAUSE_ON_START"
 echo ""
@@ -0,0 +1,71 @@
+/**
+ * @file FormatHeader.h
+ * @brief In-band SQFH format header (must match squeezelite output_stdout.c)
+ *
+ * v1: a 16-byte header is written only when the format changes; audio
+ *     follows unframed, so the reader has to scan for the next header.
+ * v2: same 16 bytes, but every audio chunk is preceded by a header whose
+ *     frame_info carries the payload length. Format changes are headers
+ *     with SQFH_FLAG_FORMAT and no payload. No scanning needed.
+ *     A format header that also carries SQFH_FLAG_FLUSH marks a skip or
+ *     seek: audio before it is stale and should not be played out.
+ *
+ * PCM bit_depth is the width on the wire: 32 = S32_LE, 24 = S24_3LE
+ * (packed), 16 = S16_LE. DSD (native and DoP) is always 32-bit words.
+ */
+
+#ifndef SQUEEZE2DIRETTA_FORMAT_HEADER_H
+#define SQUEEZE2DIRETTA_FORMAT_HEADER_H
+
+#include <cstdint>
+
+struct __attribute__((packed)) SqFormatHeader {
+    uint8_t  magic[4];       // "SQFH"
+    uint8_t  version;        // Protocol version: 1 or 2
+    uint8_t  channels;       // 2 for stereo
+    uint8_t  bit_depth;      // PCM: 16/24/32, DSD: 1, DoP: 24
+    uint8_t  dsd_format;     // 0=PCM, 1=DOP, 2=DSD_U32_LE, 3=DSD_U32_BE
+    uint32_t sample_rate;    // Sample/frame rate in Hz (LE)
+    uint32_t frame_info;     // v2: bits 0-23 payload bytes, bits 24-31 flags (LE). v1: zero
+};
+
+static_assert(sizeof(SqFormatHeader) == 16, "SqFormatHeader must be 16 bytes");
+
+static constexpr uint8_t SQFH_MAGIC[4] = {'S', 'Q', 'F', 'H'};
+
+// First version with length-framed chunks
+static constexpr uint8_t SQFH_VERSION_FRAMED = 2;
+
+// frame_info layout (v2)
+static constexpr uint32_t SQFH_PAYLOAD_MASK = 0x00FFFFFF;
+static constexpr uint32_t SQFH_FLAG_FORMAT  = 0x01000000;  // Format/track boundary, no payload
+static constexpr uint32_t SQFH_FLAG_FLUSH   = 0x02000000;  // With FORMAT: squeezelite flushed (skip/seek/stop)
+
+inline uint32_t sqfhPayloadBytes(const SqFormatHeader& hdr) {
+    return hdr.frame_info & SQFH_PAYLOAD_MASK;
+}
+
+inline bool sqfhIsFormatHeader(const SqFormatHeader& hdr) {
+    return hdr.version < SQFH_VERSION_FRAMED || (hdr.frame_info & SQFH_FLAG_FORMAT) != 0;
+}
+
+inline bool sqfhIsFlush(const SqFormatHeader& hdr) {
+    return hdr.version >= SQFH_VERSION_FRAMED &&
+           (hdr.frame_info & (SQFH_FLAG_FORMAT | SQFH_FLAG_FLUSH)) == (SQFH_FLAG_FORMAT | SQFH_FLAG_FLUSH);
+}
+
+// Bytes per sample on the wire
+inline uint32_t sqfhBytesPerSample(const SqFormatHeader& hdr) {
+    if (hdr.dsd_format != 0) return 4;
+    return hdr.bit_depth == 16 ? 2 : hdr.bit_depth == 24 ? 3 : 4;
+}
+
+// DSD format types (from header dsd_format field)
+enum class DSDFormatType : uint8_t {
+    NONE   = 0,  // PCM
+    DOP    = 1,  // DSD over PCM
+    U32_LE = 2,  // Native DSD Little Endian
+    U32_BE = 3   // Native DSD Big Endian
+};
+
+#endif // SQUEEZE2DIRETTA_FORMAT_HEADER_H
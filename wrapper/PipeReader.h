@@ -0,0 +1,501 @@
+/**
+ * @file PipeReader.h
+ * @brief Buffered reader for squeezelite's SQFH-framed stdout stream
+ *
+ * Hands audio to the caller in whole frames and stops at format headers.
+ * v2 streams are length-framed: chunk headers are consumed here and the
+ * audio is read with readv() straight into the caller's memory. v1 streams
+ * have no framing, so the audio is scanned for the next "SQFH" magic.
+ *
+ * The source is either the squeezelite stdout pipe or a ShmRing.
+ */
+
+#ifndef SQUEEZE2DIRETTA_PIPE_READER_H
+#define SQUEEZE2DIRETTA_PIPE_READER_H
+
+#include "FormatHeader.h"
+#include "ShmRing.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <sys/uio.h>
+#include <unistd.h>
+
+// SIMD magic search (v1 streams). Same conditions as DirettaRingBuffer.h:
+// x86-64-v2 builds fall back to memchr.
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__AVX2__)
+    #include <immintrin.h>
+    #define PIPE_READER_SCAN_AVX2 1
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+    #include <arm_neon.h>
+    #define PIPE_READER_SCAN_NEON 1
+#endif
+
+class PipeReader {
+public:
+    // Outcome of readAudio()
+    enum class ReadResult {
+        Audio,   // Audio bytes were delivered to the caller
+        Header,  // Next bytes in the stream are a format header
+        Eof,     // Pipe closed
+        Error    // read() failed (errno is preserved)
+    };
+
+    explicit PipeReader(int fd) : m_fd(fd), m_pos(0), m_len(0) {}
+
+    // Read from the shared-memory transport instead of a file descriptor
+    explicit PipeReader(ShmRing* ring) : m_fd(-1), m_ring(ring), m_pos(0), m_len(0) {}
+
+    /**
+     * Read the next format header (blocking). Returns false on EOF/error.
+     * The caller validates the magic; the header version selects framed
+     * (v2) or scanned (v1) reads for the audio that follows.
+     */
+    bool readHeader(SqFormatHeader& hdr) {
+        if (!readExact(&hdr, sizeof(hdr))) return false;
+        if (!isMagic(hdr.magic)) return true;
+
+        m_framed = hdr.version >= SQFH_VERSION_FRAMED;
+        m_payloadRemaining = m_framed ? sqfhPayloadBytes(hdr) : 0;
+        return true;
+    }
+
+    // True once a v2 (length-framed) header has been seen
+    bool framed() const { return m_framed; }
+
+    /**
+     * Copy every byte read from the source (headers and audio, exactly as
+     * squeezelite wrote them) to fd, for offline replay. Pass -1 to stop.
+     * Writes are blocking: meant for diagnostics, not for production runs.
+     */
+    void setTee(int fd) { m_teeFd = fd; }
+
+    /**
+     * Offset of the first full SQFH magic in p[from..len), or len if none.
+     *
+     * SIMD builds filter blocks for 'S' and only then compare all four
+     * magic bytes per lane, so silence and stray 'S' bytes cost no branch
+     * per byte. The tail and non-SIMD builds use memchr for 'S' followed
+     * by a compare.
+     */
+    static size_t findMagic(const uint8_t* p, size_t len, size_t from) {
+        size_t i = from;
+
+#if defined(PIPE_READER_SCAN_AVX2)
+        const __m256i s = _mm256_set1_epi8('S');
+        const __m256i q = _mm256_set1_epi8('Q');
+        const __m256i f = _mm256_set1_epi8('F');
+        const __m256i h = _mm256_set1_epi8('H');
+        auto match32 = [&](size_t at) -> uint32_t {
+            const __m256i* v = reinterpret_cast<const __m256i*>(p + at);
+            __m256i m0 = _mm256_cmpeq_epi8(_mm256_loadu_si256(v), s);
+            __m256i m1 = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + at + 1)), q);
+            __m256i m2 = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + at + 2)), f);
+            __m256i m3 = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + at + 3)), h);
+            __m256i m = _mm256_and_si256(_mm256_and_si256(m0, m1), _mm256_and_si256(m2, m3));
+            return static_cast<uint32_t>(_mm256_movemask_epi8(m));
+        };
+        for (; i + 64 + 3 <= len; i += 64) {
+            // Cheap 'S' pre-filter over 64 bytes; full compare only on a hit
+            __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+            __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i + 32));
+            __m256i any = _mm256_or_si256(_mm256_cmpeq_epi8(a, s), _mm256_cmpeq_epi8(b, s));
+            if (_mm256_testz_si256(any, any)) continue;
+
+            if (uint32_t bits = match32(i)) return i + static_cast<size_t>(__builtin_ctz(bits));
+            if (uint32_t bits = match32(i + 32)) return i + 32 + static_cast<size_t>(__builtin_ctz(bits));
+        }
+        for (; i + 32 + 3 <= len; i += 32) {
+            if (uint32_t bits = match32(i)) return i + static_cast<size_t>(__builtin_ctz(bits));
+        }
+#elif defined(PIPE_READER_SCAN_NEON)
+        const uint8x16_t s = vdupq_n_u8('S');
+        const uint8x16_t q = vdupq_n_u8('Q');
+        const uint8x16_t f = vdupq_n_u8('F');
+        const uint8x16_t h = vdupq_n_u8('H');
+        for (; i + 16 + 3 <= len; i += 16) {
+            uint8x16_t m0 = vceqq_u8(vld1q_u8(p + i), s);
+            // Narrow to 4 bits per byte lane to get a 64-bit movemask
+            if (vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(m0), 4)), 0) == 0) {
+                continue;  // No 'S' in this block
+            }
+            uint8x16_t m = vandq_u8(
+                vandq_u8(m0, vceqq_u8(vld1q_u8(p + i + 1), q)),
+                vandq_u8(vceqq_u8(vld1q_u8(p + i + 2), f), vceqq_u8(vld1q_u8(p + i + 3), h)));
+            uint64_t bits = vget_lane_u64(vreinterpret_u64_u8(
+                vshrn_n_u16(vreinterpretq_u16_u8(m), 4)), 0);
+            if (bits) return i + static_cast<size_t>(__builtin_ctzll(bits) >> 2);
+        }
+#endif
+
+        while (i + sizeof(SQFH_MAGIC) <= len) {
+            const void* c = memchr(p + i, SQFH_MAGIC[0], len - i - (sizeof(SQFH_MAGIC) - 1));
+            if (!c) break;
+            i = static_cast<size_t>(static_cast<const uint8_t*>(c) - p);
+            if (p[i + 1] == 'Q' && p[i + 2] == 'F' && p[i + 3] == 'H') return i;
+            i++;
+        }
+        return len;
+    }
+
+    /**
+     * Read up to n bytes of audio into dst, in whole multiples of granule
+     * (one frame). Never consumes a format header.
+     *
+     * When the internal buffer is empty the pipe is read straight into dst,
+     * so the caller can pass ring buffer memory and avoid any intermediate
+     * copy. Bytes that can't be handed out yet (partial frame, next header)
+     * stay in the internal buffer and are served on the next call.
+     */
+    ReadResult readAudio(uint8_t* dst, size_t n, size_t granule, size_t& got) {
+        if (granule == 0) granule = 1;
+        return m_framed ? readFramed(dst, n, granule, got)
+                        : readScanned(dst, n, granule, got);
+    }
+
+private:
+    // Read exactly n bytes (blocking). Returns false on EOF/error.
+    bool readExact(void* dst, size_t n) {
+        uint8_t* out = static_cast<uint8_t*>(dst);
+        size_t remaining = n;
+
+        while (remaining > 0) {
+            // Serve from internal buffer first
+            size_t avail = m_len - m_pos;
+            if (avail > 0) {
+                size_t chunk = std::min(avail, remaining);
+                memcpy(out, m_buf + m_pos, chunk);
+                m_pos += chunk;
+                out += chunk;
+                remaining -= chunk;
+                continue;
+            }
+
+            // Buffer empty — refill from pipe
+            ssize_t n_read = sourceRead(m_buf, sizeof(m_buf));
+            if (n_read <= 0) return false;  // EOF or error
+            m_pos = 0;
+            m_len = static_cast<size_t>(n_read);
+        }
+        return true;
+    }
+
+    //=========================================================================
+    // v2: length-framed chunks
+    //=========================================================================
+
+    ReadResult readFramed(uint8_t* dst, size_t n, size_t granule, size_t& got) {
+        got = 0;
+        // Keep the worst-case spill of one scatter read within m_buf
+        n = std::min(n, sizeof(m_buf) / 2);
+        n -= n % granule;
+        ReadResult status = ReadResult::Audio;
+
+        while (got < n) {
+            if (m_payloadRemaining == 0) {
+                // Chunk header next - don't block on it with audio in hand
+                if (got >= granule && m_len - m_pos < sizeof(SqFormatHeader)) break;
+
+                ReadResult r = ensureBuffered(sizeof(SqFormatHeader));
+                if (r != ReadResult::Audio) {
+                    status = r;
+                    break;
+                }
+
+                SqFormatHeader hdr;
+                memcpy(&hdr, m_buf + m_pos, sizeof(hdr));
+                if (!isMagic(hdr.magic) || sqfhIsFormatHeader(hdr)) {
+                    // Format change (or desync) - the caller reads it
+                    status = ReadResult::Header;
+                    break;
+                }
+                m_pos += sizeof(hdr);
+                m_payloadRemaining = sqfhPayloadBytes(hdr);
+                continue;
+            }
+
+            size_t want = std::min(n - got, m_payloadRemaining);
+            size_t avail = m_len - m_pos;
+            if (avail > 0) {
+                size_t chunk = std::min(want, avail);
+                memcpy(dst + got, m_buf + m_pos, chunk);
+                m_pos += chunk;
+                got += chunk;
+                m_payloadRemaining -= chunk;
+                continue;
+            }
+
+            if (got >= granule) break;  // One blocking read per call
+            if (m_eof) {
+                status = ReadResult::Eof;
+                break;
+            }
+
+            // Scatter read: rest of this chunk into dst, the next header
+            // into m_buf, and the audio after it back into dst. If dst
+            // can't hold the rest of the chunk, read only into dst.
+            bool chunkEnds = (want == m_payloadRemaining);
+            size_t after = chunkEnds ? n - got - want : 0;
+            struct iovec iov[3] = {
+                { dst + got, want },
+                { m_buf, sizeof(SqFormatHeader) },
+                { dst + got + want, after },
+            };
+            m_pos = 0;
+            m_len = 0;
+
+            int iovcnt = !chunkEnds ? 1 : (after > 0 ? 3 : 2);
+            ssize_t n_read = sourceReadv(iov, iovcnt);
+            if (n_read < 0) {
+                status = ReadResult::Error;
+                break;
+            }
+            if (n_read == 0) {
+                m_eof = true;
+                status = ReadResult::Eof;
+                break;
+            }
+
+            size_t len = static_cast<size_t>(n_read);
+            if (len <= want) {
+                got += len;
+                m_payloadRemaining -= len;
+                continue;
+            }
+
+            got += want;
+            m_payloadRemaining = 0;
+            m_len = std::min(len - want, sizeof(SqFormatHeader));
+            size_t extra = len - want - m_len;
+            if (extra == 0) continue;
+
+            // Full header received and audio after it landed in dst
+            uint8_t* spill = dst + got;
+            SqFormatHeader hdr;
+            memcpy(&hdr, m_buf, sizeof(hdr));
+            if (isMagic(hdr.magic) && !sqfhIsFormatHeader(hdr)) {
+                size_t payload = sqfhPayloadBytes(hdr);
+                size_t take = std::min(extra, payload);
+                m_len = 0;  // Header consumed
+                got += take;
+                m_payloadRemaining = payload - take;
+                spill += take;
+                extra -= take;
+            }
+
+            // Whatever is past that chunk goes back behind the buffered bytes
+            if (extra > 0) {
+                memmove(m_buf + m_len, spill, extra);
+                m_len += extra;
+            }
+        }
+
+        size_t partial = got % granule;
+        if (partial > 0) {
+            if (status == ReadResult::Audio) {
+                // Frame continues in the next chunk - keep it for the next call
+                pushBack(dst + got - partial, partial);
+            }
+            // else: stray bytes before a format change/EOF can't be completed
+            got -= partial;
+        }
+
+        return got > 0 ? ReadResult::Audio : status;
+    }
+
+    // Return payload bytes to the front of the stream
+    void pushBack(const uint8_t* p, size_t k) {
+        if (m_pos >= k) {
+            m_pos -= k;
+        } else {
+            memmove(m_buf + k, m_buf + m_pos, m_len - m_pos);
+            m_len = m_len - m_pos + k;
+            m_pos = 0;
+        }
+        memcpy(m_buf + m_pos, p, k);
+        m_payloadRemaining += k;
+    }
+
+    // Block until at least k bytes are buffered
+    ReadResult ensureBuffered(size_t k) {
+        while (m_len - m_pos < k) {
+            ReadResult r = fill();
+            if (r != ReadResult::Audio) return r;
+        }
+        return ReadResult::Audio;
+    }
+
+    //=========================================================================
+    // v1: unframed audio, scan for the next header
+    //=========================================================================
+
+    ReadResult readScanned(uint8_t* dst, size_t n, size_t granule, size_t& got) {
+        got = 0;
+        size_t minBytes = std::max(granule, sizeof(SQFH_MAGIC));
+
+        while (true) {
+            size_t avail = m_len - m_pos;
+
+            if (avail > 0) {
+                if (avail >= sizeof(SQFH_MAGIC) && isMagic(m_buf + m_pos)) {
+                    return ReadResult::Header;
+                }
+                if (avail < minBytes && !m_eof) {
+                    ReadResult r = fill();
+                    if (r != ReadResult::Audio) return r;
+                    continue;
+                }
+
+                // Serve from internal buffer, stopping before any header
+                size_t span = audioSpan(m_buf + m_pos, avail, 1);
+                size_t chunk = std::min(span, n);
+                chunk -= chunk % granule;
+                if (chunk == 0 && m_eof) {
+                    // No more data is coming - nothing can complete the frame
+                    return ReadResult::Eof;
+                }
+                if (chunk > 0) {
+                    memcpy(dst, m_buf + m_pos, chunk);
+                    m_pos += chunk;
+                    got = chunk;
+                    return ReadResult::Audio;
+                }
+
+                if (span + sizeof(SQFH_MAGIC) <= avail) {
+                    // Less than one frame before a header - drop the stray bytes
+                    m_pos += span;
+                    continue;
+                }
+
+                // Partial frame or possible header prefix - need more data
+                ReadResult r = fill();
+                if (r != ReadResult::Audio) return r;
+                continue;
+            }
+
+            // Buffer empty — read the pipe straight into the caller's memory
+            size_t want = std::min(n, sizeof(m_buf));
+            want -= want % granule;
+            if (m_eof) return ReadResult::Eof;
+            if (want < minBytes) {
+                ReadResult r = fill();
+                if (r != ReadResult::Audio) return r;
+                continue;
+            }
+
+            ssize_t n_read = sourceRead(dst, want);
+            if (n_read == 0) {
+                m_eof = true;
+                return ReadResult::Eof;
+            }
+            if (n_read < 0) return ReadResult::Error;
+
+            size_t len = static_cast<size_t>(n_read);
+            size_t body = audioSpan(dst, len, 0);
+            body -= body % granule;
+
+            // Hand back whatever must not be treated as audio yet
+            if (body < len) {
+                memcpy(m_buf, dst + body, len - body);
+                m_pos = 0;
+                m_len = len - body;
+            }
+            if (body == 0) continue;
+
+            got = body;
+            return ReadResult::Audio;
+        }
+    }
+
+    static bool isMagic(const uint8_t* p) {
+        return memcmp(p, SQFH_MAGIC, sizeof(SQFH_MAGIC)) == 0;
+    }
+
+    // Length of the audio prefix of p[0..len): stops at the first full
+    // SQFH magic at or after offset `from`, or (until EOF) at a trailing
+    // 1-3 byte prefix of the magic that a following read could complete.
+    size_t audioSpan(const uint8_t* p, size_t len, size_t from) const {
+        size_t at = findMagic(p, len, from);
+        if (at < len || m_eof) return at;
+
+        size_t tail = std::min(len, sizeof(SQFH_MAGIC) - 1);
+        for (size_t k = tail; k > 0; k--) {
+            if (len - k >= from && memcmp(p + len - k, SQFH_MAGIC, k) == 0) {
+                return len - k;
+            }
+        }
+        return len;
+    }
+
+    // Compact the buffer and append whatever the pipe has
+    ReadResult fill() {
+        if (m_eof) return ReadResult::Eof;
+
+        size_t avail = m_len - m_pos;
+        if (avail > 0 && m_pos > 0) {
+            memmove(m_buf, m_buf + m_pos, avail);
+        }
+        m_pos = 0;
+        m_len = avail;
+
+        ssize_t n_read = sourceRead(m_buf + m_len, sizeof(m_buf) - m_len);
+        if (n_read < 0) return ReadResult::Error;
+        if (n_read == 0) {
+            // Leave buffered frames to be drained by readAudio()
+            m_eof = true;
+            return ReadResult::Audio;
+        }
+        m_len += static_cast<size_t>(n_read);
+        return ReadResult::Audio;
+    }
+
+    // Pipe (fd) or shared-memory ring, same semantics
+    ssize_t sourceRead(void* dst, size_t n) {
+        ssize_t got = m_ring ? m_ring->read(dst, n) : ::read(m_fd, dst, n);
+        if (m_teeFd >= 0 && got > 0) {
+            struct iovec v = { dst, static_cast<size_t>(got) };
+            tee(&v, 1, static_cast<size_t>(got));
+        }
+        return got;
+    }
+    ssize_t sourceReadv(const struct iovec* iov, int iovcnt) {
+        ssize_t got = m_ring ? m_ring->readv(iov, iovcnt) : ::readv(m_fd, iov, iovcnt);
+        if (m_teeFd >= 0 && got > 0) tee(iov, iovcnt, static_cast<size_t>(got));
+        return got;
+    }
+
+    // Write the first n bytes of iov to the tee; the recording is dropped
+    // on a write error rather than stalling the stream
+    void tee(const struct iovec* iov, int iovcnt, size_t n) {
+        for (int i = 0; i < iovcnt && n > 0; i++) {
+            const uint8_t* p = static_cast<const uint8_t*>(iov[i].iov_base);
+            size_t left = std::min(iov[i].iov_len, n);
+            n -= left;
+            while (left > 0) {
+                ssize_t w = ::write(m_teeFd, p, left);
+                if (w < 0 && errno == EINTR) continue;
+                if (w <= 0) {
+                    m_teeFd = -1;
+                    return;
+                }
+                p += w;
+                left -= static_cast<size_t>(w);
+            }
+        }
+    }
+
+    int m_fd;
+    ShmRing* m_ring = nullptr;
+    int m_teeFd = -1;
+    size_t m_pos;
+    size_t m_len;
+    bool m_eof = false;
+    bool m_framed = false;
+    size_t m_payloadRemaining = 0;   // v2: audio bytes before the next chunk header
+    uint8_t m_buf[65536];
+};
+
+#endif // SQUEEZE2DIRETTA_PIPE_READER_H
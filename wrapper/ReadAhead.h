@@ -0,0 +1,309 @@
+/**
+ * @file ReadAhead.h
+ * @brief Reader thread + chunk pool between PipeReader and StreamPipeline
+ *
+ * Without it the main loop is serial: a slow pipe read (squeezelite
+ * decoding or upsampling) delays the next push into the ring, and a push
+ * waiting on flow control leaves the pipe unread. With --read-ahead a
+ * dedicated thread reads the pipe into a pool of fixed 16 KB chunks and
+ * StreamPipeline pushes them into the ring. The chunks absorb decode
+ * hiccups without enlarging the DirettaSync ring or its prefill.
+ *
+ * The pool is a single-producer/single-consumer ring of chunk slots
+ * (positions as in LogRing). A slot holds audio, a format header, or the
+ * end of the stream. A side that finds the pool empty (or full) sleeps on
+ * a futex instead of polling. The chunks are allocated and written once,
+ * in the constructor, so they are resident under --rt-memory.
+ *
+ * After start() only the reader thread touches the PipeReader, including
+ * its --record tee. A supervised pipeline keeps one ReadAhead for its
+ * lifetime and restart()s it on each new squeezelite.
+ *
+ * The reader counts flush markers as it queues them (flushSeq()), so the
+ * consumer can drop the stale chunks ahead of one without pushing them.
+ */
+
+#ifndef SQUEEZE2DIRETTA_READ_AHEAD_H
+#define SQUEEZE2DIRETTA_READ_AHEAD_H
+
+#include "FormatHeader.h"
+#include "Futex.h"
+#include "PipeReader.h"
+#include "ThreadTuning.h"
+
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <thread>
+#include <time.h>
+#include <unistd.h>
+#include <vector>
+
+class ReadAhead {
+public:
+    static constexpr size_t CHUNK_BYTES = 16384;
+    static constexpr size_t MIN_CHUNKS = 4;
+
+    using ReadResult = PipeReader::ReadResult;
+
+    /**
+     * @param bytes Pool size, rounded up to a power-of-two number of chunks
+     */
+    ReadAhead(PipeReader& reader, size_t bytes)
+        : m_reader(&reader) {
+        size_t count = MIN_CHUNKS;
+        while (count * CHUNK_BYTES < bytes) count *= 2;
+        m_slots.resize(count);
+        m_mask = static_cast<uint32_t>(count - 1);
+        m_data.assign(count * CHUNK_BYTES, 0);
+    }
+
+    ~ReadAhead() { stop(); }
+
+    ReadAhead(const ReadAhead&) = delete;
+    ReadAhead& operator=(const ReadAhead&) = delete;
+
+    void start(const ThreadTuning& tuning) {
+        m_thread = std::thread([this, tuning] {
+            applyThreadTuning("sq2d-reader", "Reader", tuning);
+            readLoop();
+        });
+    }
+
+    /**
+     * Stop and join the reader. It may be blocked in read() on a live
+     * squeezelite, so the caller closes the pipe (kills squeezelite) first.
+     */
+    void stop() {
+        if (!m_thread.joinable()) return;
+        m_stop.store(true, std::memory_order_seq_cst);
+        futexWake(m_readPos);
+        m_thread.join();
+    }
+
+    /**
+     * Continue on a restarted squeezelite's reader once the consumer has
+     * seen the end of the old stream. The pool is reused in place (the
+     * stats thread may be reading it) and starts empty; the stats keep
+     * counting across restarts.
+     */
+    void restart(PipeReader& reader, const ThreadTuning& tuning) {
+        stop();
+        m_reader = &reader;
+        m_writePos.store(0, std::memory_order_relaxed);
+        m_readPos.store(0, std::memory_order_relaxed);
+        m_flushSeq.store(0, std::memory_order_relaxed);
+        m_stop.store(false, std::memory_order_relaxed);
+        start(tuning);
+    }
+
+    size_t capacityBytes() const { return m_slots.size() * CHUNK_BYTES; }
+
+    // Flush markers queued so far
+    uint32_t flushSeq() const { return m_flushSeq.load(std::memory_order_acquire); }
+
+    //=========================================================================
+    // Consumer (StreamPipeline::run() thread)
+    //=========================================================================
+
+    /**
+     * Next format header (blocking), as PipeReader::readHeader(). Audio
+     * left over from the previous format is dropped.
+     */
+    bool readHeader(SqFormatHeader& hdr) {
+        while (true) {
+            Slot& s = front();
+            if (s.kind == Slot::Audio) {
+                release();
+                continue;
+            }
+            if (s.kind != Slot::Header) return false;
+            hdr = s.hdr;
+            release();
+            return true;
+        }
+    }
+
+    /**
+     * Next chunk of audio (blocking): whole frames of the current format.
+     * The data stays valid until release(). Header, Eof and Error are not
+     * consumed, so they are returned again until readHeader().
+     */
+    ReadResult next(const uint8_t*& data, size_t& len) {
+        Slot& s = front();
+        switch (s.kind) {
+            case Slot::Audio:
+                data = &m_data[(m_readPos.load(std::memory_order_relaxed) & m_mask) * CHUNK_BYTES];
+                len = s.len;
+                return ReadResult::Audio;
+            case Slot::Header:
+                return ReadResult::Header;
+            case Slot::Error:
+                errno = s.err;
+                return ReadResult::Error;
+            default:
+                return ReadResult::Eof;
+        }
+    }
+
+    void release() {
+        m_readPos.store(m_readPos.load(std::memory_order_relaxed) + 1, std::memory_order_seq_cst);
+        if (m_readerWaiting.load(std::memory_order_seq_cst)) {
+            futexWake(m_readPos);
+        }
+    }
+
+    // {"chunks":N,"chunk_bytes":N,"max_fill":N,"full_waits":N,"empty_waits":N}
+    void writeStatsJson(std::ostream& os) const {
+        os << "{\"chunks\":" << m_slots.size()
+           << ",\"chunk_bytes\":" << CHUNK_BYTES
+           << ",\"max_fill\":" << m_maxFill.load(std::memory_order_relaxed)
+           << ",\"full_waits\":" << m_fullWaits.load(std::memory_order_relaxed)
+           << ",\"empty_waits\":" << m_emptyWaits.load(std::memory_order_relaxed) << "}";
+    }
+
+private:
+    struct Slot {
+        enum Kind { Audio, Header, Eof, Error };
+        Kind kind = Eof;
+        int err = 0;
+        size_t len = 0;
+        SqFormatHeader hdr;
+    };
+
+    // Oldest published slot; sleeps while the pool is empty
+    Slot& front() {
+        uint32_t r = m_readPos.load(std::memory_order_relaxed);
+        uint32_t w = m_writePos.load(std::memory_order_acquire);
+        while (w == r) {
+            m_consumerWaiting.store(1, std::memory_order_seq_cst);
+            w = m_writePos.load(std::memory_order_seq_cst);
+            if (w == r) {
+                m_emptyWaits.fetch_add(1, std::memory_order_relaxed);
+                futexWait(m_writePos, w);
+            }
+            m_consumerWaiting.store(0, std::memory_order_relaxed);
+            w = m_writePos.load(std::memory_order_acquire);
+        }
+        return m_slots[r & m_mask];
+    }
+
+    //=========================================================================
+    // Producer (reader thread)
+    //=========================================================================
+
+    // Free slot to fill, or -1 once stop() was called
+    int64_t acquire() {
+        if (m_stop.load(std::memory_order_acquire)) return -1;
+        uint32_t w = m_writePos.load(std::memory_order_relaxed);
+        if (w - m_readPos.load(std::memory_order_acquire) > m_mask) {
+            m_fullWaits.fetch_add(1, std::memory_order_relaxed);
+        }
+        while (w - m_readPos.load(std::memory_order_acquire) > m_mask) {
+            m_readerWaiting.store(1, std::memory_order_seq_cst);
+            uint32_t r = m_readPos.load(std::memory_order_seq_cst);
+            if (w - r > m_mask && !m_stop.load(std::memory_order_seq_cst)) {
+                // Timed: a stop() between the check and the wait has no
+                // position change to wake us with
+                const struct timespec timeout = { 0, 100 * 1000 * 1000 };
+                futexWait(m_readPos, r, &timeout);
+            }
+            m_readerWaiting.store(0, std::memory_order_relaxed);
+            if (m_stop.load(std::memory_order_acquire)) return -1;
+        }
+        return static_cast<int64_t>(w & m_mask);
+    }
+
+    void publish() {
+        uint32_t w = m_writePos.load(std::memory_order_relaxed) + 1;
+        m_writePos.store(w, std::memory_order_seq_cst);
+        if (m_consumerWaiting.load(std::memory_order_seq_cst)) {
+            futexWake(m_writePos);
+        }
+        uint32_t fill = w - m_readPos.load(std::memory_order_relaxed);
+        if (fill > m_maxFill.load(std::memory_order_relaxed)) {
+            m_maxFill.store(fill, std::memory_order_relaxed);
+        }
+    }
+
+    // Same granule as StreamPipeline::ingestChunk() uses for the format
+    static size_t granuleFor(const SqFormatHeader& hdr) {
+        size_t bytesPerFrame = sqfhBytesPerSample(hdr) * static_cast<size_t>(hdr.channels);
+        return static_cast<DSDFormatType>(hdr.dsd_format) == DSDFormatType::DOP
+            ? 2 * bytesPerFrame : bytesPerFrame;
+    }
+
+    void readLoop() {
+        bool wantHeader = true;
+        size_t granule = 1;
+
+        while (true) {
+            int64_t index = acquire();
+            if (index < 0) return;
+            Slot& s = m_slots[static_cast<size_t>(index)];
+
+            if (wantHeader) {
+                if (!m_reader->readHeader(s.hdr)) {
+                    s.kind = Slot::Eof;
+                    publish();
+                    return;
+                }
+                s.kind = Slot::Header;
+                if (sqfhIsFlush(s.hdr)) {
+                    m_flushSeq.fetch_add(1, std::memory_order_release);
+                }
+                publish();
+                // A bad magic stops the pipeline; don't read past it
+                if (memcmp(s.hdr.magic, SQFH_MAGIC, sizeof(SQFH_MAGIC)) != 0) return;
+                granule = granuleFor(s.hdr);
+                wantHeader = false;
+                continue;
+            }
+
+            size_t got = 0;
+            ReadResult r = m_reader->readAudio(&m_data[static_cast<size_t>(index) * CHUNK_BYTES],
+                                              CHUNK_BYTES, granule, got);
+            if (r == ReadResult::Header) {
+                wantHeader = true;  // Slot stays free for the header
+                continue;
+            }
+            if (r == ReadResult::Audio) {
+                s.kind = Slot::Audio;
+                s.len = got;
+                publish();
+                continue;
+            }
+            s.kind = (r == ReadResult::Eof) ? Slot::Eof : Slot::Error;
+            s.err = errno;
+            publish();
+            return;
+        }
+    }
+
+    PipeReader* m_reader;
+    std::vector<Slot> m_slots;
+    std::vector<uint8_t> m_data;   // Chunk i at i * CHUNK_BYTES
+    uint32_t m_mask = 0;
+    std::thread m_thread;
+    std::atomic<bool> m_stop{false};
+    std::atomic<uint32_t> m_flushSeq{0};
+
+    static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t),
+                  "futex word must be a plain 32-bit integer");
+
+    // Free-running slot counters; fill = write - read
+    alignas(64) std::atomic<uint32_t> m_writePos{0};
+    std::atomic<uint32_t> m_consumerWaiting{0};
+    alignas(64) std::atomic<uint32_t> m_readPos{0};
+    std::atomic<uint32_t> m_readerWaiting{0};
+
+    // Stats (relaxed, read by the stats thread)
+    alignas(64) std::atomic<uint32_t> m_maxFill{0};
+    std::atomic<uint64_t> m_fullWaits{0};    // Pusher behind: ring at high water or slow conversion
+    std::atomic<uint64_t> m_emptyWaits{0};   // Pool ran dry: squeezelite behind
+};
+
+#endif // SQUEEZE2DIRETTA_READ_AHEAD_H
@@ -0,0 +1,278 @@
+/**
+ * @file ShmRing.h
+ * @brief Shared-memory SPSC byte ring between squeezelite and the wrapper
+ *
+ * Optional replacement for the stdout pipe (--transport shm). The wrapper
+ * creates a memfd holding the ring and two eventfds, squeezelite inherits
+ * them (SQ2D_SHM=<memfd>,<data_efd>,<space_efd>) and writes the same SQFH
+ * byte stream into the ring instead of stdout. Steady-state reads are a
+ * plain copy out of shared memory; eventfds are only touched when one
+ * side has to sleep.
+ *
+ * The stdout pipe stays open: its hangup marks squeezelite's exit, and data
+ * on it means squeezelite doesn't know the ring (unpatched build), in which
+ * case the ring falls back to reading the pipe.
+ *
+ * squeezelite also bumps flushSeq when it flushes (skip/seek), before it
+ * writes the flush marker into the stream, so a wrapper blocked on flow
+ * control learns about it without reading up to the marker.
+ *
+ * Layout must match squeezelite-format-header.patch (struct sq_shm_ring).
+ */
+
+#ifndef SQUEEZE2DIRETTA_SHM_RING_H
+#define SQUEEZE2DIRETTA_SHM_RING_H
+
+#include "memcpyfast_audio.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <initializer_list>
+#include <string>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+// Shared header, one cache line per owner
+struct ShmRingHeader {
+    uint8_t  magic[4];                      // "SQRB"
+    uint32_t version;
+    uint32_t capacity;                      // Data bytes, power of two
+    uint32_t dataOffset;                    // From start of mapping
+    std::atomic<uint32_t> attached;         // Set by squeezelite once mapped
+    std::atomic<uint32_t> flushSeq;         // Bumped by squeezelite on each flush
+    uint8_t  pad0[40];
+
+    alignas(64) std::atomic<uint64_t> writePos;      // Producer-owned
+    std::atomic<uint32_t> writerWaiting;             // Producer sleeps on space_efd
+    uint8_t  pad1[52];
+
+    alignas(64) std::atomic<uint64_t> readPos;       // Consumer-owned
+    std::atomic<uint32_t> readerWaiting;             // Consumer sleeps on data_efd
+    uint8_t  pad2[52];
+};
+
+static_assert(sizeof(ShmRingHeader) == 192, "ShmRingHeader layout must match sq_shm_ring");
+static_assert(offsetof(ShmRingHeader, flushSeq) == 20, "flushSeq offset");
+static_assert(offsetof(ShmRingHeader, writePos) == 64, "writePos offset");
+static_assert(offsetof(ShmRingHeader, readPos) == 128, "readPos offset");
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "64-bit atomics must be lock-free");
+
+static constexpr uint8_t SHM_RING_MAGIC[4] = {'S', 'Q', 'R', 'B'};
+static constexpr uint32_t SHM_RING_VERSION = 1;
+static constexpr uint32_t SHM_RING_DATA_OFFSET = 4096;
+
+class ShmRing {
+public:
+    ShmRing() = default;
+    ~ShmRing() { destroy(); }
+
+    ShmRing(const ShmRing&) = delete;
+    ShmRing& operator=(const ShmRing&) = delete;
+
+    /**
+     * Create the memfd ring (capacity rounded up to a power of two) and
+     * its eventfds. hangupFd is the squeezelite stdout pipe (read end).
+     * Returns false with errno set on failure.
+     */
+    bool create(size_t capacity, int hangupFd) {
+        size_t cap = 4096;
+        while (cap < capacity) cap <<= 1;
+
+        // CLOEXEC, so zones forking concurrently don't inherit each other's
+        // rings; the own child clears it after fork (inheritInChild())
+        m_memFd = memfd_create("squeeze2diretta-ring", MFD_CLOEXEC);
+        if (m_memFd < 0) return false;
+
+        m_mapSize = SHM_RING_DATA_OFFSET + cap;
+        if (ftruncate(m_memFd, static_cast<off_t>(m_mapSize)) != 0) return fail();
+
+        void* p = mmap(nullptr, m_mapSize, PROT_READ | PROT_WRITE, MAP_SHARED, m_memFd, 0);
+        if (p == MAP_FAILED) return fail();
+        m_map = static_cast<uint8_t*>(p);
+
+        m_dataFd = eventfd(0, EFD_CLOEXEC);
+        m_spaceFd = eventfd(0, EFD_CLOEXEC);
+        if (m_dataFd < 0 || m_spaceFd < 0) return fail();
+
+        // Fresh memfd pages are zero: only the constant fields need setting
+        m_hdr = reinterpret_cast<ShmRingHeader*>(m_map);
+        memcpy(m_hdr->magic, SHM_RING_MAGIC, sizeof(SHM_RING_MAGIC));
+        m_hdr->version = SHM_RING_VERSION;
+        m_hdr->capacity = static_cast<uint32_t>(cap);
+        m_hdr->dataOffset = SHM_RING_DATA_OFFSET;
+        m_data = m_map + SHM_RING_DATA_OFFSET;
+        m_capacity = cap;
+        m_hangupFd = hangupFd;
+        return true;
+    }
+
+    // Value for squeezelite's SQ2D_SHM environment variable
+    std::string envValue() const {
+        char buf[48];
+        snprintf(buf, sizeof(buf), "%d,%d,%d", m_memFd, m_dataFd, m_spaceFd);
+        return buf;
+    }
+
+    // In the forked child, before exec: keep the ring's fds open across it
+    // (async-signal-safe)
+    void inheritInChild() const {
+        for (int fd : {m_memFd, m_dataFd, m_spaceFd}) {
+            fcntl(fd, F_SETFD, 0);
+        }
+    }
+
+    // Descriptors the child must inherit
+    int memFd() const { return m_memFd; }
+    int dataFd() const { return m_dataFd; }
+    int spaceFd() const { return m_spaceFd; }
+
+    size_t capacity() const { return m_capacity; }
+
+    // True if squeezelite wrote to stdout instead (no ring support)
+    // (set by the thread reading the ring, read by the pipeline's)
+    bool fellBack() const { return m_fallback.load(std::memory_order_acquire); }
+
+    // Flushes squeezelite has signalled so far (0 with builds that don't)
+    uint32_t flushSeq() const {
+        return m_hdr ? m_hdr->flushSeq.load(std::memory_order_acquire) : 0;
+    }
+
+    /**
+     * Blocking scatter read with pipe semantics: waits for at least one
+     * byte, returns what is available up to the iovec total, 0 once
+     * squeezelite has exited and the ring is drained, -1 on error.
+     */
+    ssize_t readv(const struct iovec* iov, int iovcnt) {
+        if (m_fallback.load(std::memory_order_relaxed)) return ::readv(m_hangupFd, iov, iovcnt);
+
+        uint64_t r = m_hdr->readPos.load(std::memory_order_relaxed);
+        uint64_t w = m_hdr->writePos.load(std::memory_order_acquire);
+
+        while (w == r) {
+            int rc = waitForData(r, w);
+            if (rc <= 0) return rc;
+            if (m_fallback.load(std::memory_order_relaxed)) return ::readv(m_hangupFd, iov, iovcnt);
+        }
+
+        size_t avail = static_cast<size_t>(w - r);
+        size_t total = 0;
+        for (int i = 0; i < iovcnt && total < avail; i++) {
+            size_t n = std::min(iov[i].iov_len, avail - total);
+            copyOut(static_cast<uint8_t*>(iov[i].iov_base), r + total, n);
+            total += n;
+        }
+
+        m_hdr->readPos.store(r + total, std::memory_order_seq_cst);
+
+        // Producer sleeping on a full ring: it has space now
+        if (m_hdr->writerWaiting.exchange(0, std::memory_order_seq_cst)) {
+            notify(m_spaceFd);
+        }
+        return static_cast<ssize_t>(total);
+    }
+
+    ssize_t read(void* dst, size_t n) {
+        struct iovec v = { dst, n };
+        return readv(&v, 1);
+    }
+
+private:
+    // Sleep until the producer publishes data (updates w) or exits.
+    // Returns 1 to retry, 0 on EOF, -1 on error.
+    int waitForData(uint64_t r, uint64_t& w) {
+        m_hdr->readerWaiting.store(1, std::memory_order_seq_cst);
+        w = m_hdr->writePos.load(std::memory_order_seq_cst);
+        if (w != r) {
+            m_hdr->readerWaiting.store(0, std::memory_order_relaxed);
+            return 1;
+        }
+
+        struct pollfd fds[2] = {
+            { m_dataFd, POLLIN, 0 },
+            { m_hangupFd, POLLIN, 0 },
+        };
+        int nfds = m_hangupFd >= 0 ? 2 : 1;
+        if (::poll(fds, nfds, -1) < 0) {
+            // Signals (SIGUSR1 stats) must not end the stream
+            return errno == EINTR ? 1 : -1;
+        }
+
+        if (fds[0].revents & POLLIN) {
+            uint64_t v;
+            if (::read(m_dataFd, &v, sizeof(v)) < 0 && errno != EAGAIN) return -1;
+        }
+        m_hdr->readerWaiting.store(0, std::memory_order_relaxed);
+        w = m_hdr->writePos.load(std::memory_order_acquire);
+        if (w != r) return 1;
+
+        if (nfds == 2 && (fds[1].revents & POLLIN)) {
+            if (!m_hdr->attached.load(std::memory_order_acquire)) {
+                // Squeezelite is writing to stdout: the build has no ring support
+                m_fallback.store(true, std::memory_order_release);
+                return 1;
+            }
+            // Attached but something else hit stdout - discard it
+            uint8_t scratch[4096];
+            if (::read(m_hangupFd, scratch, sizeof(scratch)) > 0) return 1;
+        }
+        if (nfds == 2 && (fds[1].revents & (POLLHUP | POLLERR))) {
+            // Writer gone; anything published before exit was seen above
+            return 0;
+        }
+        return 1;
+    }
+
+    void copyOut(uint8_t* dst, uint64_t pos, size_t n) {
+        size_t off = static_cast<size_t>(pos & (m_capacity - 1));
+        size_t first = std::min(n, m_capacity - off);
+        memcpy_audio(dst, m_data + off, first);
+        if (n > first) {
+            memcpy_audio(dst + first, m_data, n - first);
+        }
+    }
+
+    static void notify(int fd) {
+        uint64_t one = 1;
+        ssize_t rc = ::write(fd, &one, sizeof(one));
+        (void)rc;
+    }
+
+    bool fail() {
+        int saved = errno;
+        destroy();
+        errno = saved;
+        return false;
+    }
+
+    void destroy() {
+        if (m_map) munmap(m_map, m_mapSize);
+        if (m_memFd >= 0) ::close(m_memFd);
+        if (m_dataFd >= 0) ::close(m_dataFd);
+        if (m_spaceFd >= 0) ::close(m_spaceFd);
+        m_map = nullptr;
+        m_hdr = nullptr;
+        m_memFd = m_dataFd = m_spaceFd = -1;
+    }
+
+    int m_memFd = -1;
+    int m_dataFd = -1;
+    int m_spaceFd = -1;
+    int m_hangupFd = -1;
+    uint8_t* m_map = nullptr;
+    size_t m_mapSize = 0;
+    ShmRingHeader* m_hdr = nullptr;
+    uint8_t* m_data = nullptr;
+    size_t m_capacity = 0;
+    std::atomic<bool> m_fallback{false};
+};
+
+#endif // SQUEEZE2DIRETTA_SHM_RING_H
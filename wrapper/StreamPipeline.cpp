@@ -0,0 +1,790 @@
+/**
+ * @file StreamPipeline.cpp
+ * @brief SQFH stream -> DirettaSync pipeline (wrapper main loop)
+ */
+
+#include "StreamPipeline.h"
+#include "LogLevel.h"
+#include "ShmRing.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+
+namespace {
+
+constexpr size_t PIPE_BUF_SIZE = 16384;
+
+// What squeezelite writes while stopped or paused: zero PCM samples, or
+// DSD idle bytes (0x69, zeros before the first track) plus DoP markers
+bool isSilence(const uint8_t* data, size_t bytes, DSDFormatType dsdType) {
+    if (dsdType == DSDFormatType::NONE) {
+        uint64_t acc = 0;
+        size_t i = 0;
+        for (; i + 8 <= bytes; i += 8) {
+            uint64_t word;
+            memcpy(&word, data + i, sizeof(word));
+            acc |= word;
+            if (acc != 0) return false;
+        }
+        for (; i < bytes; i++) acc |= data[i];
+        return acc == 0;
+    }
+    bool dop = (dsdType == DSDFormatType::DOP);
+    for (size_t i = 0; i < bytes; i++) {
+        uint8_t b = data[i];
+        if (b == 0x69 || b == 0x00) continue;
+        if (dop && (b == 0x05 || b == 0xFA)) continue;
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+StreamPipeline::StreamPipeline(DirettaSync& sync, PipeReader& reader, std::atomic<bool>& running, int outputBitDepth)
+    : m_sync(sync)
+    , m_reader(&reader)
+    , m_running(running)
+    , m_outputBitDepth(outputBitDepth)
+    , m_audioBuf(PIPE_BUF_SIZE) {
+}
+
+StreamPipeline::StreamPipeline(DirettaSync& sync, std::atomic<bool>& running, int outputBitDepth)
+    : m_sync(sync)
+    , m_reader(nullptr)
+    , m_running(running)
+    , m_outputBitDepth(outputBitDepth)
+    , m_audioBuf(PIPE_BUF_SIZE) {
+}
+
+void StreamPipeline::addTarget(DirettaSync& sync) {
+    FanTarget target;
+    target.sync = &sync;
+    m_fanOut.push_back(target);
+}
+
+void StreamPipeline::enableReadAhead(size_t bytes, const ThreadTuning& tuning) {
+    if (!m_reader) return;
+    m_readAheadTuning = tuning;
+    m_readAhead = std::make_unique<ReadAhead>(*m_reader, bytes);
+    m_readAhead->start(tuning);
+    LOG_INFO("Read-ahead: " << m_readAhead->capacityBytes() / 1024 << " KB on a reader thread");
+}
+
+// ================================================================
+// Supervised source: squeezelite exited and was restarted
+// ================================================================
+// A restarted squeezelite is a new player session: the tail of the lost
+// stream has no continuation, so it is dropped when the pipe closes and
+// the target hears prefill silence (not underruns) until the new stream
+// has buffered. The connection, the SDK worker and the format stay up.
+void StreamPipeline::endSource() {
+    m_sourceEnded = true;
+    if (!m_supervised) {
+        m_running = false;
+        return;
+    }
+    m_sourceLostAt = std::chrono::steady_clock::now();
+    if (m_readAhead) {
+        m_readAhead->stop();  // Its thread stopped at the end of the stream
+    }
+    size_t dropped = m_direttaOpen ? m_sync.flushBuffered() : 0;
+    for (FanTarget& t : m_fanOut) {
+        if (t.open) t.sync->flushBuffered();
+    }
+    LOG_WARN("[Restart] Squeezelite stream lost, keeping the target open"
+             << (dropped > 0 ? " (dropped " + std::to_string(dropped / 1024) + " KB buffered)" : ""));
+}
+
+void StreamPipeline::attach(PipeReader& reader, const ShmRing* ring) {
+    m_reader = &reader;
+    m_shmRing = ring;
+    m_shmFallbackLogged = false;
+    m_flushMarkers = 0;   // New ring and new pool count from zero
+    m_flushRingBytes = 0;
+    m_flushPipeBytes = 0;
+    m_sourceEnded = false;
+    m_sourceRestarts++;
+    if (m_readAhead) {
+        m_readAhead->restart(reader, m_readAheadTuning);
+    }
+}
+
+void StreamPipeline::writeStatsJson(std::ostream& os) const {
+    os << "{\"read_bytes\":";
+    m_readBytes.writeJson(os);
+    os << ",\"read_wait_ns\":";
+    m_readWaitNs.writeJson(os);
+    os << ",\"format_switch_ns\":";
+    m_formatSwitchNs.writeJson(os);
+    if (m_readAhead) {
+        os << ",\"read_ahead\":";
+        m_readAhead->writeStatsJson(os);
+    }
+    os << "}";
+}
+
+// ================================================================
+// Main loop: synchronous header-based format detection
+// ================================================================
+// The patched squeezelite writes a 16-byte "SQFH" format header to
+// stdout only when the format changes (or for the first track).
+// Same-format gapless transitions emit no format header — audio
+// flows uninterrupted. No stderr parsing or race conditions.
+// v2 also frames every audio chunk with a length header, which
+// PipeReader consumes; v1 streams are scanned for the magic.
+// ================================================================
+void StreamPipeline::run() {
+    if (!m_reader) return;
+
+    while (m_running) {
+        // ============================================================
+        // Phase 1: Read format header (blocking)
+        // ============================================================
+        SqFormatHeader hdr;
+        bool gotHeader = m_readAhead ? m_readAhead->readHeader(hdr) : m_reader->readHeader(hdr);
+        if (!gotHeader) {
+            if (m_running) {
+                LOG_INFO("Squeezelite pipe closed");
+                endSource();
+            }
+            break;
+        }
+
+        if (m_shmRing && m_shmRing->fellBack() && !m_shmFallbackLogged) {
+            LOG_WARN("Squeezelite has no shared-memory support, reading stdout instead");
+            m_shmFallbackLogged = true;
+        }
+
+        // Validate magic
+        if (memcmp(hdr.magic, SQFH_MAGIC, 4) != 0) {
+            LOG_ERROR("Expected SQFH header, got: "
+                      << std::hex << (int)hdr.magic[0] << " " << (int)hdr.magic[1]
+                      << " " << (int)hdr.magic[2] << " " << (int)hdr.magic[3]
+                      << std::dec);
+            LOG_ERROR("Stream desynchronized. Is squeezelite patched for v2.0?");
+            m_running = false;
+            break;
+        }
+
+        if (m_sourceLostAt != std::chrono::steady_clock::time_point()) {
+            LOG_INFO("[Restart] Stream resumed "
+                     << std::chrono::duration_cast<std::chrono::milliseconds>(
+                            std::chrono::steady_clock::now() - m_sourceLostAt).count()
+                     << " ms after it was lost");
+            m_sourceLostAt = std::chrono::steady_clock::time_point();
+        }
+
+        // ============================================================
+        // Phase 2: Reopen if the format changed
+        // ============================================================
+        if (!beginTrack(hdr, true)) break;
+
+        // ============================================================
+        // Phase 3: Stream audio until next header or EOF
+        // ============================================================
+        streamAudio(hdr);
+        if (m_sourceEnded) break;
+    }
+}
+
+// Start a track: reopen DirettaSync if the format changed (after playing
+// out the previous one), otherwise continue gapless.
+// Returns false (and clears m_running) if DirettaSync could not be opened.
+bool StreamPipeline::beginTrack(const SqFormatHeader& hdr, bool burstFill) {
+    LOG_DEBUG("\n[Header] v" << (int)hdr.version
+              << " ch=" << (int)hdr.channels
+              << " depth=" << (int)hdr.bit_depth
+              << " dsd=" << (int)hdr.dsd_format
+              << " rate=" << hdr.sample_rate << "Hz");
+
+    bool flush = sqfhIsFlush(hdr);
+    if (flush) {
+        // Skip/seek: the buffered tail of the old position is not played
+        m_flushMarkers++;
+        m_flushes++;
+        if (m_direttaOpen) m_flushRingBytes += m_sync.flushBuffered();
+        for (FanTarget& t : m_fanOut) {
+            if (t.open) t.sync->flushBuffered();
+        }
+        LOG_INFO("[Flush] Dropped " << m_flushRingBytes / 1024 << " KB buffered"
+                  << (m_flushPipeBytes > 0 ? ", " + std::to_string(m_flushPipeBytes / 1024) + " KB unread" : ""));
+        m_flushRingBytes = 0;
+        m_flushPipeBytes = 0;
+    }
+
+    bool format_changed = (hdr.sample_rate != m_currentRate ||
+                            hdr.dsd_format != static_cast<uint8_t>(m_currentDsdType) ||
+                            hdr.bit_depth != m_currentDepth);
+
+    if (!format_changed && m_idle) {
+        // Target released: stays so until audio comes back
+        return true;
+    }
+    if (!format_changed) {
+        // Same format — gapless transition, no reopen needed
+        LOG_DEBUG("[Gapless] Same format, continuing stream");
+        return true;
+    }
+
+    // Play out the previous track while the switch is planned
+    if (m_direttaOpen && !flush) {
+        AudioFormat next = formatFor(hdr);
+        m_sync.drainForTransition(next);
+        for (FanTarget& t : m_fanOut) {
+            if (t.open) t.sync->drainForTransition(next);
+        }
+    }
+    HistogramTimer switchTimer(m_formatSwitchNs);
+    if (!handleFormat(hdr, burstFill)) {
+        m_running = false;
+        return false;
+    }
+    return true;
+}
+
+// ================================================================
+// Push model: in-process decoder callbacks
+// ================================================================
+// The decoder's output thread hands over each block as it is decoded,
+// so there is no pipe to read ahead of, nothing to scan for headers and
+// no burst fill: the ring fills from the first onAudio() calls, which
+// only start blocking on the high watermark once prefill is complete.
+// Blocks are cut to PIPE_BUF_SIZE so each push fits in the headroom
+// above the high watermark, as a pipe read would.
+bool StreamPipeline::onFormat(const SqFormatHeader& hdr) {
+    m_pushCarry = 0;  // A partial frame of the previous format is dropped
+    return beginTrack(hdr, false);
+}
+
+size_t StreamPipeline::onAudio(const uint8_t* data, size_t bytes) {
+    if (!m_direttaOpen || bytes == 0) return 0;
+    m_readBytes.record(bytes);
+
+    size_t bytes_per_frame = m_currentBytesPerFrame;
+    size_t granule = (m_currentDsdType == DSDFormatType::DOP) ? 2 * bytes_per_frame : bytes_per_frame;
+    size_t taken = 0;
+
+    // Complete the granule left over from the previous call
+    if (m_pushCarry > 0) {
+        size_t n = std::min(granule - m_pushCarry, bytes);
+        memcpy(m_audioBuf.data() + m_pushCarry, data, n);
+        m_pushCarry += n;
+        taken += n;
+        if (m_pushCarry < granule) return taken;
+        waitForSpace();
+        if (!m_running) return taken;
+        pushBlock(m_audioBuf.data(), granule, bytes_per_frame);
+        countAudio(granule, bytes_per_frame);
+        m_pushCarry = 0;
+    }
+
+    while (taken < bytes && m_running) {
+        size_t n = std::min(bytes - taken, PIPE_BUF_SIZE);
+        n -= n % granule;
+        if (n == 0) {
+            m_pushCarry = bytes - taken;
+            memcpy(m_audioBuf.data(), data + taken, m_pushCarry);
+            return bytes;
+        }
+        waitForSpace();
+        if (!m_running) break;
+        pushBlock(data + taken, n, bytes_per_frame);
+        countAudio(n, bytes_per_frame);
+        taken += n;
+    }
+    return taken;
+}
+
+// DirettaSync format for a header: DSD bit rate from the frame rate
+AudioFormat StreamPipeline::formatFor(const SqFormatHeader& hdr) const {
+    DSDFormatType dsd_type = static_cast<DSDFormatType>(hdr.dsd_format);
+    bool is_dsd = (dsd_type != DSDFormatType::NONE);
+
+    // Calculate actual DSD bit rate and Diretta format
+    unsigned int actual_rate = hdr.sample_rate;
+    // PCM: the width squeezelite actually sends (-a), as the header says
+    unsigned int bit_depth = (hdr.bit_depth == 16 || hdr.bit_depth == 24 || hdr.bit_depth == 32)
+        ? hdr.bit_depth : static_cast<unsigned int>(m_outputBitDepth);
+
+    if (is_dsd) {
+        if (dsd_type == DSDFormatType::U32_BE || dsd_type == DSDFormatType::U32_LE) {
+            // Native DSD: frame rate × 32 = DSD bit rate
+            actual_rate = hdr.sample_rate * 32;
+            bit_depth = 1;
+        } else if (dsd_type == DSDFormatType::DOP) {
+            // DoP: carrier rate × 16 = DSD bit rate
+            actual_rate = hdr.sample_rate * 16;
+            bit_depth = 1;
+        }
+    }
+
+    AudioFormat format;
+    format.sampleRate = actual_rate;
+    format.bitDepth = bit_depth;
+    format.channels = hdr.channels;
+    format.isDSD = is_dsd;
+    format.isCompressed = false;
+    if (is_dsd) {
+        format.dsdFormat = AudioFormat::DSDFormat::DFF;  // MSB (byte-swap in ring conversion)
+    }
+    return format;
+}
+
+// Open DirettaSync for a new format and (pipe) burst-fill the ring.
+// Returns false if DirettaSync could not be opened.
+bool StreamPipeline::handleFormat(const SqFormatHeader& hdr, bool burstFill) {
+    DSDFormatType dsd_type = static_cast<DSDFormatType>(hdr.dsd_format);
+    bool is_dsd = (dsd_type != DSDFormatType::NONE);
+    AudioFormat format = formatFor(hdr);
+    unsigned int actual_rate = format.sampleRate;
+
+    if (dsd_type == DSDFormatType::DOP) {
+        LOG_INFO("\n[Format Change] DoP->DSD at " << actual_rate << "Hz"
+                  << " (DoP rate: " << hdr.sample_rate << "Hz)");
+    } else if (is_dsd) {
+        LOG_INFO("\n[Format Change] DSD at " << actual_rate << "Hz"
+                  << " (frame rate: " << hdr.sample_rate << "Hz)");
+    } else {
+        LOG_INFO("\n[Format Change] PCM at " << actual_rate << "Hz / "
+                  << (int)hdr.bit_depth << "-bit");
+    }
+
+    // Don't call close() before open() — let open() handle the transition
+    // internally. close() sets m_open=false which prevents open() from
+    // detecting the format change and doing the critical SDK close/reopen
+    // needed for sample rate changes (e.g., 48kHz → 44.1kHz).
+
+    if (is_dsd) {
+        LOG_DEBUG("[DSD Format] "
+                  << (dsd_type == DSDFormatType::DOP ? "DoP->DSD" : "Native DSD")
+                  << " as DFF (MSB)");
+    }
+
+    // Open Diretta with new format
+    if (!m_sync.open(format)) {
+        LOG_ERROR("Failed to open Diretta with new format");
+        return false;
+    }
+
+    // Squeezelite's S32_LE is MSB-aligned (only used when packing 32 -> 24)
+    if (!is_dsd) {
+        m_sync.setS24PackModeHint(DirettaRingBuffer::S24PackMode::MsbAligned);
+    }
+    openFanOut(format, is_dsd);
+
+    m_direttaOpen = true;
+    m_idle = false;
+    m_silentSeconds = 0.0;
+    m_currentFormat = format;
+    m_currentRate = hdr.sample_rate;
+    m_currentDsdType = dsd_type;
+    m_currentDepth = hdr.bit_depth;
+    m_currentBytesPerFrame = sqfhBytesPerSample(hdr) * hdr.channels;
+
+    // ========================================================
+    // Burst-fill: fill ring buffer before rate-limited playback
+    // ========================================================
+    if (!burstFill) {
+        logReady(dsd_type, is_dsd, actual_rate);
+        return true;
+    }
+    LOG_DEBUG("[Burst Fill] Starting prefill...");
+
+    size_t bytes_per_frame = sqfhBytesPerSample(hdr) * hdr.channels;
+    auto burst_start = std::chrono::steady_clock::now();
+    const auto burst_timeout = std::chrono::seconds(5);
+    size_t burst_bytes = 0;
+
+    while (!prefillComplete() && m_running) {
+        auto elapsed = std::chrono::steady_clock::now() - burst_start;
+        if (elapsed > burst_timeout) {
+            LOG_WARN("[Burst Fill] Timeout after 5s");
+            break;
+        }
+        size_t n = 0;
+        PipeReader::ReadResult r = ingestChunk(dsd_type, bytes_per_frame, n);
+        if (r == PipeReader::ReadResult::Header) {
+            LOG_DEBUG("[Burst Fill] Next track header during burst");
+            break;
+        }
+        if (r != PipeReader::ReadResult::Audio) break;
+        burst_bytes += n;
+        m_streamedSeconds += static_cast<double>(n / bytes_per_frame) / hdr.sample_rate;
+    }
+
+    if (g_logLevel >= LogLevel::DEBUG) {
+        auto burst_elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - burst_start);
+        LOG_DEBUG("[Burst Fill] Complete: " << burst_bytes << " bytes in "
+                  << burst_elapsed.count() << "ms");
+    }
+
+    logReady(dsd_type, is_dsd, actual_rate);
+    return true;
+}
+
+void StreamPipeline::logReady(DSDFormatType dsdType, bool isDsd, unsigned int rate) {
+    if (dsdType == DSDFormatType::DOP) LOG_INFO("[Ready] DoP->DSD at " << rate << "Hz");
+    else if (isDsd) LOG_INFO("[Ready] DSD at " << rate << "Hz");
+    else LOG_INFO("[Ready] PCM at " << rate << "Hz");
+}
+
+void StreamPipeline::streamAudio(const SqFormatHeader& hdr) {
+    size_t bytes_per_frame = sqfhBytesPerSample(hdr) * hdr.channels;
+
+    while (m_running) {
+        size_t bytes_read = 0;
+        PipeReader::ReadResult r;
+
+        if (m_idle) {
+            r = idleChunk(hdr, bytes_read);
+        } else {
+            waitForSpace();
+
+            // Read and send; stops at the next track header. After an
+            // out-of-band flush, read up to the marker without sending
+            r = flushSignalled()
+                ? discardUntilHeader()
+                : ingestChunk(m_currentDsdType, bytes_per_frame, bytes_read);
+        }
+
+        if (r == PipeReader::ReadResult::Header) {
+            break;  // Next track — back to outer loop for header parsing
+        }
+        if (r != PipeReader::ReadResult::Audio) {
+            if (r == PipeReader::ReadResult::Eof) {
+                LOG_INFO("Squeezelite pipe closed");
+            } else if (errno != EINTR) {
+                LOG_ERROR("Error reading from pipe: " << strerror(errno));
+            }
+            if (m_running) {
+                endSource();
+            }
+            break;
+        }
+
+        countAudio(bytes_read, bytes_per_frame);
+        if (m_idleTimeoutS > 0.0 && !m_idle && m_silentSeconds >= m_idleTimeoutS) {
+            enterIdle();
+        }
+    }
+}
+
+// ================================================================
+// Idle: target released during long silence
+// ================================================================
+// Squeezelite writes silence while paused or stopped, as fast as the
+// pipe drains. Once the stream has been nothing else for the idle
+// timeout, the target is released (the SDK worker parks on its
+// futex) and the stream is read at its own rate, one chunk per wakeup,
+// so neither side spins. The first chunk that isn't silence reopens
+// the target with the current format (sink and discovery caches make
+// that a short connect) and is pushed as the start of the prefill.
+void StreamPipeline::trackSilence(const uint8_t* data, size_t bytes, size_t bytesPerFrame) {
+    if (m_idleTimeoutS <= 0.0) return;
+    if (isSilence(data, bytes, m_currentDsdType)) {
+        m_silentSeconds += static_cast<double>(bytes / bytesPerFrame) / m_currentRate;
+    } else {
+        m_silentSeconds = 0.0;
+    }
+}
+
+void StreamPipeline::enterIdle() {
+    LOG_INFO("[Idle] " << std::fixed << std::setprecision(1) << m_silentSeconds
+             << " s of silence, releasing the target");
+    if (m_direttaOpen) {
+        m_sync.release();
+        m_direttaOpen = false;
+    }
+    for (FanTarget& t : m_fanOut) {
+        if (t.open) t.sync->release();
+        t.open = false;
+    }
+    m_idle = true;
+    m_idlePeriods++;
+    m_idleNext = std::chrono::steady_clock::now();
+}
+
+PipeReader::ReadResult StreamPipeline::idleChunk(const SqFormatHeader& hdr, size_t& bytesIn) {
+    bytesIn = 0;
+    size_t bytes_per_frame = sqfhBytesPerSample(hdr) * hdr.channels;
+    size_t granule = (m_currentDsdType == DSDFormatType::DOP) ? 2 * bytes_per_frame : bytes_per_frame;
+
+    std::this_thread::sleep_until(m_idleNext);
+
+    const uint8_t* data = m_audioBuf.data();
+    size_t len = 0;
+    PipeReader::ReadResult result = m_readAhead
+        ? m_readAhead->next(data, len)
+        : timedRead(m_audioBuf.data(), m_audioBuf.size(), granule, len);
+    if (result != PipeReader::ReadResult::Audio) return result;
+
+    // Next read when this chunk would have played out
+    m_idleNext += std::chrono::nanoseconds(
+        static_cast<int64_t>(1e9 * static_cast<double>(len / bytes_per_frame) / m_currentRate));
+
+    if (!isSilence(data, len, m_currentDsdType)) {
+        LOG_INFO("[Idle] Audio resumed, reopening the target");
+        if (!handleFormat(hdr, false)) {
+            m_running = false;
+        } else {
+            pushAudio(m_currentDsdType, data, len, bytes_per_frame);
+            bytesIn = len;
+        }
+    }
+    if (m_readAhead) m_readAhead->release();
+    return result;
+}
+
+// Consumer-driven flow control: wait for space BEFORE pushing.
+// push() is non-blocking and truncates if full — must wait first
+// to avoid silently dropping audio data. Above the high mark we
+// sleep until the consumer wakes us at the low mark.
+// A flush signalled during the wait ends it.
+void StreamPipeline::waitForSpace() {
+    if (m_sync.isPrefillComplete() && m_sync.isAboveHighWater()) {
+        while (m_running && !flushSignalled() &&
+               !m_sync.waitForLowWater(std::chrono::milliseconds(100))) {}
+    }
+    // Fan-out: the stream goes at the pace of the fullest ring
+    for (FanTarget& t : m_fanOut) {
+        if (!t.open || !t.sync->isPrefillComplete() || !t.sync->isAboveHighWater()) continue;
+        while (m_running && !flushSignalled() &&
+               !t.sync->waitForLowWater(std::chrono::milliseconds(100))) {}
+    }
+}
+
+// Squeezelite counts flushes in the shared ring before writing each
+// marker, and the read-ahead thread counts the markers it has queued.
+// One not handled yet means the data ahead of it is stale.
+bool StreamPipeline::flushSignalled() const {
+    if (m_shmRing && static_cast<int32_t>(m_shmRing->flushSeq() - m_flushMarkers) > 0) return true;
+    return m_readAhead && static_cast<int32_t>(m_readAhead->flushSeq() - m_flushMarkers) > 0;
+}
+
+// Stop playing now, then drop the backlog up to the marker (or whatever
+// header comes first; flushSignalled() brings us back here after it)
+PipeReader::ReadResult StreamPipeline::discardUntilHeader() {
+    m_flushRingBytes += m_sync.flushBuffered();
+    for (FanTarget& t : m_fanOut) {
+        if (t.open) t.sync->flushBuffered();
+    }
+    PipeReader::ReadResult result = PipeReader::ReadResult::Audio;
+    while (m_running && result == PipeReader::ReadResult::Audio) {
+        size_t got = 0;
+        if (m_readAhead) {
+            const uint8_t* data = nullptr;
+            result = m_readAhead->next(data, got);
+            if (result == PipeReader::ReadResult::Audio) m_readAhead->release();
+        } else {
+            result = m_reader->readAudio(m_audioBuf.data(), m_audioBuf.size(), 1, got);
+        }
+        if (result == PipeReader::ReadResult::Audio) m_flushPipeBytes += got;
+    }
+    return result;
+}
+
+// m_currentRate is the squeezelite frame rate for PCM and DSD alike
+void StreamPipeline::countAudio(size_t bytes, size_t bytesPerFrame) {
+    if (bytes == 0) return;
+    size_t num_frames = bytes / bytesPerFrame;
+    m_totalBytes += static_cast<uint64_t>(bytes);
+    m_totalFrames += num_frames;
+    m_streamedSeconds += static_cast<double>(num_frames) / m_currentRate;
+
+    // Progress (debug level, every ~10 seconds)
+    if (g_logLevel >= LogLevel::DEBUG && m_totalFrames % (m_currentRate * 10) < (PIPE_BUF_SIZE / bytesPerFrame)) {
+        LOG_DEBUG("Streamed: " << std::fixed << std::setprecision(1)
+                  << m_streamedSeconds << "s (" << (m_totalBytes / 1024 / 1024) << " MB)");
+    }
+}
+
+// ================================================================
+// Audio ingest: pipe -> DirettaSync ring
+// ================================================================
+// PCM that needs no conversion is read from the pipe straight into
+// ring memory (single copy: kernel -> ring). Everything else is read
+// into m_audioBuf (bypassing PipeReader's buffer when it is empty) and
+// converted directly into the ring by DirettaSync.
+//
+// DSD (u32 or DoP) stays interleaved: the ring converts squeezelite's
+// layout to the sink's in one pass. Squeezelite packs DSD bytes
+// MSB-first into uint32_t (dsd.c) and outputs S32_LE, so the ring
+// byte-swaps each word back to temporal (DFF) order as needed.
+//
+// With read-ahead the reader thread has already copied the pipe into a
+// pool chunk, which is converted into the ring from where it lies.
+PipeReader::ReadResult StreamPipeline::timedRead(uint8_t* dst, size_t n, size_t granule, size_t& got) {
+    auto start = std::chrono::steady_clock::now();
+    PipeReader::ReadResult result = m_reader->readAudio(dst, n, granule, got);
+    m_readWaitNs.record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count()));
+    if (got > 0) m_readBytes.record(got);
+    return result;
+}
+
+PipeReader::ReadResult StreamPipeline::ingestChunk(DSDFormatType dsdType, size_t bytesPerFrame,
+                                                   size_t& bytesIn) {
+    if (m_readAhead) return ingestQueued(dsdType, bytesPerFrame, bytesIn);
+
+    bytesIn = 0;
+    PipeReader::ReadResult result = PipeReader::ReadResult::Audio;
+
+    if (dsdType == DSDFormatType::NONE && directIngest()) {
+        bool called = false;
+        auto fill = [&](uint8_t* dst, size_t cap) -> size_t {
+            called = true;
+            size_t got = 0;
+            result = timedRead(dst, cap, bytesPerFrame, got);
+            trackSilence(dst, got, bytesPerFrame);
+            return got;
+        };
+        bytesIn = m_sync.sendAudioDirect(m_audioBuf.size(), bytesPerFrame, fill);
+        if (bytesIn > 0) fanOut(dsdType, nullptr, bytesIn, bytesPerFrame);
+        if (called) return result;
+        // Conversion needed or ring wrap point — take the copy path
+    }
+
+    // DoP carries 16 DSD bits per sample: the ring works on frame pairs
+    size_t granule = (dsdType == DSDFormatType::DOP) ? 2 * bytesPerFrame : bytesPerFrame;
+
+    size_t got = 0;
+    result = timedRead(m_audioBuf.data(), m_audioBuf.size(), granule, got);
+    if (result != PipeReader::ReadResult::Audio) return result;
+    trackSilence(m_audioBuf.data(), got, bytesPerFrame);
+    bytesIn = got;
+    pushAudio(dsdType, m_audioBuf.data(), got, bytesPerFrame);
+    return result;
+}
+
+PipeReader::ReadResult StreamPipeline::ingestQueued(DSDFormatType dsdType, size_t bytesPerFrame,
+                                                    size_t& bytesIn) {
+    bytesIn = 0;
+    const uint8_t* data = nullptr;
+    size_t len = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    PipeReader::ReadResult result = m_readAhead->next(data, len);
+    m_readWaitNs.record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count()));
+    if (result != PipeReader::ReadResult::Audio) return result;
+
+    m_readBytes.record(len);
+    trackSilence(data, len, bytesPerFrame);
+    bytesIn = len;
+    pushAudio(dsdType, data, len, bytesPerFrame);
+    m_readAhead->release();
+    return result;
+}
+
+// Push model: PCM that needs no conversion is copied straight into ring
+// memory, like the pipe read in ingestChunk()
+void StreamPipeline::pushBlock(const uint8_t* data, size_t bytes, size_t bytesPerFrame) {
+    if (m_currentDsdType == DSDFormatType::NONE && directIngest()) {
+        bool called = false;
+        auto fill = [&](uint8_t* dst, size_t cap) -> size_t {
+            called = true;
+            size_t n = std::min(cap, bytes);
+            memcpy(dst, data, n);
+            return n;
+        };
+        size_t n = m_sync.sendAudioDirect(bytes, bytesPerFrame, fill);
+        if (n > 0) fanOut(m_currentDsdType, nullptr, n, bytesPerFrame);
+        if (called) {
+            if (n < bytes) pushAudio(m_currentDsdType, data + n, bytes - n, bytesPerFrame);
+            return;
+        }
+    }
+    pushAudio(m_currentDsdType, data, bytes, bytesPerFrame);
+}
+
+void StreamPipeline::pushAudio(DSDFormatType dsdType, const uint8_t* data, size_t bytes,
+                               size_t bytesPerFrame) {
+    pushTo(m_sync, dsdType, data, bytes, bytesPerFrame);
+    fanOut(dsdType, data, bytes, bytesPerFrame);
+}
+
+void StreamPipeline::pushTo(DirettaSync& sync, DSDFormatType dsdType, const uint8_t* data, size_t bytes,
+                            size_t bytesPerFrame) {
+    if (dsdType == DSDFormatType::DOP) {
+        sync.sendAudioDSD(data, bytes, DirettaRingBuffer::DSDSourceLayout::DoP);
+
+    } else if (dsdType != DSDFormatType::NONE) {
+        sync.sendAudioDSD(data, bytes, DirettaRingBuffer::DSDSourceLayout::InterleavedU32);
+
+    } else {
+        // PCM as squeezelite sent it — DirettaSync copies when the sink
+        // takes that width, else converts (32→24, 16→32/24, 24→32)
+        sync.sendAudio(data, bytes / bytesPerFrame);
+    }
+}
+
+// ================================================================
+// Fan-out: one stream, several targets
+// ================================================================
+// Each target has its own DirettaSync, ring and SDK worker. After every
+// open the targets are grouped by conversion: the first of a group
+// converts the source, the others copy its ring output
+// (DirettaSync::sendConvertedFrom()). When every target copies the
+// primary, pipe reads still go straight into the primary's ring;
+// otherwise they go through m_audioBuf, which the converters read.
+// The targets are not clock-locked to each other: flow control follows
+// the fullest ring, and a format change or flush realigns them.
+void StreamPipeline::openFanOut(const AudioFormat& format, bool isDsd) {
+    m_conversions = 1;
+    m_fanOutDirect = true;
+    std::vector<DirettaSync*> fed = { &m_sync };
+
+    for (size_t i = 0; i < m_fanOut.size(); i++) {
+        FanTarget& t = m_fanOut[i];
+        t.copyFrom = nullptr;
+        t.open = t.sync->open(format);
+        if (!t.open) {
+            LOG_WARN("[Fan-out] Target " << (i + 2) << " did not open this format, skipping it");
+            continue;
+        }
+        if (!isDsd) {
+            t.sync->setS24PackModeHint(DirettaRingBuffer::S24PackMode::MsbAligned);
+        }
+        for (DirettaSync* other : fed) {
+            if (t.sync->sameConversion(*other)) {
+                t.copyFrom = other;
+                break;
+            }
+        }
+        if (!t.copyFrom) m_conversions++;
+        if (t.copyFrom != &m_sync) m_fanOutDirect = false;
+        fed.push_back(t.sync);
+    }
+    if (!m_fanOut.empty()) {
+        LOG_INFO("[Fan-out] " << (fed.size()) << " of " << targetCount() << " targets, "
+                 << m_conversions << " conversion" << (m_conversions > 1 ? "s" : ""));
+    }
+}
+
+// data == nullptr: the primary read it straight into its ring, and every
+// target copies (m_fanOutDirect)
+void StreamPipeline::fanOut(DSDFormatType dsdType, const uint8_t* data, size_t bytes, size_t bytesPerFrame) {
+    for (FanTarget& t : m_fanOut) {
+        if (!t.open) continue;
+        if (t.copyFrom) {
+            t.sync->sendConvertedFrom(*t.copyFrom);
+        } else {
+            pushTo(*t.sync, dsdType, data, bytes, bytesPerFrame);
+        }
+    }
+}
+
+bool StreamPipeline::prefillComplete() const {
+    if (!m_sync.isPrefillComplete()) return false;
+    for (const FanTarget& t : m_fanOut) {
+        if (t.open && !t.sync->isPrefillComplete()) return false;
+    }
+    return true;
+}
@@ -0,0 +1,243 @@
+/**
+ * @file StreamPipeline.h
+ * @brief SQFH stream -> DirettaSync: format handling, burst fill, ingest
+ *
+ * The wrapper's main loop, shared with the offline replay tool: reads
+ * format headers from a PipeReader, (re)opens DirettaSync on format
+ * changes (after playing out the previous track), burst-fills the ring to
+ * the prefill target, then streams audio with watermark flow control until
+ * the next header.
+ *
+ * Optionally (enableReadAhead()) the pipe is read by a separate thread
+ * into a chunk pool, and run() only converts and pushes.
+ *
+ * A flush marker (SQFH_FLAG_FLUSH, squeezelite skipped or seeked) drops
+ * what DirettaSync has buffered instead of playing it out. With the
+ * shared-memory transport the flush is also signalled out of band, and
+ * the pipe backlog up to the marker is read and discarded unplayed; with
+ * read-ahead, so are the queued chunks ahead of a marker.
+ *
+ * With an idle timeout, a stream that has been silent that long (pause,
+ * stop, end of playlist: squeezelite keeps writing silence) releases the
+ * target and parks the SDK worker. The silence is then read at its
+ * real-time rate and dropped until audio or a new format comes back.
+ *
+ * A decoder running in the same process can skip the pipe: onFormat() and
+ * onAudio() take the same headers and audio as callbacks (push model).
+ *
+ * Fan-out (addTarget()) plays the stream on further targets, each with its
+ * own DirettaSync and ring. A target whose conversion matches one already
+ * fed copies that ring's output, so the stream is converted once per
+ * distinct sink format.
+ *
+ * Supervised (setSupervised()), the end of the stream is not the end of the
+ * pipeline: run() returns with running still set, the caller restarts
+ * squeezelite and attach()es its stream, and DirettaSync stays open,
+ * streaming silence, in the meantime.
+ */
+
+#ifndef SQUEEZE2DIRETTA_STREAM_PIPELINE_H
+#define SQUEEZE2DIRETTA_STREAM_PIPELINE_H
+
+#include "DirettaSync.h"
+#include "PipeReader.h"
+#include "ReadAhead.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <vector>
+
+class StreamPipeline {
+public:
+    /**
+     * @param running Cleared by the caller (signal) to stop, and by run()
+     *                on a fatal error or end of stream
+     * @param outputBitDepth PCM sample format requested from squeezelite (-a);
+     *                       used when a header carries no valid bit_depth
+     */
+    StreamPipeline(DirettaSync& sync, PipeReader& reader, std::atomic<bool>& running, int outputBitDepth);
+
+    // Push model only: onFormat() / onAudio(), no run() or read-ahead
+    StreamPipeline(DirettaSync& sync, std::atomic<bool>& running, int outputBitDepth);
+
+    StreamPipeline(const StreamPipeline&) = delete;
+    StreamPipeline& operator=(const StreamPipeline&) = delete;
+
+    /**
+     * Fan-out: also play the stream on this (enabled) target. Call before
+     * run(); it is opened, drained, flushed and released with the primary,
+     * and flow control waits for the fullest ring. A target that fails to
+     * open a format sits that format out.
+     */
+    void addTarget(DirettaSync& sync);
+    size_t targetCount() const { return 1 + m_fanOut.size(); }
+    // Distinct conversions for the current format (1 without fan-out)
+    size_t conversionCount() const { return m_conversions; }
+
+    // Warn once if the shared-memory transport fell back to stdout, and
+    // follow its out-of-band flush signal
+    void watchShmFallback(const ShmRing* ring) { m_shmRing = ring; }
+
+    /**
+     * Read the pipe on a separate thread into a pool of about `bytes`
+     * (see ReadAhead.h). Call before run() and before any thread reads
+     * the stats; the reader is joined when the pipeline is destroyed, so
+     * close the pipe first.
+     */
+    void enableReadAhead(size_t bytes, const ThreadTuning& tuning);
+    const ReadAhead* readAhead() const { return m_readAhead.get(); }
+
+    /**
+     * The caller restarts squeezelite when it exits: end of stream or a
+     * read error returns from run() with running still set and
+     * sourceEnded() true, instead of clearing running. The reader is no
+     * longer used from then on and may be destroyed.
+     */
+    void setSupervised(bool supervised) { m_supervised = supervised; }
+    bool sourceEnded() const { return m_sourceEnded; }
+
+    /**
+     * Continue on a restarted squeezelite after sourceEnded(), then run()
+     * again. Read-ahead (if enabled) restarts on the new reader. The
+     * format stays open, so a first header in the same format resumes
+     * without a reopen.
+     */
+    void attach(PipeReader& reader, const ShmRing* ring);
+    uint64_t sourceRestarts() const { return m_sourceRestarts; }
+
+    // Release the target after this much continuous silence (0 = never;
+    // run() only)
+    void setIdleTimeout(double seconds) { m_idleTimeoutS = seconds; }
+    bool isIdle() const { return m_idle; }
+    uint64_t idlePeriods() const { return m_idlePeriods; }
+
+    /**
+     * Process headers and audio until EOF, error, or running is cleared.
+     */
+    void run();
+
+    /**
+     * Push model, for an in-process decoder: call onFormat() whenever the
+     * decoder's output format is (re)set, then onAudio() from its output
+     * thread with squeezelite-layout audio (S32_LE PCM, u32 DSD or DoP).
+     * Same format switching and flow control as run(), without the burst
+     * fill: onAudio() blocks above the high watermark until the ring drains.
+     * Don't mix with run() on one pipeline.
+     *
+     * onFormat() returns false (and clears running) if DirettaSync could not
+     * be opened. onAudio() takes any byte count; partial frames are held
+     * until the next call. It returns the bytes taken, fewer only once
+     * running is cleared.
+     */
+    bool onFormat(const SqFormatHeader& hdr);
+    size_t onAudio(const uint8_t* data, size_t bytes);
+
+    bool isDirettaOpen() const { return m_direttaOpen; }
+    uint64_t totalBytes() const { return m_totalBytes; }
+    uint64_t totalFrames() const { return m_totalFrames; }
+
+    // Audio duration streamed so far, across format changes
+    double streamedSeconds() const { return m_streamedSeconds; }
+
+    // Format changes handled, and open + burst fill time for each
+    uint64_t formatChanges() const { return m_formatSwitchNs.count(); }
+    const Histogram& formatSwitchNs() const { return m_formatSwitchNs; }
+
+    // Flush markers (skip/seek) handled
+    uint64_t flushes() const { return m_flushes; }
+
+    // {"read_bytes":{...},"read_wait_ns":{...},"format_switch_ns":{...}}
+    // plus "read_ahead":{...} when enabled
+    void writeStatsJson(std::ostream& os) const;
+
+private:
+    AudioFormat formatFor(const SqFormatHeader& hdr) const;
+    bool beginTrack(const SqFormatHeader& hdr, bool burstFill);
+    bool handleFormat(const SqFormatHeader& hdr, bool burstFill);
+    static void logReady(DSDFormatType dsdType, bool isDsd, unsigned int rate);
+    void streamAudio(const SqFormatHeader& hdr);
+    void endSource();
+    void waitForSpace();
+    bool flushSignalled() const;
+    PipeReader::ReadResult discardUntilHeader();
+    void countAudio(size_t bytes, size_t bytesPerFrame);
+    void trackSilence(const uint8_t* data, size_t bytes, size_t bytesPerFrame);
+    void enterIdle();
+    PipeReader::ReadResult idleChunk(const SqFormatHeader& hdr, size_t& bytesIn);
+    void pushBlock(const uint8_t* data, size_t bytes, size_t bytesPerFrame);
+    PipeReader::ReadResult timedRead(uint8_t* dst, size_t n, size_t granule, size_t& got);
+    PipeReader::ReadResult ingestChunk(DSDFormatType dsdType, size_t bytesPerFrame, size_t& bytesIn);
+    PipeReader::ReadResult ingestQueued(DSDFormatType dsdType, size_t bytesPerFrame, size_t& bytesIn);
+    void pushAudio(DSDFormatType dsdType, const uint8_t* data, size_t bytes, size_t bytesPerFrame);
+    static void pushTo(DirettaSync& sync, DSDFormatType dsdType, const uint8_t* data, size_t bytes,
+                       size_t bytesPerFrame);
+    void openFanOut(const AudioFormat& format, bool isDsd);
+    void fanOut(DSDFormatType dsdType, const uint8_t* data, size_t bytes, size_t bytesPerFrame);
+    bool prefillComplete() const;
+    bool directIngest() const { return m_fanOutDirect; }
+
+    DirettaSync& m_sync;
+    PipeReader* m_reader;   // nullptr: push model
+
+    // Fan-out targets; copyFrom is an earlier target with the same
+    // conversion (nullptr: converts the source itself)
+    struct FanTarget {
+        DirettaSync* sync;
+        DirettaSync* copyFrom = nullptr;
+        bool open = false;
+    };
+    std::vector<FanTarget> m_fanOut;
+    size_t m_conversions = 1;
+    bool m_fanOutDirect = true;   // Every open target copies the primary: pipe reads may go straight into its ring
+
+    std::atomic<bool>& m_running;   // Shared with the signal handler and other zones
+    const int m_outputBitDepth;
+    const ShmRing* m_shmRing = nullptr;
+    bool m_shmFallbackLogged = false;
+    std::unique_ptr<ReadAhead> m_readAhead;  // Set once, before stats readers
+    ThreadTuning m_readAheadTuning;
+
+    // Supervised source: lost (pipe closed) and reattached
+    bool m_supervised = false;
+    bool m_sourceEnded = false;
+    uint64_t m_sourceRestarts = 0;
+    std::chrono::steady_clock::time_point m_sourceLostAt;   // Reset once the new source resumes
+
+    // Current format state
+    AudioFormat m_currentFormat;
+    DSDFormatType m_currentDsdType = DSDFormatType::NONE;
+    unsigned int m_currentRate = 0;
+    uint8_t m_currentDepth = 0;
+    size_t m_currentBytesPerFrame = 8;
+    bool m_direttaOpen = false;
+
+    // Flush state: markers seen (vs ShmRing::flushSeq()) and what was dropped
+    uint32_t m_flushMarkers = 0;
+    uint64_t m_flushes = 0;
+    uint64_t m_flushRingBytes = 0;
+    uint64_t m_flushPipeBytes = 0;
+
+    // Idle state: silence streamed so far, and the read clock while idle
+    double m_idleTimeoutS = 0.0;
+    double m_silentSeconds = 0.0;
+    bool m_idle = false;
+    uint64_t m_idlePeriods = 0;
+    std::chrono::steady_clock::time_point m_idleNext;
+
+    // Streaming state
+    uint64_t m_totalBytes = 0;
+    uint64_t m_totalFrames = 0;
+    double m_streamedSeconds = 0.0;
+    std::vector<uint8_t> m_audioBuf;    // Push model: holds a partial granule between onAudio() calls
+    size_t m_pushCarry = 0;
+
+    // Pipe-side histograms (run() thread writes, stats readers anywhere)
+    Histogram m_readBytes;       // Bytes per successful read (push model: per onAudio() call)
+    Histogram m_readWaitNs;      // Time blocked in PipeReader::readAudio() (or on the read-ahead pool)
+    Histogram m_formatSwitchNs;  // handleFormat(): DirettaSync::open() + burst fill (not the drain)
+};
+
+#endif // SQUEEZE2DIRETTA_STREAM_PIPELINE_H